@@ -0,0 +1,3397 @@
+/*
+ * This file was generated automatically by ExtUtils::ParseXS version 3.45 from the
+ * contents of XS.xs. Do not edit this file, edit XS.xs instead.
+ *
+ *    ANY CHANGES MADE HERE WILL BE LOST!
+ *
+ */
+
+#line 1 "XS.xs"
+
+#define PERL_NO_GET_CONTEXT 1 /* Define at top for more efficiency. */
+
+#include "EXTERN.h"
+#include "perl.h"
+#include "XSUB.h"
+#include "multicall.h"  /* only works in 5.6 and newer */
+
+#define NEED_newCONSTSUB
+#define NEED_newRV_noinc
+#define NEED_sv_2pv_flags
+#define NEED_HvNAME_get
+#include "ppport.h"
+
+#include "ptypes.h"
+#include "cache.h"
+#include "sieve.h"
+#define FUNC_gcd_ui 1
+#include "util.h"
+#include "primality.h"
+#include "factor.h"
+#include "lehmer.h"
+#include "lmo.h"
+#include "aks.h"
+#include "cert.h"
+#include "pseudoprimes.h"
+#include "constants.h"
+
+#if BITS_PER_WORD == 64
+  #if defined(_MSC_VER)
+    #include <stdlib.h>
+    #define strtoull _strtoui64
+    #define strtoll  _strtoi64
+  #endif
+  #define PSTRTOULL(str, end, base) strtoull (str, end, base)
+  #define PSTRTOLL(str, end, base)  strtoll (str, end, base)
+#else
+  #define PSTRTOULL(str, end, base) strtoul (str, end, base)
+  #define PSTRTOLL(str, end, base)  strtol (str, end, base)
+#endif
+#if defined(_MSC_VER) && !defined(strtold)
+  #define strtold strtod
+#endif
+
+#if PERL_REVISION <= 5 && PERL_VERSION <= 6 && BITS_PER_WORD == 64
+ /* Workaround perl 5.6 UVs and bigints */
+ #define my_svuv(sv)  PSTRTOULL(SvPV_nolen(sv), NULL, 10)
+ #define my_sviv(sv)  PSTRTOLL(SvPV_nolen(sv), NULL, 10)
+#elif PERL_REVISION <= 5 && PERL_VERSION < 14 && BITS_PER_WORD == 64
+ /* Workaround RT 49569 in Math::BigInt::FastCalc (pre 5.14.0) */
+ /* TODO: Math::BigInt::Pari has the same problem with negs pre-5.18.0 */
+ #define my_svuv(sv) ( (!SvROK(sv)) ? SvUV(sv) : PSTRTOULL(SvPV_nolen(sv),NULL,10) )
+ #define my_sviv(sv) ( (!SvROK(sv)) ? SvIV(sv) : PSTRTOLL(SvPV_nolen(sv),NULL,10) )
+#else
+ #define my_svuv(sv) SvUV(sv)
+ #define my_sviv(sv) SvIV(sv)
+#endif
+
+/* multicall compatibility stuff */
+#if (PERL_REVISION <= 5 && PERL_VERSION < 7) || !defined(dMULTICALL)
+# define USE_MULTICALL 0   /* Too much trouble to work around it */
+#else
+# define USE_MULTICALL 1
+#endif
+#if PERL_VERSION < 13 || (PERL_VERSION == 13 && PERL_SUBVERSION < 9)
+#  define FIX_MULTICALL_REFCOUNT \
+      if (CvDEPTH(multicall_cv) > 1) SvREFCNT_inc(multicall_cv);
+#else
+#  define FIX_MULTICALL_REFCOUNT
+#endif
+
+#ifndef CvISXSUB
+#  define CvISXSUB(cv) CvXSUB(cv)
+#endif
+
+/* Not right, but close */
+#if !defined cxinc && ( (PERL_VERSION == 8 && PERL_SUBVERSION >= 2) || (PERL_VERSION == 10 && PERL_SUBVERSION <= 1) )
+# define cxinc() Perl_cxinc(aTHX)
+#endif
+
+#if PERL_VERSION < 17 || (PERL_VERSION == 17 && PERL_SUBVERSION < 7)
+#  define SvREFCNT_dec_NN(sv)    SvREFCNT_dec(sv)
+#endif
+
+#if BITS_PER_WORD == 32
+  static const unsigned int uvmax_maxlen = 10;
+  static const unsigned int ivmax_maxlen = 10;
+  static const char uvmax_str[] = "4294967295";
+  static const char ivmax_str[] = "2147483648";
+#else
+  static const unsigned int uvmax_maxlen = 20;
+  static const unsigned int ivmax_maxlen = 19;
+  static const char uvmax_str[] = "18446744073709551615";
+  static const char ivmax_str[] =  "9223372036854775808";
+#endif
+
+#define MY_CXT_KEY "Math::Prime::Util::API_guts"
+typedef struct {
+  SV* const_int[4];   /* -1, 0, 1, 2 */
+  HV* MPUroot;
+  HV* MPUGMP;
+  HV* MPUPP;
+  UV  znlog_g;        /* Last znlog generator and modulus */
+  UV  znlog_p;
+  znlog_ctx_t* znlog_ctx;
+} my_cxt_t;
+
+START_MY_CXT
+
+/* Is this a pedantically valid integer?
+ * Croaks if undefined or invalid.
+ * Returns 0 if it is an object or a string too large for a UV.
+ * Returns 1 if it is good to process by XS.
+ */
+static int _validate_int(pTHX_ SV* n, int negok)
+{
+  const char* maxstr;
+  char* ptr;
+  STRLEN i, len, maxlen;
+  int ret, isbignum = 0, isneg = 0;
+
+  /* TODO: magic, grok_number, etc. */
+  if ((SvFLAGS(n) & (SVf_IOK |
+#if PERL_REVISION >=5 && PERL_VERSION >= 9 && PERL_SUBVERSION >= 4
+                     SVf_ROK |
+#else
+                     SVf_AMAGIC |
+#endif
+                     SVs_GMG )) == SVf_IOK) { /* If defined as number, use it */
+    if (SvIsUV(n) || SvIVX(n) >= 0)  return 1; /* The normal case */
+    if (negok)  return -1;
+    else croak("Parameter '%" SVf "' must be a positive integer", n);
+  }
+  if (sv_isobject(n)) {
+    const char *hvname = HvNAME_get(SvSTASH(SvRV(n)));
+    if (hvname == 0)
+      return 0;
+    if (strEQ(hvname, "Math::BigInt") || strEQ(hvname, "Math::BigFloat") ||
+        strEQ(hvname, "Math::GMPz")   || strEQ(hvname, "Math::GMP") ||
+        strEQ(hvname, "Math::Pari") )
+      isbignum = 1;
+    else
+      return 0;
+  }
+  /* Without being very careful, don't process magic variables here */
+  if (SvGAMAGIC(n) && !isbignum) return 0;
+  if (!SvOK(n))  croak("Parameter must be defined");
+  ptr = SvPV_nomg(n, len);             /* Includes stringifying bigints */
+  if (len == 0 || ptr == 0)  croak("Parameter must be a positive integer");
+  if (ptr[0] == '-' && negok) {
+    isneg = 1; ptr++; len--;           /* Read negative sign */
+  } else if (ptr[0] == '+') {
+    ptr++; len--;                      /* Allow a single plus sign */
+  }
+  if (len == 0 || !isDIGIT(ptr[0]))
+    croak("Parameter '%" SVf "' must be a positive integer", n);
+  while (len > 0 && *ptr == '0')       /* Strip all leading zeros */
+    { ptr++; len--; }
+  if (len > uvmax_maxlen)              /* Huge number, don't even look at it */
+    return 0;
+  for (i = 0; i < len; i++)            /* Ensure all characters are digits */
+    if (!isDIGIT(ptr[i]))
+      croak("Parameter '%" SVf "' must be a positive integer", n);
+  if (isneg == 1)                      /* Negative number (ignore overflow) */
+    return -1;
+  ret    = isneg ? -1           : 1;
+  maxlen = isneg ? ivmax_maxlen : uvmax_maxlen;
+  maxstr = isneg ? ivmax_str    : uvmax_str;
+  if (len < maxlen)                    /* Valid small integer */
+    return ret;
+  for (i = 0; i < maxlen; i++) {       /* Check if in range */
+    if (ptr[i] < maxstr[i]) return ret;
+    if (ptr[i] > maxstr[i]) return 0;
+  }
+  return ret;                          /* value = UV_MAX/UV_MIN.  That's ok */
+}
+
+#define VCALL_ROOT 0x0
+#define VCALL_PP 0x1
+#define VCALL_GMP 0x2
+/* Call a Perl sub to handle work for us. */
+static int _vcallsubn(pTHX_ I32 flags, I32 stashflags, const char* name, int nargs)
+{
+    GV* gv = NULL;
+    dMY_CXT;
+    Size_t namelen = strlen(name);
+    /* If given a GMP function, and GMP enabled, and function exists, use it. */
+    int use_gmp = stashflags & VCALL_GMP && _XS_get_callgmp();
+    assert(!(stashflags & ~(VCALL_PP|VCALL_GMP)));
+    if (use_gmp && hv_exists(MY_CXT.MPUGMP,name,namelen)) {
+      GV ** gvp = (GV**)hv_fetch(MY_CXT.MPUGMP,name,namelen,0);
+      if (gvp) gv = *gvp;
+    }
+    if (!gv && (stashflags & VCALL_PP))
+      perl_require_pv("Math/Prime/Util/PP.pm");
+    if (!gv) {
+      GV ** gvp = (GV**)hv_fetch(stashflags & VCALL_PP? MY_CXT.MPUPP : MY_CXT.MPUroot, name,namelen,0);
+      if (gvp) gv = *gvp;
+    }
+    /* use PL_stack_sp in PUSHMARK macro directly it will be read after
+      the possible mark stack extend */
+    PUSHMARK(PL_stack_sp-nargs);
+    /* no PUTBACK bc we didn't move global SP */
+    return call_sv((SV*)gv, flags);
+}
+#define _vcallsub(func) (void)_vcallsubn(aTHX_ G_SCALAR, VCALL_ROOT, func, items)
+#define _vcallsub_with_gmp(func) (void)_vcallsubn(aTHX_ G_SCALAR, VCALL_GMP|VCALL_PP, func, items)
+#define _vcallsub_with_pp(func) (void)_vcallsubn(aTHX_ G_SCALAR, VCALL_PP, func, items)
+
+/* In my testing, this constant return works fine with threads, but to be
+ * correct (see perlxs) one has to make a context, store separate copies in
+ * each one, then retrieve them from a struct using a hash index.  This
+ * defeats the purpose if only done once. */
+#define RETURN_NPARITY(ret) \
+  do { int r_ = ret; \
+       dMY_CXT; \
+       if (r_ >= -1 && r_ <= 2) { ST(0) = MY_CXT.const_int[r_+1]; XSRETURN(1); } \
+       else                     { XSRETURN_IV(r_);                      } \
+  } while (0)
+#define PUSH_NPARITY(ret) \
+  do { int r_ = ret; \
+       if (r_ >= -1 && r_ <= 2) { PUSHs( MY_CXT.const_int[r_+1] );       } \
+       else                     { PUSHs(sv_2mortal(newSViv(r_))); } \
+  } while (0)
+
+#define OBJECTIFY_RESULT(input, output) \
+  if (!sv_isobject(output)) { \
+    SV* resptr = output; \
+    const char *iname = sv_isobject(input) \
+                      ? HvNAME_get(SvSTASH(SvRV(input))) : 0; \
+    if (iname == 0 || strEQ(iname, "Math::BigInt")) { \
+      _vcallsub("_to_bigint"); /* Turn into bigint */ \
+    } else { /* Return it as: ref(input)->new(result) */ \
+      dSP;  ENTER;  PUSHMARK(SP); \
+      XPUSHs(sv_2mortal(newSVpv(iname, 0)));  XPUSHs(resptr); \
+      PUTBACK;  call_method("new", G_SCALAR);  LEAVE; \
+    } \
+  }
+
+#line 250 "XS.c"
+#ifndef PERL_UNUSED_VAR
+#  define PERL_UNUSED_VAR(var) if (0) var = var
+#endif
+
+#ifndef dVAR
+#  define dVAR		dNOOP
+#endif
+
+
+/* This stuff is not part of the API! You have been warned. */
+#ifndef PERL_VERSION_DECIMAL
+#  define PERL_VERSION_DECIMAL(r,v,s) (r*1000000 + v*1000 + s)
+#endif
+#ifndef PERL_DECIMAL_VERSION
+#  define PERL_DECIMAL_VERSION \
+	  PERL_VERSION_DECIMAL(PERL_REVISION,PERL_VERSION,PERL_SUBVERSION)
+#endif
+#ifndef PERL_VERSION_GE
+#  define PERL_VERSION_GE(r,v,s) \
+	  (PERL_DECIMAL_VERSION >= PERL_VERSION_DECIMAL(r,v,s))
+#endif
+#ifndef PERL_VERSION_LE
+#  define PERL_VERSION_LE(r,v,s) \
+	  (PERL_DECIMAL_VERSION <= PERL_VERSION_DECIMAL(r,v,s))
+#endif
+
+/* XS_INTERNAL is the explicit static-linkage variant of the default
+ * XS macro.
+ *
+ * XS_EXTERNAL is the same as XS_INTERNAL except it does not include
+ * "STATIC", ie. it exports XSUB symbols. You probably don't want that
+ * for anything but the BOOT XSUB.
+ *
+ * See XSUB.h in core!
+ */
+
+
+/* TODO: This might be compatible further back than 5.10.0. */
+#if PERL_VERSION_GE(5, 10, 0) && PERL_VERSION_LE(5, 15, 1)
+#  undef XS_EXTERNAL
+#  undef XS_INTERNAL
+#  if defined(__CYGWIN__) && defined(USE_DYNAMIC_LOADING)
+#    define XS_EXTERNAL(name) __declspec(dllexport) XSPROTO(name)
+#    define XS_INTERNAL(name) STATIC XSPROTO(name)
+#  endif
+#  if defined(__SYMBIAN32__)
+#    define XS_EXTERNAL(name) EXPORT_C XSPROTO(name)
+#    define XS_INTERNAL(name) EXPORT_C STATIC XSPROTO(name)
+#  endif
+#  ifndef XS_EXTERNAL
+#    if defined(HASATTRIBUTE_UNUSED) && !defined(__cplusplus)
+#      define XS_EXTERNAL(name) void name(pTHX_ CV* cv __attribute__unused__)
+#      define XS_INTERNAL(name) STATIC void name(pTHX_ CV* cv __attribute__unused__)
+#    else
+#      ifdef __cplusplus
+#        define XS_EXTERNAL(name) extern "C" XSPROTO(name)
+#        define XS_INTERNAL(name) static XSPROTO(name)
+#      else
+#        define XS_EXTERNAL(name) XSPROTO(name)
+#        define XS_INTERNAL(name) STATIC XSPROTO(name)
+#      endif
+#    endif
+#  endif
+#endif
+
+/* perl >= 5.10.0 && perl <= 5.15.1 */
+
+
+/* The XS_EXTERNAL macro is used for functions that must not be static
+ * like the boot XSUB of a module. If perl didn't have an XS_EXTERNAL
+ * macro defined, the best we can do is assume XS is the same.
+ * Dito for XS_INTERNAL.
+ */
+#ifndef XS_EXTERNAL
+#  define XS_EXTERNAL(name) XS(name)
+#endif
+#ifndef XS_INTERNAL
+#  define XS_INTERNAL(name) XS(name)
+#endif
+
+/* Now, finally, after all this mess, we want an ExtUtils::ParseXS
+ * internal macro that we're free to redefine for varying linkage due
+ * to the EXPORT_XSUB_SYMBOLS XS keyword. This is internal, use
+ * XS_EXTERNAL(name) or XS_INTERNAL(name) in your code if you need to!
+ */
+
+#undef XS_EUPXS
+#if defined(PERL_EUPXS_ALWAYS_EXPORT)
+#  define XS_EUPXS(name) XS_EXTERNAL(name)
+#else
+   /* default to internal */
+#  define XS_EUPXS(name) XS_INTERNAL(name)
+#endif
+
+#ifndef PERL_ARGS_ASSERT_CROAK_XS_USAGE
+#define PERL_ARGS_ASSERT_CROAK_XS_USAGE assert(cv); assert(params)
+
+/* prototype to pass -Wmissing-prototypes */
+STATIC void
+S_croak_xs_usage(const CV *const cv, const char *const params);
+
+STATIC void
+S_croak_xs_usage(const CV *const cv, const char *const params)
+{
+    const GV *const gv = CvGV(cv);
+
+    PERL_ARGS_ASSERT_CROAK_XS_USAGE;
+
+    if (gv) {
+        const char *const gvname = GvNAME(gv);
+        const HV *const stash = GvSTASH(gv);
+        const char *const hvname = stash ? HvNAME(stash) : NULL;
+
+        if (hvname)
+	    Perl_croak_nocontext("Usage: %s::%s(%s)", hvname, gvname, params);
+        else
+	    Perl_croak_nocontext("Usage: %s(%s)", gvname, params);
+    } else {
+        /* Pants. I don't think that it should be possible to get here. */
+	Perl_croak_nocontext("Usage: CODE(0x%" UVxf ")(%s)", PTR2UV(cv), params);
+    }
+}
+#undef  PERL_ARGS_ASSERT_CROAK_XS_USAGE
+
+#define croak_xs_usage        S_croak_xs_usage
+
+#endif
+
+/* NOTE: the prototype of newXSproto() is different in versions of perls,
+ * so we define a portable version of newXSproto()
+ */
+#ifdef newXS_flags
+#define newXSproto_portable(name, c_impl, file, proto) newXS_flags(name, c_impl, file, proto, 0)
+#else
+#define newXSproto_portable(name, c_impl, file, proto) (PL_Sv=(SV*)newXS(name, c_impl, file), sv_setpv(PL_Sv, proto), (CV*)PL_Sv)
+#endif /* !defined(newXS_flags) */
+
+#if PERL_VERSION_LE(5, 21, 5)
+#  define newXS_deffile(a,b) Perl_newXS(aTHX_ a,b,file)
+#else
+#  define newXS_deffile(a,b) Perl_newXS_deffile(aTHX_ a,b)
+#endif
+
+#line 394 "XS.c"
+#if defined(USE_ITHREADS) && defined(MY_CXT_KEY)
+#define XSubPPtmpAAAA 1
+
+
+XS_EUPXS(XS_Math__Prime__Util_CLONE); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_CLONE)
+{
+    dVAR; dXSARGS;
+    PERL_UNUSED_VAR(cv); /* -W */
+    PERL_UNUSED_VAR(items); /* -W */
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 268 "XS.xs"
+  int i;
+#line 410 "XS.c"
+#line 270 "XS.xs"
+  {
+    MY_CXT_CLONE; /* possible declaration */
+    for (i = 0; i <= 3; i++) {
+      MY_CXT.const_int[i] = newSViv(i-1);
+      SvREADONLY_on(MY_CXT.const_int[i]);
+    }
+    MY_CXT.MPUroot = gv_stashpv("Math::Prime::Util", TRUE);
+    MY_CXT.MPUGMP = gv_stashpv("Math::Prime::Util::GMP", TRUE);
+    MY_CXT.MPUPP = gv_stashpv("Math::Prime::Util::PP", TRUE);
+    MY_CXT.znlog_g = MY_CXT.znlog_p = 0;
+    MY_CXT.znlog_ctx = 0;   /* The parent's table is not ours to share */
+  }
+  return; /* skip implicit PUTBACK, returning @_ to caller, more efficient*/
+#line 425 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+#endif
+
+XS_EUPXS(XS_Math__Prime__Util_END); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_END)
+{
+    dVAR; dXSARGS;
+    PERL_UNUSED_VAR(cv); /* -W */
+    PERL_UNUSED_VAR(items); /* -W */
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 289 "XS.xs"
+  dMY_CXT;
+  int i;
+#line 445 "XS.c"
+#line 292 "XS.xs"
+  for (i = 0; i <= 3; i++) {
+    SV * const sv = MY_CXT.const_int[i];
+    MY_CXT.const_int[i] = NULL;
+    SvREFCNT_dec_NN(sv);
+  } /* stashes are owned by stash tree, no refcount on them in MY_CXT */
+  MY_CXT.MPUroot = NULL;
+  MY_CXT.MPUGMP = NULL;
+  MY_CXT.MPUPP = NULL;
+  znlog_ctx_free(MY_CXT.znlog_ctx);
+  MY_CXT.znlog_ctx = 0;
+  _prime_memfreeall();
+  return; /* skip implicit PUTBACK, returning @_ to caller, more efficient*/
+#line 459 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_prime_memfree); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_prime_memfree)
+{
+    dVAR; dXSARGS;
+    dXSI32;
+    if (items != 0)
+       croak_xs_usage(cv,  "");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 312 "XS.xs"
+    UV ret;
+#line 478 "XS.c"
+#line 314 "XS.xs"
+    switch (ix) {
+      case 0:  { dMY_CXT;
+                 znlog_ctx_free(MY_CXT.znlog_ctx);
+                 MY_CXT.znlog_ctx = 0;
+                 MY_CXT.znlog_g = MY_CXT.znlog_p = 0;
+               }
+               prime_memfree(); goto return_nothing;
+      case 1:  ret = _XS_get_verbose(); break;
+      case 2:  ret = _XS_get_callgmp(); break;
+      case 3:
+      default: ret = get_prime_cache(0,0); break;
+    }
+    XSRETURN_UV(ret);
+    return_nothing:
+#line 494 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_prime_precalc); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_prime_precalc)
+{
+    dVAR; dXSARGS;
+    dXSI32;
+    if (items != 1)
+       croak_xs_usage(cv,  "n");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+	UV	n = (UV)SvUV(ST(0))
+;
+#line 335 "XS.xs"
+    PUTBACK; /* SP is never used again, the 3 next func calls are tailcall
+    friendly since this XSUB has nothing to do after the 3 calls return */
+    switch (ix) {
+      case 0:  prime_precalc(n);    break;
+      case 1:  _XS_set_verbose(n);  break;
+      default: _XS_set_callgmp(n);  break;
+    }
+    return; /* skip implicit PUTBACK */
+#line 522 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_prime_count); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_prime_count)
+{
+    dVAR; dXSARGS;
+    dXSI32;
+    if (items < 1)
+       croak_xs_usage(cv,  "svlo, ...");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 350 "XS.xs"
+    int lostatus, histatus;
+    UV lo, hi;
+#line 542 "XS.c"
+	SV*	svlo = ST(0)
+;
+#line 353 "XS.xs"
+    lostatus = _validate_int(aTHX_ svlo, 0);
+    histatus = (items == 1 || _validate_int(aTHX_ ST(1), 0));
+    if (lostatus == 1 && histatus == 1) {
+      UV count = 0;
+      if (items == 1) {
+        lo = 2;
+        hi = my_svuv(svlo);
+      } else {
+        lo = my_svuv(svlo);
+        hi = my_svuv(ST(1));
+      }
+      if (lo <= hi) {
+        if (ix == 2) {
+          count = twin_prime_count(lo, hi);
+        } else if (ix == 1 || (hi / (hi-lo+1)) > 100) {
+          count = _XS_prime_count(lo, hi);
+        } else {
+          count = _XS_LMO_pi(hi);
+          if (lo > 2)
+            count -= _XS_LMO_pi(lo-1);
+        }
+      }
+      XSRETURN_UV(count);
+    }
+    switch (ix) {
+      case 0:
+      case 1: _vcallsubn(aTHX_ GIMME_V, VCALL_ROOT, "_generic_prime_count", items); break;
+      case 2:
+      default:_vcallsub_with_pp("twin_prime_count");  break;
+    }
+    return; /* skip implicit PUTBACK */
+#line 577 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util__XS_LMO_pi); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util__XS_LMO_pi)
+{
+    dVAR; dXSARGS;
+    dXSI32;
+    if (items != 1)
+       croak_xs_usage(cv,  "n");
+    {
+#line 393 "XS.xs"
+    UV ret;
+#line 594 "XS.c"
+	UV	RETVAL;
+	dXSTARG;
+	UV	n = (UV)SvUV(ST(0))
+;
+#line 395 "XS.xs"
+    switch (ix) {
+      case 0: ret = _XS_LMO_pi(n); break;
+      case 1: ret = _XS_legendre_pi(n); break;
+      case 2: ret = _XS_meissel_pi(n); break;
+      case 3: ret = _XS_lehmer_pi(n); break;
+      default:ret = _XS_LMOS_pi(n); break;
+    }
+    RETVAL = ret;
+#line 608 "XS.c"
+	XSprePUSH;
+	PUSHu((UV)RETVAL);
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_sieve_primes); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_sieve_primes)
+{
+    dVAR; dXSARGS;
+    dXSI32;
+    if (items != 2)
+       croak_xs_usage(cv,  "low, high");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 414 "XS.xs"
+    AV* av;
+#line 628 "XS.c"
+	UV	low = (UV)SvUV(ST(0))
+;
+	UV	high = (UV)SvUV(ST(1))
+;
+#line 416 "XS.xs"
+    av = newAV();
+    {
+      SV * retsv = sv_2mortal(newRV_noinc( (SV*) av ));
+      PUSHs(retsv);
+      PUTBACK;
+      SP = NULL; /* never use SP again, poison */
+    }
+    if ((low <= 2) && (high >= 2) && ix != 4) { av_push(av, newSVuv( 2 )); }
+    if ((low <= 3) && (high >= 3)) { av_push(av, newSVuv( 3 )); }
+    if ((low <= 5) && (high >= 5)) { av_push(av, newSVuv( 5 )); }
+    if (low < 7)  low = 7;
+    if (low <= high) {
+      if (ix == 4) high += 2;
+      if (ix == 0) {                          /* Sieve with primary cache */
+        START_DO_FOR_EACH_PRIME(low, high) {
+          av_push(av,newSVuv(p));
+        } END_DO_FOR_EACH_PRIME
+      } else if (ix == 1) {                   /* Trial */
+        for (low = next_prime(low-1);
+             low <= high && low != 0;
+             low = next_prime(low) ) {
+          av_push(av,newSVuv(low));
+        }
+      } else if (ix == 2) {                   /* Erat with private memory */
+        unsigned char* sieve = sieve_erat30(high);
+        START_DO_FOR_EACH_SIEVE_PRIME( sieve, low, high ) {
+           av_push(av,newSVuv(p));
+        } END_DO_FOR_EACH_SIEVE_PRIME
+        Safefree(sieve);
+      } else if (ix == 3 || ix == 4) {        /* Segment */
+        unsigned char* segment;
+        UV seg_base, seg_low, seg_high, lastp = 0;
+        void* ctx = start_segment_primes(low, high, &segment);
+        while (next_segment_primes(ctx, &seg_base, &seg_low, &seg_high)) {
+          START_DO_FOR_EACH_SIEVE_PRIME( segment, seg_low - seg_base, seg_high - seg_base )
+            p += seg_base;
+            if (ix == 3)            av_push(av,newSVuv( p ));
+            else if (lastp+2 == p)  av_push(av,newSVuv( lastp ));
+            lastp = p;
+          END_DO_FOR_EACH_SIEVE_PRIME
+        }
+        end_segment_primes(ctx);
+      }
+    }
+    return; /* skip implicit PUTBACK */
+#line 679 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_trial_factor); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_trial_factor)
+{
+    dVAR; dXSARGS;
+    dXSI32;
+    if (items < 1)
+       croak_xs_usage(cv,  "n, ...");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 475 "XS.xs"
+    UV arg1, arg2;
+    static const UV default_arg1[] =
+       {0,     64000000, 8000000, 4000000, 4000000, 200, 4000000, 1000000, 0, 1};
+     /* Trial, Fermat,   Holf,    SQUFOF,  PRHO,    P+1, Brent,    P-1, ECM, Lehman */
+#line 701 "XS.c"
+	UV	n = (UV)SvUV(ST(0))
+;
+#line 480 "XS.xs"
+    if (n == 0)  XSRETURN_UV(0);
+    if (ix == 8) {  /* We don't have an ecm_factor, call PP. */
+      _vcallsubn(aTHX_ GIMME_V, VCALL_PP, "ecm_factor", 1);
+      return;
+    }
+    /* Must read arguments before pushing anything */
+    arg1 = (items >= 2) ? my_svuv(ST(1)) : default_arg1[ix];
+    arg2 = (items >= 3) ? my_svuv(ST(2)) : 0;
+    /* Small factors */
+    while ( (n% 2) == 0 ) {  n /=  2;  XPUSHs(sv_2mortal(newSVuv( 2 ))); }
+    while ( (n% 3) == 0 ) {  n /=  3;  XPUSHs(sv_2mortal(newSVuv( 3 ))); }
+    while ( (n% 5) == 0 ) {  n /=  5;  XPUSHs(sv_2mortal(newSVuv( 5 ))); }
+    if (n == 1) {  /* done */ }
+    else if (_XS_is_prime(n)) { XPUSHs(sv_2mortal(newSVuv( n ))); }
+    else {
+      UV factors[MPU_MAX_FACTORS+1];
+      int i, nfactors = 0;
+      switch (ix) {
+        case 0:  nfactors = trial_factor  (n, factors, arg1);  break;
+        case 1:  nfactors = fermat_factor (n, factors, arg1);  break;
+        case 2:  nfactors = holf_factor   (n, factors, arg1);  break;
+        case 3:  nfactors = squfof_factor (n, factors, arg1);  break;
+        case 4:  nfactors = prho_factor   (n, factors, arg1);  break;
+        case 5:  nfactors = pplus1_factor (n, factors, arg1);  break;
+        case 6:  if (items < 3) arg2 = 1;
+                 nfactors = pbrent_factor (n, factors, arg1, arg2);  break;
+        case 9:  nfactors = lehman_factor (n, factors, arg1);  break;
+        case 7:
+        default: if (items < 3) arg2 = 10*arg1;
+                 nfactors = pminus1_factor(n, factors, arg1, arg2);  break;
+      }
+      EXTEND(SP, nfactors);
+      for (i = 0; i < nfactors; i++)
+        PUSHs(sv_2mortal(newSVuv( factors[i] )));
+    }
+#line 740 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_is_strong_pseudoprime); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_is_strong_pseudoprime)
+{
+    dVAR; dXSARGS;
+    dXSI32;
+    if (items < 1)
+       croak_xs_usage(cv,  "svn, ...");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 521 "XS.xs"
+    int c, status = 1;
+#line 759 "XS.c"
+	SV*	svn = ST(0)
+;
+#line 523 "XS.xs"
+    if (items < 2)
+      croak("No bases given to is_strong_pseudoprime");
+    /* Check all arguments */
+    for (c = 0; c < items && status == 1; c++)
+      if (_validate_int(aTHX_ ST(c), 0) != 1)
+        status = 0;
+    if (status == 1) {
+      UV n = my_svuv(svn);
+      int b, ret = 1;
+      if        (n < 4) {                        /* 0,1 composite; 2,3 prime */
+        ret = (n >= 2);
+      } else if (ix == 1) {                      /* Fermat test */
+        for (c = 1; c < items && ret == 1; c++)
+          ret = _XS_is_pseudoprime(n, my_svuv(ST(c)));
+      } else if ((n % 2) == 0) {                 /* evens composite */
+         ret = 0;
+      } else {
+        UV bases[32];
+        for (c = 1; c < items && ret == 1; ) {
+          for (b = 0; b < 32 && c < items; c++)
+            bases[b++] = my_svuv(ST(c));
+          ret = _XS_miller_rabin(n, bases, b);
+        }
+      }
+      RETURN_NPARITY(ret);
+    }
+    switch (ix) {
+      case 0: _vcallsub_with_gmp("is_strong_pseudoprime"); break;
+      case 1:
+      default:_vcallsub_with_gmp("is_pseudoprime");  break;
+    }
+    return; /* skip implicit PUTBACK */
+#line 795 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_gcd); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_gcd)
+{
+    dVAR; dXSARGS;
+    dXSI32;
+    PERL_UNUSED_VAR(cv); /* -W */
+    PERL_UNUSED_VAR(items); /* -W */
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 566 "XS.xs"
+    int i, status = 1;
+    UV ret, nullv, n;
+#line 815 "XS.c"
+#line 569 "XS.xs"
+    if (ix == 2 || ix == 3) {
+      UV retindex = 0;
+      int sign, minmax = (ix == 2);
+      if (items == 0) XSRETURN_UNDEF;
+      if (items == 1) XSRETURN(1);
+      status = _validate_int(aTHX_ ST(0), 2);
+      if (status != 0 && items > 1) {
+        sign = status;
+        ret = my_svuv(ST(0));
+        for (i = 1; i < items; i++) {
+          status = _validate_int(aTHX_ ST(i), 2);
+          if (status == 0) break;
+          n = my_svuv(ST(i));
+          if (( (sign == -1 && status == 1) ||
+                (n >= ret && sign == status)
+              ) ? !minmax : minmax ) {
+            sign = status;
+            ret = n;
+            retindex = i;
+          }
+        }
+      }
+      if (status != 0) {
+        ST(0) = ST(retindex);
+        XSRETURN(1);
+      }
+    } else if (ix == 4) {
+      UV lo = 0;
+      IV hi = 0;
+      for (ret = i = 0; i < items; i++) {
+        status = _validate_int(aTHX_ ST(i), 2);
+        if (status == 0) break;
+        n = my_svuv(ST(i));
+        if (status == 1) {
+          hi += (n > (UV_MAX - lo));
+        } else {
+          if (UV_MAX-n == (UV)IV_MAX) { status = 0; break; }  /* IV Overflow */
+          hi -= ((UV_MAX-n) >= lo);
+        }
+        lo += n;
+      }
+      if (status != 0 && hi == -1 && lo > IV_MAX)  XSRETURN_IV((IV)lo);
+      /* If status != 0 then the 128-bit result is:
+       *   result = ( hi << 64) + lo     if hi > 0
+       *   result = (-hi << 64) - lo     if hi < 0
+       * We have to somehow return this as a bigint, which we can't do here.
+       * Sad, because this will now be wasted work and slow. */
+      if (hi != 0) status = 0;  /* Overflow */
+      ret = lo;
+    } else if (ix == 5) {
+      int sign = 1;
+      ret = 1;
+      for (i = 0; i < items; i++) {
+        status = _validate_int(aTHX_ ST(i), 2);
+        if (status == 0) break;
+        n = (status == 1) ? my_svuv(ST(i)) : (UV)-my_sviv(ST(i));
+        if (ret > 0 && n > UV_MAX/ret) { status = 0; break; }
+        sign *= status;
+        ret *= n;
+      }
+      if (sign == -1 && status != 0) {
+        if (ret <= (UV)IV_MAX)  XSRETURN_IV(-(IV)ret);
+        else                    status = 0;
+      }
+    } else {
+      /* For each arg, while valid input, validate+gcd/lcm.  Shortcut stop. */
+      if (ix == 0) { ret = 0; nullv = 1; }
+      else         { ret = (items == 0) ? 0 : 1; nullv = 0; }
+      for (i = 0; i < items && ret != nullv && status != 0; i++) {
+        status = _validate_int(aTHX_ ST(i), 2);
+        if (status == 0)
+          break;
+        n = status * my_svuv(ST(i));  /* n = abs(arg) */
+        if (i == 0) {
+          ret = n;
+        } else {
+          UV gcd = gcd_ui(ret, n);
+          if (ix == 0) {
+            ret = gcd;
+          } else {
+            n /= gcd;
+            if (n <= (UV_MAX / ret) )    ret *= n;
+            else                         status = 0;   /* Overflow */
+          }
+        }
+      }
+    }
+    if (status != 0)
+      XSRETURN_UV(ret);
+    /* For min/max, use string compare if not an object */
+    if ((ix == 2 || ix == 3) && !sv_isobject(ST(0))) {
+      int i, retindex = 0;
+      int minmax = (ix == 2);
+      STRLEN alen, blen;
+      char *aptr, *bptr;
+      aptr = SvPV_nomg(ST(0), alen);
+      (void) strnum_minmax(minmax, 0, 0, aptr, alen);
+      for (i = 1; i < items; i++) {
+        bptr = SvPV_nomg(ST(i), blen);
+        if (strnum_minmax(minmax, aptr, alen, bptr, blen)) {
+          aptr = bptr;
+          alen = blen;
+          retindex = i;
+        }
+      }
+      ST(0) = ST(retindex);
+      XSRETURN(1);
+    }
+    switch (ix) {
+      case 0: _vcallsub_with_gmp("gcd");   break;
+      case 1: _vcallsub_with_gmp("lcm");   break;
+      case 2: _vcallsub_with_gmp("vecmin"); break;
+      case 3: _vcallsub_with_gmp("vecmax"); break;
+      case 4: _vcallsub_with_pp("vecsum");  break;
+      case 5:
+      default:_vcallsub_with_pp("vecprod");  break;
+    }
+    return; /* skip implicit PUTBACK */
+#line 935 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_chinese); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_chinese)
+{
+    dVAR; dXSARGS;
+    PERL_UNUSED_VAR(cv); /* -W */
+    PERL_UNUSED_VAR(items); /* -W */
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 692 "XS.xs"
+    int i, status;
+    UV* an;
+    UV ret;
+#line 955 "XS.c"
+#line 696 "XS.xs"
+    status = 1;
+    New(0, an, 2*items, UV);
+    ret = 0;
+    for (i = 0; i < items; i++) {
+      AV* av;
+      SV** psva;
+      SV** psvn;
+      if (!SvROK(ST(i)) || SvTYPE(SvRV(ST(i))) != SVt_PVAV || av_len((AV*)SvRV(ST(i))) != 1)
+        croak("chinese arguments are two-element array references");
+      av = (AV*) SvRV(ST(i));
+      psva = av_fetch(av, 0, 0);
+      psvn = av_fetch(av, 1, 0);
+      if (psva == 0 || psvn == 0 || _validate_int(aTHX_ *psva, 1) != 1 || !_validate_int(aTHX_ *psvn, 0)) {
+        status = 0;
+        break;
+      }
+      an[i+0]     = my_svuv(*psva);
+      an[i+items] = my_svuv(*psvn);
+    }
+    if (status)
+      ret = chinese(an, an+items, items, &status);
+    Safefree(an);
+    if (status == -1) XSRETURN_UNDEF;
+    if (status)       XSRETURN_UV(ret);
+    _vcallsub_with_pp("chinese");
+    return; /* skip implicit PUTBACK */
+#line 983 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_lucas_sequence); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_lucas_sequence)
+{
+    dVAR; dXSARGS;
+    dXSI32;
+    PERL_UNUSED_VAR(cv); /* -W */
+    PERL_UNUSED_VAR(items); /* -W */
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 729 "XS.xs"
+    UV U, V, Qk;
+#line 1002 "XS.c"
+#line 731 "XS.xs"
+    if (ix == 1 || ix == 2) {
+      if (items != 3) croak("lucasu: P, Q, k");
+      if (_validate_int(aTHX_ ST(0), 1) && _validate_int(aTHX_ ST(1), 1) &&
+          _validate_int(aTHX_ ST(2), 0)) {
+        IV P = my_sviv(ST(0));
+        IV Q = my_sviv(ST(1));
+        UV k = my_svuv(ST(2));
+        IV ret;
+        int ok = (ix == 1) ? lucasu(&ret, P, Q, k) : lucasv(&ret, P, Q, k);
+        if (ok) XSRETURN_IV(ret);
+      }
+      _vcallsub_with_gmp( (ix==1) ? "lucasu" : "lucasv" );
+      return;
+    }
+    if (items != 4) croak("lucas_sequence: n, P, Q, k");
+    if (_validate_int(aTHX_ ST(0), 0) && _validate_int(aTHX_ ST(1), 1) &&
+        _validate_int(aTHX_ ST(2), 1) && _validate_int(aTHX_ ST(3), 0)) {
+      lucas_seq(&U, &V, &Qk,
+                my_svuv(ST(0)), my_sviv(ST(1)), my_sviv(ST(2)), my_svuv(ST(3)));
+      PUSHs(sv_2mortal(newSVuv( U )));  /* 4 args in, 3 out, no EXTEND needed */
+      PUSHs(sv_2mortal(newSVuv( V )));
+      PUSHs(sv_2mortal(newSVuv( Qk )));
+    } else {
+      _vcallsubn(aTHX_ GIMME_V, VCALL_PP, "lucas_sequence", items);
+      return;
+    }
+#line 1030 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_is_prime); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_is_prime)
+{
+    dVAR; dXSARGS;
+    dXSI32;
+    if (items < 1)
+       croak_xs_usage(cv,  "svn, ...");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 775 "XS.xs"
+    int status;
+#line 1049 "XS.c"
+	SV*	svn = ST(0)
+;
+#line 777 "XS.xs"
+    status = _validate_int(aTHX_ svn, 1);
+    if (status != 0) {
+      int ret = 0;
+      if (status == 1 && ix != 13) {
+        UV n = my_svuv(svn);
+        UV a = (items == 1) ? 0 : my_svuv(ST(1));
+        switch (ix) {
+          case 0:
+          case 1:
+          case 2:  ret = _XS_is_prime(n);  break;
+          case 3:  ret = _XS_BPSW(n);      break;
+          case 4:  ret = _XS_is_aks_prime(n); break;
+          case 5:  ret = _XS_is_lucas_pseudoprime(n, 0); break;
+          case 6:  ret = _XS_is_lucas_pseudoprime(n, 1); break;
+          case 7:  ret = _XS_is_lucas_pseudoprime(n, 2); break;
+          case 8:  {
+                     /* IV P = 1, Q = -1; */ /* Fibonacci polynomial */
+                     IV P = 0, Q = 0;        /* Q=2,P=least odd s.t. (D|n)=-1 */
+                     if (items == 3) { P = my_sviv(ST(1)); Q = my_sviv(ST(2)); }
+                     else if (items != 1) croak("is_frobenius_pseudoprime takes P,Q");
+                     ret = is_frobenius_pseudoprime(n, P, Q);
+                   } break;
+          case 9:  ret = _XS_is_frobenius_underwood_pseudoprime(n); break;
+          case 10: ret = is_perrin_pseudoprime(n); break;
+          case 11: ret = _XS_is_almost_extra_strong_lucas_pseudoprime
+                         (n, (items == 1) ? 1 : a); break;
+          case 12:
+          default: ret = is_mersenne_prime(n);
+                   if (ret == -1) status = 0;
+                   break;
+        }
+      } else if (ix == 13) {
+        UV n = (status == 1) ? my_svuv(svn) : (UV) -my_sviv(svn);
+        UV a = (items == 1) ? 0 : my_svuv(ST(1));
+        if (status == -1 && n > (UV)IV_MAX) { status = 0; }
+        if (status == 1 || (status == -1 && (a == 0 || a & 1))) {
+          ret = is_power(n, a);
+          if (status == -1 && a == 0) {
+            ret >>= valuation(ret,2);
+            if (ret == 1) ret = 0;
+          }
+          if (ret && items == 3) {
+            UV root = rootof(n, a ? a : (UV)ret);
+            if (!SvROK(ST(2))) croak("is_power third argument not a scalar reference");
+            if (status == 1) sv_setuv(SvRV(ST(2)),  root);
+            else             sv_setiv(SvRV(ST(2)), -root);
+          }
+        }
+      }
+      if (status != 0) RETURN_NPARITY(ret);
+    }
+    switch (ix) {
+      case 0: _vcallsub_with_gmp("is_prime");       break;
+      case 1: _vcallsub_with_gmp("is_prob_prime");  break;
+      case 2: _vcallsub_with_gmp("is_provable_prime");  break;
+      case 3: _vcallsub_with_gmp("is_bpsw_prime");  break;
+      case 4: _vcallsub_with_gmp("is_aks_prime"); break;
+      case 5: _vcallsub_with_gmp("is_lucas_pseudoprime"); break;
+      case 6: _vcallsub_with_gmp("is_strong_lucas_pseudoprime"); break;
+      case 7: _vcallsub_with_gmp("is_extra_strong_lucas_pseudoprime"); break;
+      case 8: _vcallsub_with_gmp("is_frobenius_pseudoprime"); break;
+      case 9: _vcallsub_with_gmp("is_frobenius_underwood_pseudoprime"); break;
+      case 10:_vcallsub_with_gmp("is_perrin_pseudoprime"); break;
+      case 11:_vcallsub_with_gmp("is_almost_extra_strong_lucas_pseudoprime"); break;
+      case 12:_vcallsub_with_gmp("is_mersenne_prime"); break;
+      case 13:
+      default:if (items != 3 && status != -1) {
+                STRLEN len;
+                char* ptr = SvPV_nomg(svn, len);
+                if (len > 0 && ptr[0] != '-') {
+                  /* items != 3 and not negative */
+                  _vcallsub_with_gmp("is_power");
+                  return;
+                }
+              }
+              _vcallsub_with_pp("is_power");
+              break;
+    }
+    return; /* skip implicit PUTBACK */
+#line 1132 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_lucas_lehmer); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_lucas_lehmer)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "svp");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 860 "XS.xs"
+    int status;
+#line 1150 "XS.c"
+	SV*	svp = ST(0)
+;
+#line 862 "XS.xs"
+    status = _validate_int(aTHX_ svp, 0);
+    if (status == 1)
+      RETURN_NPARITY(lucas_lehmer(my_svuv(svp)));
+    _vcallsub_with_pp("lucas_lehmer");
+    return; /* skip implicit PUTBACK */
+#line 1159 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_is_prime_batch); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_is_prime_batch)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "svarr");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 871 "XS.xs"
+    AV* av;
+    UV* n;
+    unsigned char* res;
+    int i, len, status = 1;
+#line 1180 "XS.c"
+	SV*	svarr = ST(0)
+;
+#line 876 "XS.xs"
+    if (!SvROK(svarr) || SvTYPE(SvRV(svarr)) != SVt_PVAV)
+      croak("is_prime_batch argument must be an array reference");
+    av = (AV*) SvRV(svarr);
+    len = av_len(av) + 1;
+    New(0, n, len, UV);
+    for (i = 0; i < len; i++) {
+      SV** psv = av_fetch(av, i, 0);
+      status = (psv == 0) ? 0 : _validate_int(aTHX_ *psv, 1);
+      if (status == 0) break;
+      n[i] = (status == 1) ? my_svuv(*psv) : 0;
+    }
+    if (status != 0) {
+      dMY_CXT;
+      New(0, res, len, unsigned char);
+      is_prob_prime_batch(n, len, res);
+      EXTEND(SP, len);
+      for (i = 0; i < len; i++)
+        PUSH_NPARITY(res[i]);
+      Safefree(res);
+    }
+    Safefree(n);
+    if (status == 0) {
+      _vcallsubn(aTHX_ GIMME_V, VCALL_ROOT, "_generic_is_prime_batch", 1);
+      return; /* skip implicit PUTBACK */
+    }
+#line 1209 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_is_prime_range); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_is_prime_range)
+{
+    dVAR; dXSARGS;
+    if (items < 2 || items > 3)
+       croak_xs_usage(cv,  "svlo, svhi, svstep= 0");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 905 "XS.xs"
+    int lostatus, histatus, ststatus;
+#line 1227 "XS.c"
+	SV*	svlo = ST(0)
+;
+	SV*	svhi = ST(1)
+;
+	SV*	svstep;
+
+	if (items < 3)
+	    svstep = 0;
+	else {
+	    svstep = ST(2)
+;
+	}
+#line 907 "XS.xs"
+    lostatus = _validate_int(aTHX_ svlo, 0);
+    histatus = _validate_int(aTHX_ svhi, 0);
+    ststatus = (svstep == 0) ? 1 : _validate_int(aTHX_ svstep, 0);
+    if (lostatus == 1 && histatus == 1 && ststatus == 1) {
+      UV lo = my_svuv(svlo);
+      UV hi = my_svuv(svhi);
+      UV step = (svstep == 0) ? 1 : my_svuv(svstep);
+      UV count;
+      unsigned char* bits;
+      if (step == 0) croak("is_prime_range step must be positive");
+      count = (hi < lo) ? 0 : (hi-lo)/step + 1;
+      bits = prime_range_bitmap(lo, step, count);
+      XPUSHs(sv_2mortal(newSVpvn((char*)bits, (count+7)/8)));
+      Safefree(bits);
+    } else {
+      _vcallsubn(aTHX_ G_SCALAR, VCALL_ROOT, "_generic_is_prime_range", items);
+      return; /* skip implicit PUTBACK */
+    }
+#line 1259 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_spsp2_range); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_spsp2_range)
+{
+    dVAR; dXSARGS;
+    if (items < 1)
+       croak_xs_usage(cv,  "svlo, ...");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 929 "XS.xs"
+    AV* av;
+    int lostatus, histatus;
+#line 1278 "XS.c"
+	SV*	svlo = ST(0)
+;
+#line 932 "XS.xs"
+    lostatus = _validate_int(aTHX_ svlo, 0);
+    histatus = (items == 1 || _validate_int(aTHX_ ST(1), 0));
+    if (lostatus == 1 && histatus == 1) {
+      UV i, count, *list, lo = 0, hi = my_svuv(svlo);
+      if (items > 1) { lo = hi;  hi = my_svuv(ST(1)); }
+      list = spsp2_range(lo, hi, &count);
+      av = newAV();
+      if (count > 0) av_extend(av, count-1);
+      for (i = 0; i < count; i++)
+        av_push(av, newSVuv(list[i]));
+      Safefree(list);
+      XPUSHs(sv_2mortal(newRV_noinc( (SV*) av )));
+    } else {
+      _vcallsubn(aTHX_ G_SCALAR, VCALL_ROOT, "_generic_spsp2_range", items);
+      return; /* skip implicit PUTBACK */
+    }
+#line 1298 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_factor_range); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_factor_range)
+{
+    dVAR; dXSARGS;
+    if (items < 1)
+       croak_xs_usage(cv,  "svlo, ...");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 952 "XS.xs"
+    AV* av;
+    int lostatus, histatus;
+#line 1317 "XS.c"
+	SV*	svlo = ST(0)
+;
+#line 955 "XS.xs"
+    lostatus = _validate_int(aTHX_ svlo, 0);
+    histatus = (items == 1 || _validate_int(aTHX_ ST(1), 0));
+    if (lostatus == 1 && histatus == 1) {
+      UV n, lo = 1, hi = my_svuv(svlo), factors[MPU_MAX_FACTORS+1];
+      int i, nfactors;
+      void* ctx;
+      if (items > 1) { lo = hi;  hi = my_svuv(ST(1)); }
+      av = newAV();
+      ctx = start_factor_range(lo, hi);
+      while ( (nfactors = next_factor_range(ctx, &n, factors)) >= 0 ) {
+        AV* fav = newAV();
+        for (i = 0; i < nfactors; i++)
+          av_push(fav, newSVuv(factors[i]));
+        av_push(av, newRV_noinc( (SV*) fav ));
+      }
+      end_factor_range(ctx);
+      XPUSHs(sv_2mortal(newRV_noinc( (SV*) av )));
+    } else {
+      _vcallsubn(aTHX_ G_SCALAR, VCALL_ROOT, "_generic_factor_range", items);
+      return; /* skip implicit PUTBACK */
+    }
+#line 1342 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_carmichael_count); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_carmichael_count)
+{
+    dVAR; dXSARGS;
+    if (items < 1)
+       croak_xs_usage(cv,  "svlo, ...");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 980 "XS.xs"
+    int lostatus, histatus;
+#line 1360 "XS.c"
+	SV*	svlo = ST(0)
+;
+#line 982 "XS.xs"
+    lostatus = _validate_int(aTHX_ svlo, 0);
+    histatus = (items == 1 || _validate_int(aTHX_ ST(1), 0));
+    if (lostatus == 1 && histatus == 1) {
+      UV lo = 0, hi = my_svuv(svlo);
+      if (items > 1) { lo = hi;  hi = my_svuv(ST(1)); }
+      XSRETURN_UV( carmichael_count(lo, hi) );
+    }
+    _vcallsubn(aTHX_ G_SCALAR, VCALL_ROOT, "_generic_carmichael_count", items);
+    return; /* skip implicit PUTBACK */
+#line 1373 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util__bls75_certificate); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util__bls75_certificate)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "strn");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 995 "XS.xs"
+    char* cert;
+#line 1391 "XS.c"
+	char*	strn = (char *)SvPV_nolen(ST(0))
+;
+#line 997 "XS.xs"
+    cert = bls75_certificate(strn);
+    if (cert == 0) XSRETURN_UNDEF;
+    XPUSHs(sv_2mortal(newSVpv(cert, 0)));
+    Safefree(cert);
+#line 1399 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util__verify_cert); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util__verify_cert)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "cert");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 1005 "XS.xs"
+    int res;
+#line 1417 "XS.c"
+	char*	cert = (char *)SvPV_nolen(ST(0))
+;
+#line 1007 "XS.xs"
+    res = verify_cert_text(cert);
+    if (res < 0) XSRETURN_UNDEF;
+    XSRETURN_IV(res);
+#line 1424 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_next_prime); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_next_prime)
+{
+    dVAR; dXSARGS;
+    dXSI32;
+    if (items != 1)
+       croak_xs_usage(cv,  "svn");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+	SV*	svn = ST(0)
+;
+#line 1026 "XS.xs"
+    if (_validate_int(aTHX_ svn, 0)) {
+      UV n = my_svuv(svn);
+      if ( (n >= MPU_MAX_PRIME     && ix == 0) ||
+           (n >= MPU_MAX_PRIME_IDX && (ix==2 || ix==3 || ix==4 || ix==5)) ||
+           (n >= MPU_MAX_TWIN_PRIME_IDX && (ix==6 || ix==7)) ) {
+        /* Out of range.  Fall through to Perl. */
+      } else {
+        UV ret;
+        switch (ix) {
+          case 0: ret = next_prime(n);  break;
+          case 1: ret = (n < 3) ? 0 : prev_prime(n);  break;
+          case 2: ret = nth_prime(n); break;
+          case 3: ret = nth_prime_upper(n); break;
+          case 4: ret = nth_prime_lower(n); break;
+          case 5: ret = nth_prime_approx(n); break;
+          case 6: ret = nth_twin_prime(n); break;
+          case 7: ret = nth_twin_prime_approx(n); break;
+          case 8: ret = prime_count_upper(n); break;
+          case 9: ret = prime_count_lower(n); break;
+          case 10:ret = prime_count_approx(n); break;
+          case 11:
+          default:ret = twin_prime_count_approx(n); break;
+        }
+        XSRETURN_UV(ret);
+      }
+    }
+    if ((ix == 0 || ix == 1) && _XS_get_callgmp() && PERL_REVISION >= 5 && PERL_VERSION > 8) {
+      _vcallsub_with_gmp( ix ? "prev_prime" : "next_prime");
+      OBJECTIFY_RESULT(svn, ST(0));
+      return;
+    }
+    switch (ix) {
+      case 0:  _vcallsub_with_pp("next_prime");         break;
+      case 1:  _vcallsub_with_pp("prev_prime");         break;
+      case 2:  _vcallsub_with_pp("nth_prime");          break;
+      case 3:  _vcallsub_with_pp("nth_prime_upper");    break;
+      case 4:  _vcallsub_with_pp("nth_prime_lower");    break;
+      case 5:  _vcallsub_with_pp("nth_prime_approx");   break;
+      case 6:  _vcallsub_with_pp("nth_twin_prime");     break;
+      case 7:  _vcallsub_with_pp("nth_twin_prime_approx"); break;
+      case 8:  _vcallsub_with_pp("prime_count_upper");  break;
+      case 9:  _vcallsub_with_pp("prime_count_lower");  break;
+      case 10: _vcallsub_with_pp("prime_count_approx"); break;
+      case 11:
+      default: _vcallsub_with_pp("twin_prime_count_approx"); break;
+    }
+    return; /* skip implicit PUTBACK */
+#line 1491 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_Pi); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_Pi)
+{
+    dVAR; dXSARGS;
+    if (items < 0 || items > 1)
+       croak_xs_usage(cv,  "digits= 0");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 1076 "XS.xs"
+    NV pival = 3.141592653589793238462643383279502884197169L;
+    UV mantsize = DBL_MANT_DIG / 3.322;   /* Let long doubles go to BF */
+#line 1510 "XS.c"
+	UV	digits;
+
+	if (items < 1)
+	    digits = 0;
+	else {
+	    digits = (UV)SvUV(ST(0))
+;
+	}
+#line 1079 "XS.xs"
+    if (digits == 0) {
+      XSRETURN_NV( pival );
+    } else if (digits <= mantsize && digits <= 40) {
+      char t[40+2];
+      NV pi;
+      (void)sprintf(t, "%.*"NVff, (int)(digits-1), pival);
+#if defined(USE_LONG_DOUBLE) && defined(HAS_LONG_DOUBLE)
+      pi = strtold(t, NULL);
+#else
+      pi = strtod(t, NULL);
+#endif
+      XSRETURN_NV( pi );
+    } else {
+      _vcallsub_with_pp("Pi");
+      return;
+    }
+#line 1536 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util__pidigits); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util__pidigits)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "digits");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+	int	digits = (int)SvIV(ST(0))
+;
+#line 1099 "XS.xs"
+    if (digits == 1) {
+      XSRETURN_UV(3);
+    } else {
+      char *out;
+      IV  *a;
+      IV b, c, d, e, f, g, i,  d4, d3, d2, d1;
+
+      digits++;   /* For rounding */
+      b = d = e = g = i = 0;  f = 10000;
+      c = 14*(digits/4 + 2);
+      New(0, a, c, IV);
+      New(0, out, digits+5+1, char);
+      *out++ = '3';  /* We'll turn "31415..." into "3.1415..." */
+      for (b = 0; b < c; b++)  a[b] = 20000000;
+
+      while ((b = c -= 14) > 0 && i < digits) {
+        d = e = d % f;
+        while (--b > 0) {
+          d = d * b + a[b];
+          g = (b << 1) - 1;
+          a[b] = (d % g) * f;
+          d /= g;
+        }
+        /* sprintf(out+i, "%04d", e+d/f);   i += 4; */
+        d4 = e+d/f;
+        if (d4 > 9999) {
+          d4 -= 10000;
+          out[i-1]++;
+          for (b=i-1; out[b] == '0'+1; b--) { out[b]='0'; out[b-1]++; }
+        }
+        d3 = d4/10;  d2 = d3/10;  d1 = d2/10;
+        out[i++] = '0' + d1;
+        out[i++] = '0' + d2-d1*10;
+        out[i++] = '0' + d3-d2*10;
+        out[i++] = '0' + d4-d3*10;
+      }
+      Safefree(a);
+      if (out[digits-1] >= '5') out[digits-2]++;  /* Round */
+      for (i = digits-2; out[i] == '9'+1; i--)    /* Keep rounding */
+        { out[i] = '0';  out[i-1]++; }
+      digits--;  /* Undo the extra digit we used for rounding */
+      out[digits] = '\0';
+      *out-- = '.';
+      XPUSHs(sv_2mortal(newSVpvn(out, digits+1)));
+      Safefree(out);
+    }
+#line 1601 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_factor); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_factor)
+{
+    dVAR; dXSARGS;
+    dXSI32;
+    if (items != 1)
+       croak_xs_usage(cv,  "svn");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 1153 "XS.xs"
+    U32 gimme_v;
+    int status, i, nfactors;
+#line 1621 "XS.c"
+	SV*	svn = ST(0)
+;
+#line 1156 "XS.xs"
+    gimme_v = GIMME_V;
+    status = _validate_int(aTHX_ svn, 0);
+    if (status == 1) {
+      UV factors[MPU_MAX_FACTORS+1];
+      UV exponents[MPU_MAX_FACTORS+1];
+      UV n = my_svuv(svn);
+      if (gimme_v == G_SCALAR) {
+        switch (ix) {
+          case 0:  nfactors = factor(n, factors);        break;
+          case 1:  nfactors = factor_exp(n, factors, 0); break;
+          default: nfactors = divisor_sum(n, 0);         break;
+        }
+        PUSHs(sv_2mortal(newSVuv( nfactors )));
+      } else if (gimme_v == G_ARRAY) {
+        switch (ix) {
+          case 0:  nfactors = factor(n, factors);
+                   EXTEND(SP, nfactors);
+                   for (i = 0; i < nfactors; i++)
+                     PUSHs(sv_2mortal(newSVuv( factors[i] )));
+                   break;
+          case 1:  nfactors = factor_exp(n, factors, exponents);
+                   /* if (n == 1)  XSRETURN_EMPTY; */
+                   EXTEND(SP, nfactors);
+                   for (i = 0; i < nfactors; i++) {
+                     AV* av = newAV();
+                     av_push(av, newSVuv(factors[i]));
+                     av_push(av, newSVuv(exponents[i]));
+                     PUSHs( sv_2mortal(newRV_noinc( (SV*) av )) );
+                   }
+                   break;
+          default: {
+                     UV ndivisors;
+                     UV* divs = _divisor_list(n, &ndivisors);
+                     EXTEND(SP, ndivisors);
+                     for (i = 0; (UV)i < ndivisors; i++)
+                       PUSHs(sv_2mortal(newSVuv( divs[i] )));
+                     Safefree(divs);
+                   }
+                   break;
+        }
+      }
+    } else {
+      switch (ix) {
+        case 0:  _vcallsubn(aTHX_ gimme_v, VCALL_ROOT, "_generic_factor", 1);     break;
+        case 1:  _vcallsubn(aTHX_ gimme_v, VCALL_ROOT, "_generic_factor_exp", 1); break;
+        default: _vcallsubn(aTHX_ gimme_v, VCALL_GMP|VCALL_PP, "divisors", 1);   break;
+      }
+      return; /* skip implicit PUTBACK */
+    }
+#line 1674 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_divisor_sum); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_divisor_sum)
+{
+    dVAR; dXSARGS;
+    if (items < 1)
+       croak_xs_usage(cv,  "svn, ...");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 1209 "XS.xs"
+    SV* svk;
+    int nstatus, kstatus;
+#line 1693 "XS.c"
+	SV*	svn = ST(0)
+;
+#line 1212 "XS.xs"
+    svk = (items > 1) ? ST(1) : 0;
+    nstatus = _validate_int(aTHX_ svn, 0);
+    kstatus = (items == 1 || (SvIOK(svk) && SvIV(svk) >= 0))  ?  1  :  0;
+    /* The above doesn't understand small bigints */
+    if (nstatus == 1 && kstatus == 0 && SvROK(svk) && (sv_isa(svk, "Math::BigInt") || sv_isa(svk, "Math::GMP")))
+      kstatus = _validate_int(aTHX_ svk, 0);
+    if (nstatus == 1 && kstatus == 1) {
+      UV n = my_svuv(svn);
+      UV k = (items > 1) ? my_svuv(svk) : 1;
+      UV sigma = divisor_sum(n, k);
+      if (sigma != 0)  XSRETURN_UV(sigma);   /* sigma 0 means overflow */
+    }
+    _vcallsub_with_gmp("divisor_sum");
+    return; /* skip implicit PUTBACK */
+#line 1711 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_znorder); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_znorder)
+{
+    dVAR; dXSARGS;
+    dXSI32;
+    if (items != 2)
+       croak_xs_usage(cv,  "sva, svn");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 1234 "XS.xs"
+    int astatus, nstatus;
+#line 1730 "XS.c"
+	SV*	sva = ST(0)
+;
+	SV*	svn = ST(1)
+;
+#line 1236 "XS.xs"
+    astatus = _validate_int(aTHX_ sva, (ix==1) ? 2 : 0);
+    nstatus = _validate_int(aTHX_ svn, (ix==1) ? 2 : 0);
+    if (astatus != 0 && nstatus != 0) {
+      UV a = my_svuv(sva);
+      UV n = my_svuv(svn);
+      UV ret;
+      switch (ix) {
+        case 0:  ret = znorder(a, n);
+                 break;
+        case 1:  if ( (astatus == 1 && (nstatus == -1 || n > a)) ||
+                      (astatus ==-1 && (nstatus == -1 && n > a)) )
+                   { ret = 0; break; }
+                 if (nstatus == -1)
+                   n = a - n; /* n<0,k<=n:  (-1)^(n-k) * binomial(-k-1,n-k) */
+                 if (astatus == -1) {
+                   ret = binomial( -my_sviv(sva)+n-1, n );
+                   if (ret > 0 && ret <= (UV)IV_MAX)
+                     XSRETURN_IV( (IV)ret * ((n&1) ? -1 : 1) );
+                   goto overflow;
+                 } else {
+                   ret = binomial(a, n);
+                   if (ret == 0)
+                     goto overflow;
+                 }
+                 break;
+        case 2:  ret = jordan_totient(a, n);
+                 if (ret == 0 && n > 1)
+                   goto overflow;
+                 break;
+        case 3:
+        default: ret = legendre_phi(a, n);
+                 break;
+      }
+      if (ret == 0 && ix == 0)  XSRETURN_UNDEF;  /* not defined */
+      XSRETURN_UV(ret);
+    }
+    overflow:
+    switch (ix) {
+      case 0:  _vcallsub_with_pp("znorder");  break;
+      case 1:  _vcallsub_with_pp("binomial");  break;
+      case 2:  _vcallsub_with_pp("jordan_totient");  break;
+      case 3:
+      default: _vcallsub_with_pp("legendre_phi"); break;
+    }
+    return; /* skip implicit PUTBACK */
+#line 1781 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_znlog); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_znlog)
+{
+    dVAR; dXSARGS;
+    if (items != 3)
+       croak_xs_usage(cv,  "sva, svg, svp");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 1285 "XS.xs"
+    int astatus, gstatus, pstatus;
+#line 1799 "XS.c"
+	SV*	sva = ST(0)
+;
+	SV*	svg = ST(1)
+;
+	SV*	svp = ST(2)
+;
+#line 1287 "XS.xs"
+    astatus = _validate_int(aTHX_ sva, 0);
+    gstatus = _validate_int(aTHX_ svg, 0);
+    pstatus = _validate_int(aTHX_ svp, 0);
+    if (astatus == 1 && gstatus == 1 && pstatus == 1) {
+      UV ret, a = my_svuv(sva), g = my_svuv(svg), p = my_svuv(svp);
+      dMY_CXT;
+      /* A second call with the same g and p builds a table kept for reuse */
+      if (g == MY_CXT.znlog_g && p == MY_CXT.znlog_p) {
+        if (MY_CXT.znlog_ctx == 0)
+          MY_CXT.znlog_ctx = znlog_ctx_new(g, p, ZNLOG_CTX_MAXENT);
+        ret = znlog_ctx_solve(MY_CXT.znlog_ctx, a);
+      } else {
+        znlog_ctx_free(MY_CXT.znlog_ctx);
+        MY_CXT.znlog_ctx = 0;
+        MY_CXT.znlog_g = g;
+        MY_CXT.znlog_p = p;
+        ret = znlog(a, g, p);
+      }
+      /* TODO: perhaps return p to mean no solution? */
+      if (ret == 0 && a > 1) XSRETURN_UNDEF;
+      XSRETURN_UV(ret);
+    }
+    _vcallsub_with_gmp("znlog");
+    return; /* skip implicit PUTBACK */
+#line 1831 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_kronecker); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_kronecker)
+{
+    dVAR; dXSARGS;
+    dXSI32;
+    if (items != 2)
+       croak_xs_usage(cv,  "sva, svb");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 1318 "XS.xs"
+    int astatus, bstatus, abpositive, abnegative;
+#line 1850 "XS.c"
+	SV*	sva = ST(0)
+;
+	SV*	svb = ST(1)
+;
+#line 1320 "XS.xs"
+    astatus = _validate_int(aTHX_ sva, 2);
+    bstatus = _validate_int(aTHX_ svb, 2);
+    if (astatus != 0 && bstatus != 0) {
+      if (ix == 0) {
+        /* Are both a and b positive? */
+        abpositive = astatus == 1 && bstatus == 1;
+        /* Will both fit in IVs?  We should use a bitmask return. */
+        abnegative = !abpositive
+                     && (SvIOK(sva) && !SvIsUV(sva))
+                     && (SvIOK(svb) && !SvIsUV(svb));
+        if (abpositive || abnegative) {
+          UV a = my_svuv(sva);
+          UV b = my_svuv(svb);
+          int k = (abpositive) ? kronecker_uu(a,b) : kronecker_ss(a,b);
+          RETURN_NPARITY(k);
+        }
+      } else if (ix == 1) {
+        UV n = (astatus == -1) ? (UV)(-(my_sviv(sva))) : my_svuv(sva);
+        UV k = (bstatus == -1) ? (UV)(-(my_sviv(svb))) : my_svuv(svb);
+        /* valuation of 0-2 is very common, so return a constant if possible */
+        RETURN_NPARITY( valuation(n, k) );
+      } else {
+        UV a, n, ret = 0;
+        n = (bstatus != -1) ? my_svuv(svb) : (UV)(-(my_sviv(svb)));
+        if (n > 0) {
+          a = (astatus != -1) ? my_svuv(sva)
+                              : n * ((UV)(-my_sviv(sva))/n + 1) + my_sviv(sva);
+          if (a > 0) {
+            if (n == 1) XSRETURN_UV(0);
+            ret = modinverse(a, n);
+          }
+        }
+        if (ret == 0) XSRETURN_UNDEF;
+        XSRETURN_UV(ret);
+      }
+    }
+    switch (ix) {
+      case 0:  _vcallsub_with_gmp("kronecker");  break;
+      case 1:  _vcallsub_with_gmp("valuation"); break;
+      case 2:
+      default: _vcallsub_with_gmp("invmod"); break;
+    }
+    return; /* skip implicit PUTBACK */
+#line 1899 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_gcdext); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_gcdext)
+{
+    dVAR; dXSARGS;
+    if (items != 2)
+       croak_xs_usage(cv,  "sva, svb");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 1367 "XS.xs"
+    int astatus, bstatus;
+#line 1917 "XS.c"
+	SV*	sva = ST(0)
+;
+	SV*	svb = ST(1)
+;
+#line 1369 "XS.xs"
+    astatus = _validate_int(aTHX_ sva, 2);
+    bstatus = _validate_int(aTHX_ svb, 2);
+    /* TODO: These should be built into validate_int */
+    if ( (astatus == 1 && SvIsUV(sva)) || (astatus == -1 && !SvIOK(sva)) )
+      astatus = 0;  /* too large */
+    if ( (bstatus == 1 && SvIsUV(svb)) || (bstatus == -1 && !SvIOK(svb)) )
+      bstatus = 0;  /* too large */
+    if (astatus != 0 && bstatus != 0) {
+      IV u, v, d;
+      IV a = my_sviv(sva);
+      IV b = my_sviv(svb);
+      d = gcdext(a, b, &u, &v, 0, 0);
+      XPUSHs(sv_2mortal(newSViv( u )));
+      XPUSHs(sv_2mortal(newSViv( v )));
+      XPUSHs(sv_2mortal(newSViv( d )));
+    } else {
+      _vcallsubn(aTHX_ GIMME_V, VCALL_PP, "gcdext", items);
+      return; /* skip implicit PUTBACK */
+    }
+#line 1942 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_stirling); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_stirling)
+{
+    dVAR; dXSARGS;
+    if (items < 2 || items > 3)
+       croak_xs_usage(cv,  "n, m, type= 1");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+	UV	n = (UV)SvUV(ST(0))
+;
+	UV	m = (UV)SvUV(ST(1))
+;
+	UV	type;
+
+	if (items < 3)
+	    type = 1;
+	else {
+	    type = (UV)SvUV(ST(2))
+;
+	}
+#line 1392 "XS.xs"
+    if (type != 1 && type != 2)
+      croak("stirling type must be 1 or 2");
+    if (n == m)
+      XSRETURN_UV(1);
+    else if (n == 0 || m == 0 || m > n)
+      XSRETURN_UV(0);
+    else if (m == 1 && type == 2)
+      XSRETURN_UV(1);
+    else if (m == 1 && type == 1) {
+      UV f = factorial(n-1);
+      if (f != 0 && f <= (UV)IV_MAX) XSRETURN_IV( f * ((n&1) ? 1 : -1) );
+    } else if (type == 2) {
+      IV s = stirling2(n, m);
+      if (s != 0) XSRETURN_IV(s);
+    } else if (type == 1) {
+      IV s = stirling1(n, m);
+      if (s != 0) XSRETURN_IV(s);
+    }
+    _vcallsub_with_pp("stirling");
+    return;
+#line 1991 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util__XS_ExponentialIntegral); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util__XS_ExponentialIntegral)
+{
+    dVAR; dXSARGS;
+    dXSI32;
+    if (items != 1)
+       croak_xs_usage(cv,  "x");
+    {
+#line 1421 "XS.xs"
+    NV nv, ret;
+#line 2008 "XS.c"
+	NV	RETVAL;
+	dXSTARG;
+	SV*	x = ST(0)
+;
+#line 1423 "XS.xs"
+    nv = SvNV(x);
+    switch (ix) {
+      case 0: ret = (NV) _XS_ExponentialIntegral(nv); break;
+      case 1: ret = (NV) _XS_LogarithmicIntegral(nv); break;
+      case 2: ret = (NV) ld_riemann_zeta(nv); break;
+      case 3: ret = (NV) _XS_RiemannR(nv); break;
+      case 4:
+      default:ret = (NV) lambertw(nv); break;
+    }
+    RETVAL = ret;
+#line 2024 "XS.c"
+	XSprePUSH;
+	PUSHn((NV)RETVAL);
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_euler_phi); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_euler_phi)
+{
+    dVAR; dXSARGS;
+    dXSI32;
+    if (items < 1)
+       croak_xs_usage(cv,  "svlo, ...");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 1441 "XS.xs"
+    int lostatus, histatus;
+#line 2044 "XS.c"
+	SV*	svlo = ST(0)
+;
+#line 1443 "XS.xs"
+    lostatus = _validate_int(aTHX_ svlo, 2);
+    histatus = (items == 1 || _validate_int(aTHX_ ST(1), 0));
+    if (items == 1 && lostatus != 0) {
+      /* input is a single value and in UV/IV range */
+      if (ix == 0) {
+        UV n = (lostatus == -1) ? 0 : my_svuv(svlo);
+        XSRETURN_UV(totient(n));
+      } else {
+        UV n = (lostatus == -1) ? (UV)(-(my_sviv(svlo))) : my_svuv(svlo);
+        RETURN_NPARITY(moebius(n));
+      }
+    } else if (items == 2 && lostatus == 1 && histatus == 1) {
+      /* input is a range and both lo and hi are non-negative */
+      UV lo = my_svuv(svlo);
+      UV hi = my_svuv(ST(1));
+      if (lo <= hi) {
+        UV i, wlo, whi;
+        void* ctx;
+        EXTEND(SP, hi-lo+1);
+        if (ix == 0) {
+          const UV* totients;
+          ctx = start_totient_range(lo, hi);
+          while (next_totient_range(ctx, &wlo, &whi, &totients))
+            for (i = 0; i <= whi-wlo; i++)
+              PUSHs(sv_2mortal(newSVuv(totients[i])));
+          end_totient_range(ctx);
+        } else {
+          const signed char* mu;
+          dMY_CXT;
+          ctx = start_moebius_range(lo, hi);
+          while (next_moebius_range(ctx, &wlo, &whi, &mu))
+            for (i = 0; i <= whi-wlo; i++)
+              PUSH_NPARITY(mu[i]);
+          end_moebius_range(ctx);
+        }
+      }
+    } else {
+      /* Whatever we didn't handle above */
+      U32 gimme_v = GIMME_V;
+      switch (ix) {
+        case 0:  _vcallsubn(aTHX_ gimme_v, VCALL_PP, "euler_phi", items);break;
+        case 1:
+        default: _vcallsubn(aTHX_ gimme_v, VCALL_GMP|VCALL_PP, "moebius", items);  break;
+      }
+      return;
+    }
+#line 2094 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_carmichael_lambda); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_carmichael_lambda)
+{
+    dVAR; dXSARGS;
+    dXSI32;
+    if (items != 1)
+       croak_xs_usage(cv,  "svn");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 1502 "XS.xs"
+    int status;
+#line 2113 "XS.c"
+	SV*	svn = ST(0)
+;
+#line 1504 "XS.xs"
+    status = _validate_int(aTHX_ svn, (ix >= 6) ? 1 : 0);
+    if (status != 0) {
+      UV r, n = my_svuv(svn);
+      switch (ix) {
+        case 0:  XSRETURN_UV(carmichael_lambda(n)); break;
+        case 1:  XSRETURN_IV(mertens(n)); break;
+        case 2:  { UV factors[MPU_MAX_FACTORS+1];
+                   int nfactors = factor(my_svuv(svn), factors);
+                   RETURN_NPARITY( (nfactors & 1) ? -1 : 1 ); }
+                 break;
+        case 3:  XSRETURN_NV(chebyshev_function(n, 0)); break;
+        case 4:  XSRETURN_NV(chebyshev_function(n, 1)); break;
+        case 5:  r = factorial(n);
+                 if (r != 0) XSRETURN_UV(r);
+                 status = 0; break;
+        case 6:  XSRETURN_UV( (status == -1) ? 1 : exp_mangoldt(n) ); break;
+        case 7:  if (status == -1) n = -(IV)n;
+                 r = znprimroot(n);
+                 if (r == 0 && n != 1)  XSRETURN_UNDEF;  /* No root */
+                 XSRETURN_UV(r);  break;
+        case 8:
+        default: if (status == -1) n = -(IV)n;
+                 XSRETURN_UV(mpu_popcount(n));  break;
+      }
+    }
+    switch (ix) {
+      case 0:  _vcallsub_with_gmp("carmichael_lambda");  break;
+      case 1:  _vcallsub_with_pp("mertens"); break;
+      case 2:  _vcallsub_with_gmp("liouville"); break;
+      case 3:  _vcallsub_with_pp("chebyshev_theta"); break;
+      case 4:  _vcallsub_with_pp("chebyshev_psi"); break;
+      case 5:  _vcallsub_with_pp("factorial"); break;
+      case 6:  _vcallsub_with_gmp("exp_mangoldt"); break;
+      case 7:  _vcallsub_with_gmp("znprimroot"); break;
+      case 8:
+      default: { char* ptr;  STRLEN len;  ptr = SvPV_nomg(svn, len);
+                 XSRETURN_UV(mpu_popcount_string(ptr, len)); }
+               break;
+    }
+    return; /* skip implicit PUTBACK */
+#line 2157 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_totient_sum); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_totient_sum)
+{
+    dVAR; dXSARGS;
+    dXSI32;
+    if (items != 1)
+       croak_xs_usage(cv,  "svn");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 1550 "XS.xs"
+    UV n, hi, lo;
+#line 2176 "XS.c"
+	SV*	svn = ST(0)
+;
+#line 1552 "XS.xs"
+    if (_validate_int(aTHX_ svn, 0) != 0) {
+      n = my_svuv(svn);
+      if (ix == 1)  XSRETURN_UV(squarefree_count(n));
+      if (totient_sum(n, &hi, &lo)) {
+        char str[48];
+        if (hi == 0)  XSRETURN_UV(lo);
+        (void) to_string_128(str, hi, lo);
+        ST(0) = sv_2mortal(newSVpv(str, 0));
+        OBJECTIFY_RESULT(svn, ST(0));
+        XSRETURN(1);
+      }
+    }
+    if (ix == 0) _vcallsub_with_pp("totient_sum");
+    else         _vcallsub_with_pp("squarefree_count");
+    return; /* skip implicit PUTBACK */
+#line 2195 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_divisor_summatory); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_divisor_summatory)
+{
+    dVAR; dXSARGS;
+    if (items < 1 || items > 2)
+       croak_xs_usage(cv,  "svn, svk= 0");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 1571 "XS.xs"
+    UV n, k, hi, lo;
+#line 2213 "XS.c"
+	SV*	svn = ST(0)
+;
+	SV*	svk;
+
+	if (items < 2)
+	    svk = 0;
+	else {
+	    svk = ST(1)
+;
+	}
+#line 1573 "XS.xs"
+    if (_validate_int(aTHX_ svn, 0) != 0 && (svk == 0 || _validate_int(aTHX_ svk, 0) != 0)) {
+      n = my_svuv(svn);
+      k = (svk == 0) ? 1 : my_svuv(svk);
+      if (divisor_summatory(n, k, &hi, &lo)) {
+        char str[48];
+        if (hi == 0)  XSRETURN_UV(lo);
+        (void) to_string_128(str, hi, lo);
+        ST(0) = sv_2mortal(newSVpv(str, 0));
+        OBJECTIFY_RESULT(svn, ST(0));
+        XSRETURN(1);
+      }
+    }
+    _vcallsub_with_pp("divisor_summatory");
+    return; /* skip implicit PUTBACK */
+#line 2239 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util__validate_num); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util__validate_num)
+{
+    dVAR; dXSARGS;
+    if (items < 1)
+       croak_xs_usage(cv,  "svn, ...");
+    {
+#line 1591 "XS.xs"
+    SV* sv1;
+    SV* sv2;
+#line 2256 "XS.c"
+	bool	RETVAL;
+	SV*	svn = ST(0)
+;
+#line 1594 "XS.xs"
+    /* Internal function.  Emulate the PP version of this:
+     *   $is_valid = _validate_num( $n [, $min [, $max] ] )
+     * Return 0 if we're befuddled by the input.
+     * Otherwise croak if n isn't >= 0 and integer, n < min, or n > max.
+     * Small bigints will be converted to scalars.
+     */
+    RETVAL = FALSE;
+    if (_validate_int(aTHX_ svn, 0)) {
+      if (SvROK(svn)) {  /* Convert small Math::BigInt object into scalar */
+        UV n = my_svuv(svn);
+#if PERL_REVISION <= 5 && PERL_VERSION < 8 && BITS_PER_WORD == 64
+        sv_setpviv(svn, n);
+#else
+        sv_setuv(svn, n);
+#endif
+      }
+      if (items > 1 && ((sv1 = ST(1)), SvOK(sv1))) {
+        UV n = my_svuv(svn);
+        UV min = my_svuv(sv1);
+        if (n < min)
+          croak("Parameter '%"UVuf"' must be >= %"UVuf, n, min);
+        if (items > 2 && ((sv2 = ST(2)), SvOK(sv2))) {
+          UV max = my_svuv(sv2);
+          if (n > max)
+            croak("Parameter '%"UVuf"' must be <= %"UVuf, n, max);
+          MPUassert( items <= 3, "_validate_num takes at most 3 parameters");
+        }
+      }
+      RETVAL = TRUE;
+    }
+#line 2291 "XS.c"
+	ST(0) = boolSV(RETVAL);
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_forprimes); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_forprimes)
+{
+    dVAR; dXSARGS;
+    if (items < 2 || items > 3)
+       croak_xs_usage(cv,  "block, svbeg, svend= 0");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 1631 "XS.xs"
+    GV *gv;
+    HV *stash;
+    SV* svarg;
+    CV *cv;
+    unsigned char* segment;
+    UV beg, end, seg_base, seg_low, seg_high;
+#line 2314 "XS.c"
+	SV*	block = ST(0)
+;
+	SV*	svbeg = ST(1)
+;
+	SV*	svend;
+
+	if (items < 3)
+	    svend = 0;
+	else {
+	    svend = ST(2)
+;
+	}
+#line 1638 "XS.xs"
+    cv = sv_2cv(block, &stash, &gv, 0);
+    if (cv == Nullcv)
+      croak("Not a subroutine reference");
+
+    if (!_validate_int(aTHX_ svbeg, 0) || (items >= 3 && !_validate_int(aTHX_ svend,0))) {
+      _vcallsubn(aTHX_ G_VOID|G_DISCARD, VCALL_ROOT, "_generic_forprimes", items);
+      return;
+    }
+
+    if (items < 3) {
+      beg = 2;
+      end = my_svuv(svbeg);
+    } else {
+      beg = my_svuv(svbeg);
+      end = my_svuv(svend);
+    }
+
+    SAVESPTR(GvSV(PL_defgv));
+    svarg = newSVuv(beg);
+    GvSV(PL_defgv) = svarg;
+    /* Handle early part */
+    while (beg < 6) {
+      beg = (beg <= 2) ? 2 : (beg <= 3) ? 3 : 5;
+      if (beg <= end) {
+        sv_setuv(svarg, beg);
+        PUSHMARK(SP);
+        call_sv((SV*)cv, G_VOID|G_DISCARD);
+      }
+      beg += 1 + (beg > 2);
+    }
+#if USE_MULTICALL
+    if (!CvISXSUB(cv) && beg <= end) {
+      dMULTICALL;
+      I32 gimme = G_VOID;
+      PUSH_MULTICALL(cv);
+      if (
+#if BITS_PER_WORD == 64
+          (beg >= UVCONST(     100000000000000) && end-beg <    100000) ||
+          (beg >= UVCONST(      10000000000000) && end-beg <     40000) ||
+          (beg >= UVCONST(       1000000000000) && end-beg <     17000) ||
+#endif
+          ((end-beg) < 500) ) {     /* MULTICALL next prime */
+        for (beg = next_prime(beg-1); beg <= end && beg != 0; beg = next_prime(beg)) {
+          sv_setuv(svarg, beg);
+          MULTICALL;
+        }
+      } else {                      /* MULTICALL segment sieve */
+        void* ctx = start_segment_primes(beg, end, &segment);
+        while (next_segment_primes(ctx, &seg_base, &seg_low, &seg_high)) {
+          int crossuv = (seg_high > IV_MAX) && !SvIsUV(svarg);
+          START_DO_FOR_EACH_SIEVE_PRIME( segment, seg_low - seg_base, seg_high - seg_base ) {
+            p += seg_base;
+            /* sv_setuv(svarg, p); */
+            if      (SvTYPE(svarg) != SVt_IV) { sv_setuv(svarg, p);            }
+            else if (crossuv && p > IV_MAX)   { sv_setuv(svarg, p); crossuv=0; }
+            else                              { SvUV_set(svarg, p);            }
+            MULTICALL;
+          } END_DO_FOR_EACH_SIEVE_PRIME
+        }
+        end_segment_primes(ctx);
+      }
+      FIX_MULTICALL_REFCOUNT;
+      POP_MULTICALL;
+    }
+    else
+#endif
+    if (beg <= end) {               /* NO-MULTICALL segment sieve */
+      void* ctx = start_segment_primes(beg, end, &segment);
+      while (next_segment_primes(ctx, &seg_base, &seg_low, &seg_high)) {
+        START_DO_FOR_EACH_SIEVE_PRIME( segment, seg_low - seg_base, seg_high - seg_base ) {
+          sv_setuv(svarg, seg_base + p);
+          PUSHMARK(SP);
+          call_sv((SV*)cv, G_VOID|G_DISCARD);
+        } END_DO_FOR_EACH_SIEVE_PRIME
+      }
+      end_segment_primes(ctx);
+    }
+    SvREFCNT_dec(svarg);
+#line 2406 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_forcomposites); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_forcomposites)
+{
+    dVAR; dXSARGS;
+    dXSI32;
+    if (items < 2 || items > 3)
+       croak_xs_usage(cv,  "block, svbeg, svend= 0");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 1723 "XS.xs"
+    UV beg, end;
+    GV *gv;
+    HV *stash;
+    SV* svarg;  /* We use svarg to prevent clobbering $_ outside the block */
+    CV *cv;
+#line 2429 "XS.c"
+	SV*	block = ST(0)
+;
+	SV*	svbeg = ST(1)
+;
+	SV*	svend;
+
+	if (items < 3)
+	    svend = 0;
+	else {
+	    svend = ST(2)
+;
+	}
+#line 1729 "XS.xs"
+    cv = sv_2cv(block, &stash, &gv, 0);
+    if (cv == Nullcv)
+      croak("Not a subroutine reference");
+
+    if (!_validate_int(aTHX_ svbeg, 0) || (items >= 3 && !_validate_int(aTHX_ svend,0))) {
+      _vcallsubn(aTHX_ G_VOID|G_DISCARD, VCALL_ROOT, (ix == 0) ? "_generic_forcomposites" : "_generic_foroddcomposites", items);
+      return;
+    }
+
+    if (items < 3) {
+      beg = ix ? 9 : 4;
+      end = my_svuv(svbeg);
+    } else {
+      beg = my_svuv(svbeg);
+      end = my_svuv(svend);
+    }
+
+    SAVESPTR(GvSV(PL_defgv));
+    svarg = newSVuv(0);
+    GvSV(PL_defgv) = svarg;
+#if USE_MULTICALL
+    if (!CvISXSUB(cv) && end >= beg) {
+      unsigned char* segment;
+      UV seg_base, seg_low, seg_high, c, cbeg, cend, prevprime, nextprime;
+      void* ctx;
+      dMULTICALL;
+      I32 gimme = G_VOID;
+      PUSH_MULTICALL(cv);
+      if (beg >= MPU_MAX_PRIME ||
+#if BITS_PER_WORD == 64
+          (beg >= UVCONST(     100000000000000) && end-beg <    120000) ||
+          (beg >= UVCONST(      10000000000000) && end-beg <     50000) ||
+          (beg >= UVCONST(       1000000000000) && end-beg <     20000) ||
+#endif
+          end-beg < 1000 ) {
+        beg = (beg <= 4) ? 3 : beg-1;
+        nextprime = next_prime(beg);
+        while (beg++ < end) {
+          if (beg == nextprime)     nextprime = next_prime(beg);
+          else if (!ix || beg & 1)  { sv_setuv(svarg, beg); MULTICALL; }
+        }
+      } else {
+        if (ix) {
+          if (beg < 9)  beg = 9;
+        } else if (beg <= 4) { /* sieve starts at 7, so handle this here */
+          sv_setuv(svarg, 4);  MULTICALL;
+          beg = 6;
+        }
+        /* Find the two primes that bound their interval. */
+        /* beg must be < max_prime, and end >= max_prime is special. */
+        prevprime = prev_prime(beg);
+        nextprime = (end >= MPU_MAX_PRIME) ? MPU_MAX_PRIME : next_prime(end);
+        ctx = start_segment_primes(beg, nextprime, &segment);
+        while (next_segment_primes(ctx, &seg_base, &seg_low, &seg_high)) {
+          START_DO_FOR_EACH_SIEVE_PRIME( segment, seg_low - seg_base, seg_high - seg_base ) {
+            cbeg = prevprime+1;  if (cbeg < beg) cbeg = beg;
+            prevprime = seg_base + p;
+            cend = prevprime-1;  if (cend > end) cend = end;
+            for (c = cbeg; c <= cend; c++) {
+              if (!ix || c & 1) { sv_setuv(svarg, c);  MULTICALL; }
+            }
+          } END_DO_FOR_EACH_SIEVE_PRIME
+        }
+        end_segment_primes(ctx);
+        if (end > nextprime)   /* Complete the case where end > max_prime */
+          while (nextprime++ < end)
+            if (!ix || nextprime & 1)
+              { sv_setuv(svarg, nextprime);  MULTICALL; }
+      }
+      FIX_MULTICALL_REFCOUNT;
+      POP_MULTICALL;
+    }
+    else
+#endif
+    if (beg <= end) {
+      beg = (beg <= 4) ? 3 : beg-1;
+      while (beg++ < end) {
+        if ((!ix || beg&1) && !is_prob_prime(beg)) {
+          sv_setuv(svarg, beg);
+          PUSHMARK(SP);
+          call_sv((SV*)cv, G_VOID|G_DISCARD);
+        }
+      }
+    }
+    SvREFCNT_dec(svarg);
+#line 2528 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_fordivisors); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_fordivisors)
+{
+    dVAR; dXSARGS;
+    if (items != 2)
+       croak_xs_usage(cv,  "block, svn");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 1819 "XS.xs"
+    UV n, d;
+    void *ctx;
+    GV *gv;
+    HV *stash;
+    SV* svarg;  /* We use svarg to prevent clobbering $_ outside the block */
+    CV *cv;
+#line 2551 "XS.c"
+	SV*	block = ST(0)
+;
+	SV*	svn = ST(1)
+;
+#line 1826 "XS.xs"
+    cv = sv_2cv(block, &stash, &gv, 0);
+    if (cv == Nullcv)
+      croak("Not a subroutine reference");
+
+    if (!_validate_int(aTHX_ svn, 0)) {
+      _vcallsubn(aTHX_ G_VOID|G_DISCARD, VCALL_ROOT, "_generic_fordivisors", 2);
+      return;
+    }
+
+    n = my_svuv(svn);
+    ctx = start_divisors(n);
+
+    SAVESPTR(GvSV(PL_defgv));
+    svarg = newSVuv(0);
+    GvSV(PL_defgv) = svarg;
+#if USE_MULTICALL
+    if (!CvISXSUB(cv)) {
+      dMULTICALL;
+      I32 gimme = G_VOID;
+      PUSH_MULTICALL(cv);
+      while (next_divisor(ctx, &d)) {
+        sv_setuv(svarg, d);
+        MULTICALL;
+      }
+      FIX_MULTICALL_REFCOUNT;
+      POP_MULTICALL;
+    }
+    else
+#endif
+    {
+      while (next_divisor(ctx, &d)) {
+        sv_setuv(svarg, d);
+        PUSHMARK(SP);
+        call_sv((SV*)cv, G_VOID|G_DISCARD);
+      }
+    }
+    SvREFCNT_dec(svarg);
+    end_divisors(ctx);
+#line 2595 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_forfactored); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_forfactored)
+{
+    dVAR; dXSARGS;
+    if (items < 2 || items > 3)
+       croak_xs_usage(cv,  "block, svbeg, svend= 0");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 1869 "XS.xs"
+    UV beg, end, n, factors[MPU_MAX_FACTORS+1];
+    int i, nfactors;
+    void* ctx;
+    GV *gv;
+    HV *stash;
+    SV* svarg;  /* We use svarg to prevent clobbering $_ outside the block */
+    CV *cv;
+#line 2619 "XS.c"
+	SV*	block = ST(0)
+;
+	SV*	svbeg = ST(1)
+;
+	SV*	svend;
+
+	if (items < 3)
+	    svend = 0;
+	else {
+	    svend = ST(2)
+;
+	}
+#line 1877 "XS.xs"
+    cv = sv_2cv(block, &stash, &gv, 0);
+    if (cv == Nullcv)
+      croak("Not a subroutine reference");
+
+    if (!_validate_int(aTHX_ svbeg, 0) || (items >= 3 && !_validate_int(aTHX_ svend,0))) {
+      _vcallsubn(aTHX_ G_VOID|G_DISCARD, VCALL_ROOT, "_generic_forfactored", items);
+      return;
+    }
+
+    if (items < 3) {
+      beg = 1;
+      end = my_svuv(svbeg);
+    } else {
+      beg = my_svuv(svbeg);
+      end = my_svuv(svend);
+    }
+
+    SAVESPTR(GvSV(PL_defgv));
+    svarg = newSVuv(0);
+    GvSV(PL_defgv) = svarg;
+    /* The factors are passed in @_, so we use call_sv as forpart does. */
+    ctx = start_factor_range(beg, end);
+    while ( (nfactors = next_factor_range(ctx, &n, factors)) >= 0 ) {
+      dSP;
+      sv_setuv(svarg, n);
+      ENTER; SAVETMPS; PUSHMARK(SP);
+      EXTEND(SP, nfactors);
+      for (i = 0; i < nfactors; i++)
+        PUSHs(sv_2mortal(newSVuv(factors[i])));
+      PUTBACK; call_sv((SV*)cv, G_VOID|G_DISCARD);
+      FREETMPS; LEAVE;
+    }
+    end_factor_range(ctx);
+    SvREFCNT_dec(svarg);
+#line 2667 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_fortotients); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_fortotients)
+{
+    dVAR; dXSARGS;
+    dXSI32;
+    if (items < 2 || items > 3)
+       croak_xs_usage(cv,  "block, svbeg, svend= 0");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 1918 "XS.xs"
+    UV beg, end, wlo, whi, i;
+    const UV* totients;
+    const signed char* mu;
+    void* ctx;
+    GV *gv;
+    HV *stash;
+    SV* svarg;  /* We use svarg to prevent clobbering $_ outside the block */
+    SV* svval;
+    CV *cv;
+#line 2694 "XS.c"
+	SV*	block = ST(0)
+;
+	SV*	svbeg = ST(1)
+;
+	SV*	svend;
+
+	if (items < 3)
+	    svend = 0;
+	else {
+	    svend = ST(2)
+;
+	}
+#line 1928 "XS.xs"
+    cv = sv_2cv(block, &stash, &gv, 0);
+    if (cv == Nullcv)
+      croak("Not a subroutine reference");
+
+    if (!_validate_int(aTHX_ svbeg, 0) || (items >= 3 && !_validate_int(aTHX_ svend,0))) {
+      _vcallsubn(aTHX_ G_VOID|G_DISCARD, VCALL_ROOT, (ix == 0) ? "_generic_fortotients" : "_generic_formoebius", items);
+      return;
+    }
+
+    if (items < 3) {
+      beg = 1;
+      end = my_svuv(svbeg);
+    } else {
+      beg = my_svuv(svbeg);
+      end = my_svuv(svend);
+    }
+
+    SAVESPTR(GvSV(PL_defgv));
+    svarg = newSVuv(0);
+    svval = newSViv(0);
+    GvSV(PL_defgv) = svarg;
+    /* The value is passed in $_[0], one window of the sieve at a time. */
+    ctx = (ix == 0) ? start_totient_range(beg, end) : start_moebius_range(beg, end);
+    while ( (ix == 0) ? next_totient_range(ctx, &wlo, &whi, &totients)
+                      : next_moebius_range(ctx, &wlo, &whi, &mu) ) {
+      for (i = 0; i <= whi-wlo; i++) {
+        dSP;
+        sv_setuv(svarg, wlo+i);
+        if (ix == 0) sv_setuv(svval, totients[i]);
+        else         sv_setiv(svval, mu[i]);
+        PUSHMARK(SP);
+        XPUSHs(svval);
+        PUTBACK; call_sv((SV*)cv, G_VOID|G_DISCARD);
+      }
+    }
+    if (ix == 0) end_totient_range(ctx);
+    else         end_moebius_range(ctx);
+    SvREFCNT_dec(svval);
+    SvREFCNT_dec(svarg);
+#line 2747 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_forsigma); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_forsigma)
+{
+    dVAR; dXSARGS;
+    if (items < 3 || items > 4)
+       croak_xs_usage(cv,  "block, svk, svbeg, svend= 0");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 1972 "XS.xs"
+    UV k, beg, end, wlo, whi, i;
+    const UV* sigma;
+    void* ctx = 0;
+    GV *gv;
+    HV *stash;
+    SV* svarg;
+    SV* svval;
+    CV *cv;
+#line 2772 "XS.c"
+	SV*	block = ST(0)
+;
+	SV*	svk = ST(1)
+;
+	SV*	svbeg = ST(2)
+;
+	SV*	svend;
+
+	if (items < 4)
+	    svend = 0;
+	else {
+	    svend = ST(3)
+;
+	}
+#line 1981 "XS.xs"
+    cv = sv_2cv(block, &stash, &gv, 0);
+    if (cv == Nullcv)
+      croak("Not a subroutine reference");
+
+    if (_validate_int(aTHX_ svk, 0) && _validate_int(aTHX_ svbeg, 0) && (items < 4 || _validate_int(aTHX_ svend, 0))) {
+      k = my_svuv(svk);
+      beg = (items < 4) ? 1 : my_svuv(svbeg);
+      end = (items < 4) ? my_svuv(svbeg) : my_svuv(svend);
+      ctx = start_sigma_range(beg, end, k);
+    }
+    if (ctx == 0) {     /* bigints, or sigma_k could overflow */
+      _vcallsubn(aTHX_ G_VOID|G_DISCARD, VCALL_ROOT, "_generic_forsigma", items);
+      return;
+    }
+
+    SAVESPTR(GvSV(PL_defgv));
+    svarg = newSVuv(0);
+    svval = newSVuv(0);
+    GvSV(PL_defgv) = svarg;
+    while (next_sigma_range(ctx, &wlo, &whi, &sigma)) {
+      for (i = 0; i <= whi-wlo; i++) {
+        dSP;
+        sv_setuv(svarg, wlo+i);
+        sv_setuv(svval, sigma[i]);
+        PUSHMARK(SP);
+        XPUSHs(svval);
+        PUTBACK; call_sv((SV*)cv, G_VOID|G_DISCARD);
+      }
+    }
+    end_sigma_range(ctx);
+    SvREFCNT_dec(svval);
+    SvREFCNT_dec(svarg);
+#line 2820 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_forpart); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_forpart)
+{
+    dVAR; dXSARGS;
+    if (items < 2 || items > 3)
+       croak_xs_usage(cv,  "block, svn, svh= 0");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 2018 "XS.xs"
+    UV i, n, amin, amax, nmin, nmax;
+    GV *gv;
+    HV *stash;
+    CV *cv;
+    SV** svals;
+#line 2842 "XS.c"
+	SV*	block = ST(0)
+;
+	SV*	svn = ST(1)
+;
+	SV*	svh;
+
+	if (items < 3)
+	    svh = 0;
+	else {
+	    svh = ST(2)
+;
+	}
+#line 2024 "XS.xs"
+    cv = sv_2cv(block, &stash, &gv, 0);
+    if (cv == Nullcv)
+      croak("Not a subroutine reference");
+    if (!_validate_int(aTHX_ svn, 0)) {
+      _vcallsub_with_pp("forpart");
+      return;
+    }
+    n = my_svuv(svn);
+    if (n > (UV_MAX-2)) croak("forpart argument overflow");
+
+    New(0, svals, n+1, SV*);
+    for (i = 0; i <= n; i++) {
+      svals[i] = newSVuv(i);
+      SvREADONLY_on(svals[i]);
+    }
+
+    amin = 0;  amax = n;  nmin = 0;  nmax = n;
+    if (svh != 0) {
+      HV* rhash;
+      SV** svp;
+      if (!SvROK(svh) || SvTYPE(SvRV(svh)) != SVt_PVHV)
+        croak("forpart second argument must be a hash reference");
+      rhash = (HV*) SvRV(svh);
+      if ((svp = hv_fetchs(rhash, "n", 0)) != NULL)
+        { nmin = my_svuv(*svp);  nmax = nmin; }
+      if ((svp = hv_fetchs(rhash, "amin", 0)) != NULL) amin = my_svuv(*svp);
+      if ((svp = hv_fetchs(rhash, "amax", 0)) != NULL) amax = my_svuv(*svp);
+      if ((svp = hv_fetchs(rhash, "nmin", 0)) != NULL) nmin = my_svuv(*svp);
+      if ((svp = hv_fetchs(rhash, "nmax", 0)) != NULL) nmax = my_svuv(*svp);
+
+      if (amax > n) amax = n;
+      if (nmax > n) nmax = n;
+    }
+
+    if (n==0 || (nmin <= nmax && amin <= amax && nmax > 0 && amax > 0))
+    { /* ZS1 algorithm from Zoghbi and Stojmenovic 1998) */
+      UV *x, m, h;
+      New(0, x, n+2, UV);  /* plus 2 because of n=0 */
+      for (i = 0; i <= n; i++)  x[i] = 1;
+      x[1] = n;
+      m = (n > 0) ? 1 : 0;   /* n=0 => one call with empty list */
+      h = 1;
+
+      if (nmin > 1) {
+        UV max = n - nmin + 1;
+        UV t = n - max;
+        x[h=1] = max;
+        while (t >= max) {  x[++h] = max;  t -= max;  }
+        m = h + (t > 0);
+        if (t > 1)  x[++h] = t;
+      }
+
+      if (x[1] > amax) { /* x[1] is always decreasing, so handle it here */
+        UV t = n - amax;
+        x[h=1] = amax;
+        while (t >= amax) {  x[++h] = amax;  t -= amax;  }
+        m = h + (t > 0);
+        if (t > 1)  x[++h] = t;
+      }
+
+      /* More restriction optimizations would be useful. */
+      while (1) {
+        if (m >= nmin && m <= nmax && x[m] >= amin)
+        { dSP; ENTER; PUSHMARK(SP);
+          EXTEND(SP, m); for (i=1; i <= m; i++) { PUSHs(svals[x[i]]); }
+          PUTBACK; call_sv((SV*)cv, G_VOID|G_DISCARD); LEAVE;
+        }
+        if (x[1] <= 1 || x[1] < amin) break;
+        /* Skip forward if restricted and we can move on. */
+        if (x[2] < amin || (m > nmax && (n-x[1]+x[2]-1)/x[2] >= nmax)) {
+          for (m = 1; n >= (x[1] + m); m++)
+            x[m+1] = 1;
+          h = 1;
+        }
+        if (x[h] == 2) {
+          m++;  x[h--] = 1;
+        } else {
+          UV r = x[h]-1;
+          UV t = m-h+1;
+          x[h] = r;
+          while (t >= r) {  x[++h] = r;  t -= r;  }
+          m = h + (t > 0);
+          if (t > 1)  x[++h] = t;
+        }
+      }
+      Safefree(x);
+    }
+    for (i = 0; i <= n; i++)
+      SvREFCNT_dec(svals[i]);
+    Safefree(svals);
+#line 2946 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_forcomb); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_forcomb)
+{
+    dVAR; dXSARGS;
+    dXSI32;
+    if (items < 2 || items > 3)
+       croak_xs_usage(cv,  "block, svn, svk= 0");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 2121 "XS.xs"
+    UV i, n, k, j, m;
+    GV *gv;
+    HV *stash;
+    CV *cv;
+    SV** svals;
+    UV*  cm;
+#line 2970 "XS.c"
+	SV*	block = ST(0)
+;
+	SV*	svn = ST(1)
+;
+	SV*	svk;
+
+	if (items < 3)
+	    svk = 0;
+	else {
+	    svk = ST(2)
+;
+	}
+#line 2128 "XS.xs"
+    cv = sv_2cv(block, &stash, &gv, 0);
+    if (cv == Nullcv)
+      croak("Not a subroutine reference");
+    if (ix == 1 && svk != 0)
+      croak("Too many arguments for forperm");
+
+    if (!_validate_int(aTHX_ svn, 0) || (svk != 0 && !_validate_int(aTHX_ svk, 0))) {
+      _vcallsub_with_pp( (ix == 0) ? "forcomb" : "forperm" );
+      return;
+    }
+
+    n = my_svuv(svn);
+    k = (svk == 0) ? n : my_svuv(svk);
+    if (k > n)
+      return;
+
+    New(0, cm, k+1, UV);
+    cm[0] = UV_MAX;
+    for (i = 0; i < k; i++)
+      cm[i] = k-i;
+
+    New(0, svals, n, SV*);
+    for (i = 0; i < n; i++) {
+      svals[i] = newSVuv(i);
+      SvREADONLY_on(svals[i]);
+    }
+
+    while (1) {
+      { dSP; ENTER; PUSHMARK(SP);                /* Send the values */
+        EXTEND(SP, k);
+        for (i = 0; i < k; i++) { PUSHs(svals[ cm[k-i-1]-1 ]); }
+        PUTBACK; call_sv((SV*)cv, G_VOID|G_DISCARD); LEAVE;
+      }
+      if (ix == 0) {
+        if (cm[0]++ < n)  continue;                /* Increment last value */
+        for (i = 1; i < k && cm[i] >= n-i; i++) ;  /* Find next index to incr */
+        if (i >= k)  break;                        /* Done! */
+        cm[i]++;                                   /* Increment this one */
+        while (i-- > 0)  cm[i] = cm[i+1] + 1;      /* Set the rest */
+      } else {
+        for (j = 1; j < k && cm[j] > cm[j-1]; j++) ;    /* Find last decrease */
+        if (j >= k) break;                              /* Done! */
+        for (m = 0; cm[j] > cm[m]; m++)                 /* Find next greater */
+          ;
+        { UV t = cm[j];  cm[j] = cm[m];  cm[m] = t; }   /* Swap */
+        for (i = j-1, m = 0;  m < i;  i--, m++)         /* Reverse the end */
+          { UV t = cm[i];  cm[i] = cm[m];  cm[m] = t; }
+      }
+    }
+    Safefree(cm);
+    for (i = 0; i < n; i++)
+      SvREFCNT_dec(svals[i]);
+    Safefree(svals);
+#line 3037 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_vecreduce); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_vecreduce)
+{
+    dVAR; dXSARGS;
+    if (items < 1)
+       croak_xs_usage(cv,  "block, ...");
+    {
+	SV*	block = ST(0)
+;
+#line 2186 "XS.xs"
+{   /* This is basically reduce from List::Util.  Try to maintain compat. */
+    SV *ret = sv_newmortal();
+    int i;
+    GV *agv,*bgv,*gv;
+    HV *stash;
+    SV **args = &PL_stack_base[ax];
+    CV *cv = sv_2cv(block, &stash, &gv, 0);
+
+    if (cv == Nullcv) croak("Not a subroutine reference");
+    if (items <= 1) XSRETURN_UNDEF;
+
+    agv = gv_fetchpv("a", GV_ADD, SVt_PV);
+    bgv = gv_fetchpv("b", GV_ADD, SVt_PV);
+    SAVESPTR(GvSV(agv));
+    SAVESPTR(GvSV(bgv));
+    GvSV(agv) = ret;
+    SvSetMagicSV(ret, args[1]);
+#ifdef dMULTICALL
+    if (!CvISXSUB(cv)) {
+      dMULTICALL;
+      I32 gimme = G_SCALAR;
+      PUSH_MULTICALL(cv);
+      for (i = 2; i < items; i++) {
+        GvSV(bgv) = args[i];
+        MULTICALL;
+        SvSetMagicSV(ret, *PL_stack_sp);
+      }
+      FIX_MULTICALL_REFCOUNT;
+      POP_MULTICALL;
+    }
+    else
+#endif
+    {
+      for (i = 2; i < items; i++) {
+        dSP;
+        GvSV(bgv) = args[i];
+        PUSHMARK(SP);
+        call_sv((SV*)cv, G_SCALAR);
+        SvSetMagicSV(ret, *PL_stack_sp);
+      }
+    }
+    ST(0) = ret;
+    XSRETURN(1);
+}
+#line 3098 "XS.c"
+    }
+    XSRETURN(1);
+}
+
+#ifdef __cplusplus
+extern "C"
+#endif
+XS_EXTERNAL(boot_Math__Prime__Util); /* prototype to pass -Wmissing-prototypes */
+XS_EXTERNAL(boot_Math__Prime__Util)
+{
+#if PERL_VERSION_LE(5, 21, 5)
+    dVAR; dXSARGS;
+#else
+    dVAR; dXSBOOTARGSXSAPIVERCHK;
+#endif
+#if PERL_VERSION_LE(5, 8, 999) /* PERL_VERSION_LT is 5.33+ */
+    char* file = __FILE__;
+#else
+    const char* file = __FILE__;
+#endif
+
+    PERL_UNUSED_VAR(file);
+
+    PERL_UNUSED_VAR(cv); /* -W */
+    PERL_UNUSED_VAR(items); /* -W */
+#if PERL_VERSION_LE(5, 21, 5)
+    XS_VERSION_BOOTCHECK;
+#  ifdef XS_APIVERSION_BOOTCHECK
+    XS_APIVERSION_BOOTCHECK;
+#  endif
+#endif
+
+#if XSubPPtmpAAAA
+        (void)newXSproto_portable("Math::Prime::Util::CLONE", XS_Math__Prime__Util_CLONE, file, ";@");
+#endif
+        (void)newXSproto_portable("Math::Prime::Util::END", XS_Math__Prime__Util_END, file, ";@");
+        cv = newXSproto_portable("Math::Prime::Util::_XS_get_callgmp", XS_Math__Prime__Util_prime_memfree, file, "");
+        XSANY.any_i32 = 2;
+        cv = newXSproto_portable("Math::Prime::Util::_XS_get_verbose", XS_Math__Prime__Util_prime_memfree, file, "");
+        XSANY.any_i32 = 1;
+        cv = newXSproto_portable("Math::Prime::Util::_get_prime_cache_size", XS_Math__Prime__Util_prime_memfree, file, "");
+        XSANY.any_i32 = 3;
+        cv = newXSproto_portable("Math::Prime::Util::prime_memfree", XS_Math__Prime__Util_prime_memfree, file, "");
+        XSANY.any_i32 = 0;
+        cv = newXSproto_portable("Math::Prime::Util::_XS_set_callgmp", XS_Math__Prime__Util_prime_precalc, file, "$");
+        XSANY.any_i32 = 2;
+        cv = newXSproto_portable("Math::Prime::Util::_XS_set_verbose", XS_Math__Prime__Util_prime_precalc, file, "$");
+        XSANY.any_i32 = 1;
+        cv = newXSproto_portable("Math::Prime::Util::prime_precalc", XS_Math__Prime__Util_prime_precalc, file, "$");
+        XSANY.any_i32 = 0;
+        cv = newXSproto_portable("Math::Prime::Util::_XS_segment_pi", XS_Math__Prime__Util_prime_count, file, "$;@");
+        XSANY.any_i32 = 1;
+        cv = newXSproto_portable("Math::Prime::Util::prime_count", XS_Math__Prime__Util_prime_count, file, "$;@");
+        XSANY.any_i32 = 0;
+        cv = newXSproto_portable("Math::Prime::Util::twin_prime_count", XS_Math__Prime__Util_prime_count, file, "$;@");
+        XSANY.any_i32 = 2;
+        cv = newXSproto_portable("Math::Prime::Util::_XS_LMOS_pi", XS_Math__Prime__Util__XS_LMO_pi, file, "$");
+        XSANY.any_i32 = 4;
+        cv = newXSproto_portable("Math::Prime::Util::_XS_LMO_pi", XS_Math__Prime__Util__XS_LMO_pi, file, "$");
+        XSANY.any_i32 = 0;
+        cv = newXSproto_portable("Math::Prime::Util::_XS_legendre_pi", XS_Math__Prime__Util__XS_LMO_pi, file, "$");
+        XSANY.any_i32 = 1;
+        cv = newXSproto_portable("Math::Prime::Util::_XS_lehmer_pi", XS_Math__Prime__Util__XS_LMO_pi, file, "$");
+        XSANY.any_i32 = 3;
+        cv = newXSproto_portable("Math::Prime::Util::_XS_meissel_pi", XS_Math__Prime__Util__XS_LMO_pi, file, "$");
+        XSANY.any_i32 = 2;
+        cv = newXSproto_portable("Math::Prime::Util::erat_primes", XS_Math__Prime__Util_sieve_primes, file, "$$");
+        XSANY.any_i32 = 2;
+        cv = newXSproto_portable("Math::Prime::Util::segment_primes", XS_Math__Prime__Util_sieve_primes, file, "$$");
+        XSANY.any_i32 = 3;
+        cv = newXSproto_portable("Math::Prime::Util::segment_twin_primes", XS_Math__Prime__Util_sieve_primes, file, "$$");
+        XSANY.any_i32 = 4;
+        cv = newXSproto_portable("Math::Prime::Util::sieve_primes", XS_Math__Prime__Util_sieve_primes, file, "$$");
+        XSANY.any_i32 = 0;
+        cv = newXSproto_portable("Math::Prime::Util::trial_primes", XS_Math__Prime__Util_sieve_primes, file, "$$");
+        XSANY.any_i32 = 1;
+        cv = newXSproto_portable("Math::Prime::Util::ecm_factor", XS_Math__Prime__Util_trial_factor, file, "$;@");
+        XSANY.any_i32 = 8;
+        cv = newXSproto_portable("Math::Prime::Util::fermat_factor", XS_Math__Prime__Util_trial_factor, file, "$;@");
+        XSANY.any_i32 = 1;
+        cv = newXSproto_portable("Math::Prime::Util::holf_factor", XS_Math__Prime__Util_trial_factor, file, "$;@");
+        XSANY.any_i32 = 2;
+        cv = newXSproto_portable("Math::Prime::Util::lehman_factor", XS_Math__Prime__Util_trial_factor, file, "$;@");
+        XSANY.any_i32 = 9;
+        cv = newXSproto_portable("Math::Prime::Util::pbrent_factor", XS_Math__Prime__Util_trial_factor, file, "$;@");
+        XSANY.any_i32 = 6;
+        cv = newXSproto_portable("Math::Prime::Util::pminus1_factor", XS_Math__Prime__Util_trial_factor, file, "$;@");
+        XSANY.any_i32 = 7;
+        cv = newXSproto_portable("Math::Prime::Util::pplus1_factor", XS_Math__Prime__Util_trial_factor, file, "$;@");
+        XSANY.any_i32 = 5;
+        cv = newXSproto_portable("Math::Prime::Util::prho_factor", XS_Math__Prime__Util_trial_factor, file, "$;@");
+        XSANY.any_i32 = 4;
+        cv = newXSproto_portable("Math::Prime::Util::squfof_factor", XS_Math__Prime__Util_trial_factor, file, "$;@");
+        XSANY.any_i32 = 3;
+        cv = newXSproto_portable("Math::Prime::Util::trial_factor", XS_Math__Prime__Util_trial_factor, file, "$;@");
+        XSANY.any_i32 = 0;
+        cv = newXSproto_portable("Math::Prime::Util::is_pseudoprime", XS_Math__Prime__Util_is_strong_pseudoprime, file, "$;@");
+        XSANY.any_i32 = 1;
+        cv = newXSproto_portable("Math::Prime::Util::is_strong_pseudoprime", XS_Math__Prime__Util_is_strong_pseudoprime, file, "$;@");
+        XSANY.any_i32 = 0;
+        cv = newXSproto_portable("Math::Prime::Util::gcd", XS_Math__Prime__Util_gcd, file, "@");
+        XSANY.any_i32 = 0;
+        cv = newXSproto_portable("Math::Prime::Util::lcm", XS_Math__Prime__Util_gcd, file, "@");
+        XSANY.any_i32 = 1;
+        cv = newXSproto_portable("Math::Prime::Util::vecmax", XS_Math__Prime__Util_gcd, file, "@");
+        XSANY.any_i32 = 3;
+        cv = newXSproto_portable("Math::Prime::Util::vecmin", XS_Math__Prime__Util_gcd, file, "@");
+        XSANY.any_i32 = 2;
+        cv = newXSproto_portable("Math::Prime::Util::vecprod", XS_Math__Prime__Util_gcd, file, "@");
+        XSANY.any_i32 = 5;
+        cv = newXSproto_portable("Math::Prime::Util::vecsum", XS_Math__Prime__Util_gcd, file, "@");
+        XSANY.any_i32 = 4;
+        (void)newXSproto_portable("Math::Prime::Util::chinese", XS_Math__Prime__Util_chinese, file, "@");
+        cv = newXSproto_portable("Math::Prime::Util::lucas_sequence", XS_Math__Prime__Util_lucas_sequence, file, ";@");
+        XSANY.any_i32 = 0;
+        cv = newXSproto_portable("Math::Prime::Util::lucasu", XS_Math__Prime__Util_lucas_sequence, file, ";@");
+        XSANY.any_i32 = 1;
+        cv = newXSproto_portable("Math::Prime::Util::lucasv", XS_Math__Prime__Util_lucas_sequence, file, ";@");
+        XSANY.any_i32 = 2;
+        cv = newXSproto_portable("Math::Prime::Util::is_aks_prime", XS_Math__Prime__Util_is_prime, file, "$;@");
+        XSANY.any_i32 = 4;
+        cv = newXSproto_portable("Math::Prime::Util::is_almost_extra_strong_lucas_pseudoprime", XS_Math__Prime__Util_is_prime, file, "$;@");
+        XSANY.any_i32 = 11;
+        cv = newXSproto_portable("Math::Prime::Util::is_bpsw_prime", XS_Math__Prime__Util_is_prime, file, "$;@");
+        XSANY.any_i32 = 3;
+        cv = newXSproto_portable("Math::Prime::Util::is_extra_strong_lucas_pseudoprime", XS_Math__Prime__Util_is_prime, file, "$;@");
+        XSANY.any_i32 = 7;
+        cv = newXSproto_portable("Math::Prime::Util::is_frobenius_pseudoprime", XS_Math__Prime__Util_is_prime, file, "$;@");
+        XSANY.any_i32 = 8;
+        cv = newXSproto_portable("Math::Prime::Util::is_frobenius_underwood_pseudoprime", XS_Math__Prime__Util_is_prime, file, "$;@");
+        XSANY.any_i32 = 9;
+        cv = newXSproto_portable("Math::Prime::Util::is_lucas_pseudoprime", XS_Math__Prime__Util_is_prime, file, "$;@");
+        XSANY.any_i32 = 5;
+        cv = newXSproto_portable("Math::Prime::Util::is_mersenne_prime", XS_Math__Prime__Util_is_prime, file, "$;@");
+        XSANY.any_i32 = 12;
+        cv = newXSproto_portable("Math::Prime::Util::is_perrin_pseudoprime", XS_Math__Prime__Util_is_prime, file, "$;@");
+        XSANY.any_i32 = 10;
+        cv = newXSproto_portable("Math::Prime::Util::is_power", XS_Math__Prime__Util_is_prime, file, "$;@");
+        XSANY.any_i32 = 13;
+        cv = newXSproto_portable("Math::Prime::Util::is_prime", XS_Math__Prime__Util_is_prime, file, "$;@");
+        XSANY.any_i32 = 0;
+        cv = newXSproto_portable("Math::Prime::Util::is_prob_prime", XS_Math__Prime__Util_is_prime, file, "$;@");
+        XSANY.any_i32 = 1;
+        cv = newXSproto_portable("Math::Prime::Util::is_provable_prime", XS_Math__Prime__Util_is_prime, file, "$;@");
+        XSANY.any_i32 = 2;
+        cv = newXSproto_portable("Math::Prime::Util::is_strong_lucas_pseudoprime", XS_Math__Prime__Util_is_prime, file, "$;@");
+        XSANY.any_i32 = 6;
+        (void)newXSproto_portable("Math::Prime::Util::lucas_lehmer", XS_Math__Prime__Util_lucas_lehmer, file, "$");
+        (void)newXSproto_portable("Math::Prime::Util::is_prime_batch", XS_Math__Prime__Util_is_prime_batch, file, "$");
+        (void)newXSproto_portable("Math::Prime::Util::is_prime_range", XS_Math__Prime__Util_is_prime_range, file, "$$;$");
+        (void)newXSproto_portable("Math::Prime::Util::spsp2_range", XS_Math__Prime__Util_spsp2_range, file, "$;@");
+        (void)newXSproto_portable("Math::Prime::Util::factor_range", XS_Math__Prime__Util_factor_range, file, "$;@");
+        (void)newXSproto_portable("Math::Prime::Util::carmichael_count", XS_Math__Prime__Util_carmichael_count, file, "$;@");
+        (void)newXSproto_portable("Math::Prime::Util::_bls75_certificate", XS_Math__Prime__Util__bls75_certificate, file, "$");
+        (void)newXSproto_portable("Math::Prime::Util::_verify_cert", XS_Math__Prime__Util__verify_cert, file, "$");
+        cv = newXSproto_portable("Math::Prime::Util::next_prime", XS_Math__Prime__Util_next_prime, file, "$");
+        XSANY.any_i32 = 0;
+        cv = newXSproto_portable("Math::Prime::Util::nth_prime", XS_Math__Prime__Util_next_prime, file, "$");
+        XSANY.any_i32 = 2;
+        cv = newXSproto_portable("Math::Prime::Util::nth_prime_approx", XS_Math__Prime__Util_next_prime, file, "$");
+        XSANY.any_i32 = 5;
+        cv = newXSproto_portable("Math::Prime::Util::nth_prime_lower", XS_Math__Prime__Util_next_prime, file, "$");
+        XSANY.any_i32 = 4;
+        cv = newXSproto_portable("Math::Prime::Util::nth_prime_upper", XS_Math__Prime__Util_next_prime, file, "$");
+        XSANY.any_i32 = 3;
+        cv = newXSproto_portable("Math::Prime::Util::nth_twin_prime", XS_Math__Prime__Util_next_prime, file, "$");
+        XSANY.any_i32 = 6;
+        cv = newXSproto_portable("Math::Prime::Util::nth_twin_prime_approx", XS_Math__Prime__Util_next_prime, file, "$");
+        XSANY.any_i32 = 7;
+        cv = newXSproto_portable("Math::Prime::Util::prev_prime", XS_Math__Prime__Util_next_prime, file, "$");
+        XSANY.any_i32 = 1;
+        cv = newXSproto_portable("Math::Prime::Util::prime_count_approx", XS_Math__Prime__Util_next_prime, file, "$");
+        XSANY.any_i32 = 10;
+        cv = newXSproto_portable("Math::Prime::Util::prime_count_lower", XS_Math__Prime__Util_next_prime, file, "$");
+        XSANY.any_i32 = 9;
+        cv = newXSproto_portable("Math::Prime::Util::prime_count_upper", XS_Math__Prime__Util_next_prime, file, "$");
+        XSANY.any_i32 = 8;
+        cv = newXSproto_portable("Math::Prime::Util::twin_prime_count_approx", XS_Math__Prime__Util_next_prime, file, "$");
+        XSANY.any_i32 = 11;
+        (void)newXSproto_portable("Math::Prime::Util::Pi", XS_Math__Prime__Util_Pi, file, ";$");
+        (void)newXSproto_portable("Math::Prime::Util::_pidigits", XS_Math__Prime__Util__pidigits, file, "$");
+        cv = newXSproto_portable("Math::Prime::Util::divisors", XS_Math__Prime__Util_factor, file, "$");
+        XSANY.any_i32 = 2;
+        cv = newXSproto_portable("Math::Prime::Util::factor", XS_Math__Prime__Util_factor, file, "$");
+        XSANY.any_i32 = 0;
+        cv = newXSproto_portable("Math::Prime::Util::factor_exp", XS_Math__Prime__Util_factor, file, "$");
+        XSANY.any_i32 = 1;
+        (void)newXSproto_portable("Math::Prime::Util::divisor_sum", XS_Math__Prime__Util_divisor_sum, file, "$;@");
+        cv = newXSproto_portable("Math::Prime::Util::binomial", XS_Math__Prime__Util_znorder, file, "$$");
+        XSANY.any_i32 = 1;
+        cv = newXSproto_portable("Math::Prime::Util::jordan_totient", XS_Math__Prime__Util_znorder, file, "$$");
+        XSANY.any_i32 = 2;
+        cv = newXSproto_portable("Math::Prime::Util::legendre_phi", XS_Math__Prime__Util_znorder, file, "$$");
+        XSANY.any_i32 = 3;
+        cv = newXSproto_portable("Math::Prime::Util::znorder", XS_Math__Prime__Util_znorder, file, "$$");
+        XSANY.any_i32 = 0;
+        (void)newXSproto_portable("Math::Prime::Util::znlog", XS_Math__Prime__Util_znlog, file, "$$$");
+        cv = newXSproto_portable("Math::Prime::Util::invmod", XS_Math__Prime__Util_kronecker, file, "$$");
+        XSANY.any_i32 = 2;
+        cv = newXSproto_portable("Math::Prime::Util::kronecker", XS_Math__Prime__Util_kronecker, file, "$$");
+        XSANY.any_i32 = 0;
+        cv = newXSproto_portable("Math::Prime::Util::valuation", XS_Math__Prime__Util_kronecker, file, "$$");
+        XSANY.any_i32 = 1;
+        (void)newXSproto_portable("Math::Prime::Util::gcdext", XS_Math__Prime__Util_gcdext, file, "$$");
+        (void)newXSproto_portable("Math::Prime::Util::stirling", XS_Math__Prime__Util_stirling, file, "$$;$");
+        cv = newXSproto_portable("Math::Prime::Util::_XS_ExponentialIntegral", XS_Math__Prime__Util__XS_ExponentialIntegral, file, "$");
+        XSANY.any_i32 = 0;
+        cv = newXSproto_portable("Math::Prime::Util::_XS_LambertW", XS_Math__Prime__Util__XS_ExponentialIntegral, file, "$");
+        XSANY.any_i32 = 4;
+        cv = newXSproto_portable("Math::Prime::Util::_XS_LogarithmicIntegral", XS_Math__Prime__Util__XS_ExponentialIntegral, file, "$");
+        XSANY.any_i32 = 1;
+        cv = newXSproto_portable("Math::Prime::Util::_XS_RiemannR", XS_Math__Prime__Util__XS_ExponentialIntegral, file, "$");
+        XSANY.any_i32 = 3;
+        cv = newXSproto_portable("Math::Prime::Util::_XS_RiemannZeta", XS_Math__Prime__Util__XS_ExponentialIntegral, file, "$");
+        XSANY.any_i32 = 2;
+        cv = newXSproto_portable("Math::Prime::Util::euler_phi", XS_Math__Prime__Util_euler_phi, file, "$;@");
+        XSANY.any_i32 = 0;
+        cv = newXSproto_portable("Math::Prime::Util::moebius", XS_Math__Prime__Util_euler_phi, file, "$;@");
+        XSANY.any_i32 = 1;
+        cv = newXSproto_portable("Math::Prime::Util::carmichael_lambda", XS_Math__Prime__Util_carmichael_lambda, file, "$");
+        XSANY.any_i32 = 0;
+        cv = newXSproto_portable("Math::Prime::Util::chebyshev_psi", XS_Math__Prime__Util_carmichael_lambda, file, "$");
+        XSANY.any_i32 = 4;
+        cv = newXSproto_portable("Math::Prime::Util::chebyshev_theta", XS_Math__Prime__Util_carmichael_lambda, file, "$");
+        XSANY.any_i32 = 3;
+        cv = newXSproto_portable("Math::Prime::Util::exp_mangoldt", XS_Math__Prime__Util_carmichael_lambda, file, "$");
+        XSANY.any_i32 = 6;
+        cv = newXSproto_portable("Math::Prime::Util::factorial", XS_Math__Prime__Util_carmichael_lambda, file, "$");
+        XSANY.any_i32 = 5;
+        cv = newXSproto_portable("Math::Prime::Util::hammingweight", XS_Math__Prime__Util_carmichael_lambda, file, "$");
+        XSANY.any_i32 = 8;
+        cv = newXSproto_portable("Math::Prime::Util::liouville", XS_Math__Prime__Util_carmichael_lambda, file, "$");
+        XSANY.any_i32 = 2;
+        cv = newXSproto_portable("Math::Prime::Util::mertens", XS_Math__Prime__Util_carmichael_lambda, file, "$");
+        XSANY.any_i32 = 1;
+        cv = newXSproto_portable("Math::Prime::Util::znprimroot", XS_Math__Prime__Util_carmichael_lambda, file, "$");
+        XSANY.any_i32 = 7;
+        cv = newXSproto_portable("Math::Prime::Util::squarefree_count", XS_Math__Prime__Util_totient_sum, file, "$");
+        XSANY.any_i32 = 1;
+        cv = newXSproto_portable("Math::Prime::Util::totient_sum", XS_Math__Prime__Util_totient_sum, file, "$");
+        XSANY.any_i32 = 0;
+        (void)newXSproto_portable("Math::Prime::Util::divisor_summatory", XS_Math__Prime__Util_divisor_summatory, file, "$;$");
+        (void)newXSproto_portable("Math::Prime::Util::_validate_num", XS_Math__Prime__Util__validate_num, file, "$;@");
+        (void)newXSproto_portable("Math::Prime::Util::forprimes", XS_Math__Prime__Util_forprimes, file, "&$;$");
+        cv = newXSproto_portable("Math::Prime::Util::forcomposites", XS_Math__Prime__Util_forcomposites, file, "&$;$");
+        XSANY.any_i32 = 0;
+        cv = newXSproto_portable("Math::Prime::Util::foroddcomposites", XS_Math__Prime__Util_forcomposites, file, "&$;$");
+        XSANY.any_i32 = 1;
+        (void)newXSproto_portable("Math::Prime::Util::fordivisors", XS_Math__Prime__Util_fordivisors, file, "&$");
+        (void)newXSproto_portable("Math::Prime::Util::forfactored", XS_Math__Prime__Util_forfactored, file, "&$;$");
+        cv = newXSproto_portable("Math::Prime::Util::formoebius", XS_Math__Prime__Util_fortotients, file, "&$;$");
+        XSANY.any_i32 = 1;
+        cv = newXSproto_portable("Math::Prime::Util::fortotients", XS_Math__Prime__Util_fortotients, file, "&$;$");
+        XSANY.any_i32 = 0;
+        (void)newXSproto_portable("Math::Prime::Util::forsigma", XS_Math__Prime__Util_forsigma, file, "&$$;$");
+        (void)newXSproto_portable("Math::Prime::Util::forpart", XS_Math__Prime__Util_forpart, file, "&$;$");
+        cv = newXSproto_portable("Math::Prime::Util::forcomb", XS_Math__Prime__Util_forcomb, file, "&$;$");
+        XSANY.any_i32 = 0;
+        cv = newXSproto_portable("Math::Prime::Util::forperm", XS_Math__Prime__Util_forcomb, file, "&$;$");
+        XSANY.any_i32 = 1;
+        (void)newXSproto_portable("Math::Prime::Util::vecreduce", XS_Math__Prime__Util_vecreduce, file, "&@");
+
+    /* Initialisation Section */
+
+#line 245 "XS.xs"
+{
+    SV * sv = newSViv(BITS_PER_WORD);
+    HV * stash = gv_stashpv("Math::Prime::Util", TRUE);
+    newCONSTSUB(stash, "_XS_prime_maxbits", sv);
+    { int i;
+      MY_CXT_INIT;
+      MY_CXT.MPUroot = stash;
+      for (i = 0; i <= 3; i++) {
+        MY_CXT.const_int[i] = newSViv(i-1);
+        SvREADONLY_on(MY_CXT.const_int[i]);
+      }
+      MY_CXT.MPUGMP = gv_stashpv("Math::Prime::Util::GMP", TRUE);
+      MY_CXT.MPUPP = gv_stashpv("Math::Prime::Util::PP", TRUE);
+      MY_CXT.znlog_g = MY_CXT.znlog_p = 0;
+      MY_CXT.znlog_ctx = 0;
+    }
+}
+
+#if XSubPPtmpAAAA
+#endif
+#line 3384 "XS.c"
+
+    /* End of Initialisation Section */
+
+#if PERL_VERSION_LE(5, 21, 5)
+#  if PERL_VERSION_GE(5, 9, 0)
+    if (PL_unitcheckav)
+        call_list(PL_scopestack_ix, PL_unitcheckav);
+#  endif
+    XSRETURN_YES;
+#else
+    Perl_xs_boot_epilog(aTHX_ ax);
+#endif
+}
+
@@ -22,6 +22,8 @@
 #include "lehmer.h"
 #include "lmo.h"
 #include "aks.h"
+#include "cert.h"
+#include "pseudoprimes.h"
 #include "constants.h"
 
 #if BITS_PER_WORD == 64
@@ -98,6 +100,9 @@ typedef struct {
   HV* MPUroot;
   HV* MPUGMP;
   HV* MPUPP;
+  UV  znlog_g;        /* Last znlog generator and modulus */
+  UV  znlog_p;
+  znlog_ctx_t* znlog_ctx;
 } my_cxt_t;
 
 START_MY_CXT
@@ -250,6 +255,8 @@ BOOT:
       }
       MY_CXT.MPUGMP = gv_stashpv("Math::Prime::Util::GMP", TRUE);
       MY_CXT.MPUPP = gv_stashpv("Math::Prime::Util::PP", TRUE);
+      MY_CXT.znlog_g = MY_CXT.znlog_p = 0;
+      MY_CXT.znlog_ctx = 0;
     }
 }
 
@@ -269,6 +276,8 @@ PPCODE:
     MY_CXT.MPUroot = gv_stashpv("Math::Prime::Util", TRUE);
     MY_CXT.MPUGMP = gv_stashpv("Math::Prime::Util::GMP", TRUE);
     MY_CXT.MPUPP = gv_stashpv("Math::Prime::Util::PP", TRUE);
+    MY_CXT.znlog_g = MY_CXT.znlog_p = 0;
+    MY_CXT.znlog_ctx = 0;   /* The parent's table is not ours to share */
   }
   return; /* skip implicit PUTBACK, returning @_ to caller, more efficient*/
 
@@ -288,6 +297,8 @@ PPCODE:
   MY_CXT.MPUroot = NULL;
   MY_CXT.MPUGMP = NULL;
   MY_CXT.MPUPP = NULL;
+  znlog_ctx_free(MY_CXT.znlog_ctx);
+  MY_CXT.znlog_ctx = 0;
   _prime_memfreeall();
   return; /* skip implicit PUTBACK, returning @_ to caller, more efficient*/
 
@@ -301,7 +312,12 @@ prime_memfree()
     UV ret;
   PPCODE:
     switch (ix) {
-      case 0:  prime_memfree(); goto return_nothing;
+      case 0:  { dMY_CXT;
+                 znlog_ctx_free(MY_CXT.znlog_ctx);
+                 MY_CXT.znlog_ctx = 0;
+                 MY_CXT.znlog_g = MY_CXT.znlog_p = 0;
+               }
+               prime_memfree(); goto return_nothing;
       case 1:  ret = _XS_get_verbose(); break;
       case 2:  ret = _XS_get_callgmp(); break;
       case 3:
@@ -454,11 +470,12 @@ trial_factor(IN UV n, ...)
     pbrent_factor = 6
     pminus1_factor = 7
     ecm_factor = 8
+    lehman_factor = 9
   PREINIT:
     UV arg1, arg2;
     static const UV default_arg1[] =
-       {0,     64000000, 8000000, 4000000, 4000000, 200, 4000000, 1000000};
-     /* Trial, Fermat,   Holf,    SQUFOF,  PRHO,    P+1, Brent,    P-1 */
+       {0,     64000000, 8000000, 4000000, 4000000, 200, 4000000, 1000000, 0, 1};
+     /* Trial, Fermat,   Holf,    SQUFOF,  PRHO,    P+1, Brent,    P-1, ECM, Lehman */
   PPCODE:
     if (n == 0)  XSRETURN_UV(0);
     if (ix == 8) {  /* We don't have an ecm_factor, call PP. */
@@ -486,6 +503,7 @@ trial_factor(IN UV n, ...)
         case 5:  nfactors = pplus1_factor (n, factors, arg1);  break;
         case 6:  if (items < 3) arg2 = 1;
                  nfactors = pbrent_factor (n, factors, arg1, arg2);  break;
+        case 9:  nfactors = lehman_factor (n, factors, arg1);  break;
         case 7:
         default: if (items < 3) arg2 = 10*arg1;
                  nfactors = pminus1_factor(n, factors, arg1, arg2);  break;
@@ -836,6 +854,160 @@ is_prime(IN SV* svn, ...)
     }
     return; /* skip implicit PUTBACK */
 
+void
+lucas_lehmer(IN SV* svp)
+  PREINIT:
+    int status;
+  PPCODE:
+    status = _validate_int(aTHX_ svp, 0);
+    if (status == 1)
+      RETURN_NPARITY(lucas_lehmer(my_svuv(svp)));
+    _vcallsub_with_pp("lucas_lehmer");
+    return; /* skip implicit PUTBACK */
+
+void
+is_prime_batch(IN SV* svarr)
+  PREINIT:
+    AV* av;
+    UV* n;
+    unsigned char* res;
+    int i, len, status = 1;
+  PPCODE:
+    if (!SvROK(svarr) || SvTYPE(SvRV(svarr)) != SVt_PVAV)
+      croak("is_prime_batch argument must be an array reference");
+    av = (AV*) SvRV(svarr);
+    len = av_len(av) + 1;
+    New(0, n, len, UV);
+    for (i = 0; i < len; i++) {
+      SV** psv = av_fetch(av, i, 0);
+      status = (psv == 0) ? 0 : _validate_int(aTHX_ *psv, 1);
+      if (status == 0) break;
+      n[i] = (status == 1) ? my_svuv(*psv) : 0;
+    }
+    if (status != 0) {
+      dMY_CXT;
+      New(0, res, len, unsigned char);
+      is_prob_prime_batch(n, len, res);
+      EXTEND(SP, len);
+      for (i = 0; i < len; i++)
+        PUSH_NPARITY(res[i]);
+      Safefree(res);
+    }
+    Safefree(n);
+    if (status == 0) {
+      _vcallsubn(aTHX_ GIMME_V, VCALL_ROOT, "_generic_is_prime_batch", 1);
+      return; /* skip implicit PUTBACK */
+    }
+
+void
+is_prime_range(IN SV* svlo, IN SV* svhi, IN SV* svstep = 0)
+  PREINIT:
+    int lostatus, histatus, ststatus;
+  PPCODE:
+    lostatus = _validate_int(aTHX_ svlo, 0);
+    histatus = _validate_int(aTHX_ svhi, 0);
+    ststatus = (svstep == 0) ? 1 : _validate_int(aTHX_ svstep, 0);
+    if (lostatus == 1 && histatus == 1 && ststatus == 1) {
+      UV lo = my_svuv(svlo);
+      UV hi = my_svuv(svhi);
+      UV step = (svstep == 0) ? 1 : my_svuv(svstep);
+      UV count;
+      unsigned char* bits;
+      if (step == 0) croak("is_prime_range step must be positive");
+      count = (hi < lo) ? 0 : (hi-lo)/step + 1;
+      bits = prime_range_bitmap(lo, step, count);
+      XPUSHs(sv_2mortal(newSVpvn((char*)bits, (count+7)/8)));
+      Safefree(bits);
+    } else {
+      _vcallsubn(aTHX_ G_SCALAR, VCALL_ROOT, "_generic_is_prime_range", items);
+      return; /* skip implicit PUTBACK */
+    }
+
+void
+spsp2_range(IN SV* svlo, ...)
+  PREINIT:
+    AV* av;
+    int lostatus, histatus;
+  PPCODE:
+    lostatus = _validate_int(aTHX_ svlo, 0);
+    histatus = (items == 1 || _validate_int(aTHX_ ST(1), 0));
+    if (lostatus == 1 && histatus == 1) {
+      UV i, count, *list, lo = 0, hi = my_svuv(svlo);
+      if (items > 1) { lo = hi;  hi = my_svuv(ST(1)); }
+      list = spsp2_range(lo, hi, &count);
+      av = newAV();
+      if (count > 0) av_extend(av, count-1);
+      for (i = 0; i < count; i++)
+        av_push(av, newSVuv(list[i]));
+      Safefree(list);
+      XPUSHs(sv_2mortal(newRV_noinc( (SV*) av )));
+    } else {
+      _vcallsubn(aTHX_ G_SCALAR, VCALL_ROOT, "_generic_spsp2_range", items);
+      return; /* skip implicit PUTBACK */
+    }
+
+void
+factor_range(IN SV* svlo, ...)
+  PREINIT:
+    AV* av;
+    int lostatus, histatus;
+  PPCODE:
+    lostatus = _validate_int(aTHX_ svlo, 0);
+    histatus = (items == 1 || _validate_int(aTHX_ ST(1), 0));
+    if (lostatus == 1 && histatus == 1) {
+      UV n, lo = 1, hi = my_svuv(svlo), factors[MPU_MAX_FACTORS+1];
+      int i, nfactors;
+      void* ctx;
+      if (items > 1) { lo = hi;  hi = my_svuv(ST(1)); }
+      av = newAV();
+      ctx = start_factor_range(lo, hi);
+      while ( (nfactors = next_factor_range(ctx, &n, factors)) >= 0 ) {
+        AV* fav = newAV();
+        for (i = 0; i < nfactors; i++)
+          av_push(fav, newSVuv(factors[i]));
+        av_push(av, newRV_noinc( (SV*) fav ));
+      }
+      end_factor_range(ctx);
+      XPUSHs(sv_2mortal(newRV_noinc( (SV*) av )));
+    } else {
+      _vcallsubn(aTHX_ G_SCALAR, VCALL_ROOT, "_generic_factor_range", items);
+      return; /* skip implicit PUTBACK */
+    }
+
+void
+carmichael_count(IN SV* svlo, ...)
+  PREINIT:
+    int lostatus, histatus;
+  PPCODE:
+    lostatus = _validate_int(aTHX_ svlo, 0);
+    histatus = (items == 1 || _validate_int(aTHX_ ST(1), 0));
+    if (lostatus == 1 && histatus == 1) {
+      UV lo = 0, hi = my_svuv(svlo);
+      if (items > 1) { lo = hi;  hi = my_svuv(ST(1)); }
+      XSRETURN_UV( carmichael_count(lo, hi) );
+    }
+    _vcallsubn(aTHX_ G_SCALAR, VCALL_ROOT, "_generic_carmichael_count", items);
+    return; /* skip implicit PUTBACK */
+
+void
+_bls75_certificate(IN char* strn)
+  PREINIT:
+    char* cert;
+  PPCODE:
+    cert = bls75_certificate(strn);
+    if (cert == 0) XSRETURN_UNDEF;
+    XPUSHs(sv_2mortal(newSVpv(cert, 0)));
+    Safefree(cert);
+
+void
+_verify_cert(IN char* cert)
+  PREINIT:
+    int res;
+  PPCODE:
+    res = verify_cert_text(cert);
+    if (res < 0) XSRETURN_UNDEF;
+    XSRETURN_IV(res);
+
 void
 next_prime(IN SV* svn)
   ALIAS:
@@ -1116,8 +1288,20 @@ znlog(IN SV* sva, IN SV* svg, IN SV* svp)
     gstatus = _validate_int(aTHX_ svg, 0);
     pstatus = _validate_int(aTHX_ svp, 0);
     if (astatus == 1 && gstatus == 1 && pstatus == 1) {
-      UV a = my_svuv(sva), g = my_svuv(svg), p = my_svuv(svp);
-      UV ret = znlog(a, g, p);
+      UV ret, a = my_svuv(sva), g = my_svuv(svg), p = my_svuv(svp);
+      dMY_CXT;
+      /* A second call with the same g and p builds a table kept for reuse */
+      if (g == MY_CXT.znlog_g && p == MY_CXT.znlog_p) {
+        if (MY_CXT.znlog_ctx == 0)
+          MY_CXT.znlog_ctx = znlog_ctx_new(g, p, ZNLOG_CTX_MAXENT);
+        ret = znlog_ctx_solve(MY_CXT.znlog_ctx, a);
+      } else {
+        znlog_ctx_free(MY_CXT.znlog_ctx);
+        MY_CXT.znlog_ctx = 0;
+        MY_CXT.znlog_g = g;
+        MY_CXT.znlog_p = p;
+        ret = znlog(a, g, p);
+      }
       /* TODO: perhaps return p to mean no solution? */
       if (ret == 0 && a > 1) XSRETURN_UNDEF;
       XSRETURN_UV(ret);
@@ -1272,20 +1456,24 @@ euler_phi(IN SV* svlo, ...)
       UV lo = my_svuv(svlo);
       UV hi = my_svuv(ST(1));
       if (lo <= hi) {
-        UV i;
+        UV i, wlo, whi;
+        void* ctx;
         EXTEND(SP, hi-lo+1);
         if (ix == 0) {
-          UV  arraylo = (lo < 100)  ?  0  :  lo;
-          UV* totients = _totient_range(arraylo, hi);
-          for (i = lo; i <= hi; i++)
-            PUSHs(sv_2mortal(newSVuv(totients[i-arraylo])));
-          Safefree(totients);
+          const UV* totients;
+          ctx = start_totient_range(lo, hi);
+          while (next_totient_range(ctx, &wlo, &whi, &totients))
+            for (i = 0; i <= whi-wlo; i++)
+              PUSHs(sv_2mortal(newSVuv(totients[i])));
+          end_totient_range(ctx);
         } else {
-          signed char* mu = _moebius_range(lo, hi);
+          const signed char* mu;
           dMY_CXT;
-          for (i = lo; i <= hi; i++)
-            PUSH_NPARITY(mu[i-lo]);
-          Safefree(mu);
+          ctx = start_moebius_range(lo, hi);
+          while (next_moebius_range(ctx, &wlo, &whi, &mu))
+            for (i = 0; i <= whi-wlo; i++)
+              PUSH_NPARITY(mu[i]);
+          end_moebius_range(ctx);
         }
       }
     } else {
@@ -1354,6 +1542,49 @@ carmichael_lambda(IN SV* svn)
     }
     return; /* skip implicit PUTBACK */
 
+void
+totient_sum(IN SV* svn)
+  ALIAS:
+    squarefree_count = 1
+  PREINIT:
+    UV n, hi, lo;
+  PPCODE:
+    if (_validate_int(aTHX_ svn, 0) != 0) {
+      n = my_svuv(svn);
+      if (ix == 1)  XSRETURN_UV(squarefree_count(n));
+      if (totient_sum(n, &hi, &lo)) {
+        char str[48];
+        if (hi == 0)  XSRETURN_UV(lo);
+        (void) to_string_128(str, hi, lo);
+        ST(0) = sv_2mortal(newSVpv(str, 0));
+        OBJECTIFY_RESULT(svn, ST(0));
+        XSRETURN(1);
+      }
+    }
+    if (ix == 0) _vcallsub_with_pp("totient_sum");
+    else         _vcallsub_with_pp("squarefree_count");
+    return; /* skip implicit PUTBACK */
+
+void
+divisor_summatory(IN SV* svn, IN SV* svk = 0)
+  PREINIT:
+    UV n, k, hi, lo;
+  PPCODE:
+    if (_validate_int(aTHX_ svn, 0) != 0 && (svk == 0 || _validate_int(aTHX_ svk, 0) != 0)) {
+      n = my_svuv(svn);
+      k = (svk == 0) ? 1 : my_svuv(svk);
+      if (divisor_summatory(n, k, &hi, &lo)) {
+        char str[48];
+        if (hi == 0)  XSRETURN_UV(lo);
+        (void) to_string_128(str, hi, lo);
+        ST(0) = sv_2mortal(newSVpv(str, 0));
+        OBJECTIFY_RESULT(svn, ST(0));
+        XSRETURN(1);
+      }
+    }
+    _vcallsub_with_pp("divisor_summatory");
+    return; /* skip implicit PUTBACK */
+
 bool
 _validate_num(SV* svn, ...)
   PREINIT:
@@ -1585,8 +1816,8 @@ void
 fordivisors (SV* block, IN SV* svn)
   PROTOTYPE: &$
   PREINIT:
-    UV i, n, ndivisors;
-    UV *divs;
+    UV n, d;
+    void *ctx;
     GV *gv;
     HV *stash;
     SV* svarg;  /* We use svarg to prevent clobbering $_ outside the block */
@@ -1602,7 +1833,7 @@ fordivisors (SV* block, IN SV* svn)
     }
 
     n = my_svuv(svn);
-    divs = _divisor_list(n, &ndivisors);
+    ctx = start_divisors(n);
 
     SAVESPTR(GvSV(PL_defgv));
     svarg = newSVuv(0);
@@ -1612,8 +1843,8 @@ fordivisors (SV* block, IN SV* svn)
       dMULTICALL;
       I32 gimme = G_VOID;
       PUSH_MULTICALL(cv);
-      for (i = 0; i < ndivisors; i++) {
-        sv_setuv(svarg, divs[i]);
+      while (next_divisor(ctx, &d)) {
+        sv_setuv(svarg, d);
         MULTICALL;
       }
       FIX_MULTICALL_REFCOUNT;
@@ -1622,14 +1853,163 @@ fordivisors (SV* block, IN SV* svn)
     else
 #endif
     {
-      for (i = 0; i < ndivisors; i++) {
-        sv_setuv(svarg, divs[i]);
+      while (next_divisor(ctx, &d)) {
+        sv_setuv(svarg, d);
         PUSHMARK(SP);
         call_sv((SV*)cv, G_VOID|G_DISCARD);
       }
     }
     SvREFCNT_dec(svarg);
-    Safefree(divs);
+    end_divisors(ctx);
+
+void
+forfactored (SV* block, IN SV* svbeg, IN SV* svend = 0)
+  PROTOTYPE: &$;$
+  PREINIT:
+    UV beg, end, n, factors[MPU_MAX_FACTORS+1];
+    int i, nfactors;
+    void* ctx;
+    GV *gv;
+    HV *stash;
+    SV* svarg;  /* We use svarg to prevent clobbering $_ outside the block */
+    CV *cv;
+  PPCODE:
+    cv = sv_2cv(block, &stash, &gv, 0);
+    if (cv == Nullcv)
+      croak("Not a subroutine reference");
+
+    if (!_validate_int(aTHX_ svbeg, 0) || (items >= 3 && !_validate_int(aTHX_ svend,0))) {
+      _vcallsubn(aTHX_ G_VOID|G_DISCARD, VCALL_ROOT, "_generic_forfactored", items);
+      return;
+    }
+
+    if (items < 3) {
+      beg = 1;
+      end = my_svuv(svbeg);
+    } else {
+      beg = my_svuv(svbeg);
+      end = my_svuv(svend);
+    }
+
+    SAVESPTR(GvSV(PL_defgv));
+    svarg = newSVuv(0);
+    GvSV(PL_defgv) = svarg;
+    /* The factors are passed in @_, so we use call_sv as forpart does. */
+    ctx = start_factor_range(beg, end);
+    while ( (nfactors = next_factor_range(ctx, &n, factors)) >= 0 ) {
+      dSP;
+      sv_setuv(svarg, n);
+      ENTER; SAVETMPS; PUSHMARK(SP);
+      EXTEND(SP, nfactors);
+      for (i = 0; i < nfactors; i++)
+        PUSHs(sv_2mortal(newSVuv(factors[i])));
+      PUTBACK; call_sv((SV*)cv, G_VOID|G_DISCARD);
+      FREETMPS; LEAVE;
+    }
+    end_factor_range(ctx);
+    SvREFCNT_dec(svarg);
+
+void
+fortotients (SV* block, IN SV* svbeg, IN SV* svend = 0)
+  ALIAS:
+    formoebius = 1
+  PROTOTYPE: &$;$
+  PREINIT:
+    UV beg, end, wlo, whi, i;
+    const UV* totients;
+    const signed char* mu;
+    void* ctx;
+    GV *gv;
+    HV *stash;
+    SV* svarg;  /* We use svarg to prevent clobbering $_ outside the block */
+    SV* svval;
+    CV *cv;
+  PPCODE:
+    cv = sv_2cv(block, &stash, &gv, 0);
+    if (cv == Nullcv)
+      croak("Not a subroutine reference");
+
+    if (!_validate_int(aTHX_ svbeg, 0) || (items >= 3 && !_validate_int(aTHX_ svend,0))) {
+      _vcallsubn(aTHX_ G_VOID|G_DISCARD, VCALL_ROOT, (ix == 0) ? "_generic_fortotients" : "_generic_formoebius", items);
+      return;
+    }
+
+    if (items < 3) {
+      beg = 1;
+      end = my_svuv(svbeg);
+    } else {
+      beg = my_svuv(svbeg);
+      end = my_svuv(svend);
+    }
+
+    SAVESPTR(GvSV(PL_defgv));
+    svarg = newSVuv(0);
+    svval = newSViv(0);
+    GvSV(PL_defgv) = svarg;
+    /* The value is passed in $_[0], one window of the sieve at a time. */
+    ctx = (ix == 0) ? start_totient_range(beg, end) : start_moebius_range(beg, end);
+    while ( (ix == 0) ? next_totient_range(ctx, &wlo, &whi, &totients)
+                      : next_moebius_range(ctx, &wlo, &whi, &mu) ) {
+      for (i = 0; i <= whi-wlo; i++) {
+        dSP;
+        sv_setuv(svarg, wlo+i);
+        if (ix == 0) sv_setuv(svval, totients[i]);
+        else         sv_setiv(svval, mu[i]);
+        PUSHMARK(SP);
+        XPUSHs(svval);
+        PUTBACK; call_sv((SV*)cv, G_VOID|G_DISCARD);
+      }
+    }
+    if (ix == 0) end_totient_range(ctx);
+    else         end_moebius_range(ctx);
+    SvREFCNT_dec(svval);
+    SvREFCNT_dec(svarg);
+
+void
+forsigma (SV* block, IN SV* svk, IN SV* svbeg, IN SV* svend = 0)
+  PROTOTYPE: &$$;$
+  PREINIT:
+    UV k, beg, end, wlo, whi, i;
+    const UV* sigma;
+    void* ctx = 0;
+    GV *gv;
+    HV *stash;
+    SV* svarg;
+    SV* svval;
+    CV *cv;
+  PPCODE:
+    cv = sv_2cv(block, &stash, &gv, 0);
+    if (cv == Nullcv)
+      croak("Not a subroutine reference");
+
+    if (_validate_int(aTHX_ svk, 0) && _validate_int(aTHX_ svbeg, 0) && (items < 4 || _validate_int(aTHX_ svend, 0))) {
+      k = my_svuv(svk);
+      beg = (items < 4) ? 1 : my_svuv(svbeg);
+      end = (items < 4) ? my_svuv(svbeg) : my_svuv(svend);
+      ctx = start_sigma_range(beg, end, k);
+    }
+    if (ctx == 0) {     /* bigints, or sigma_k could overflow */
+      _vcallsubn(aTHX_ G_VOID|G_DISCARD, VCALL_ROOT, "_generic_forsigma", items);
+      return;
+    }
+
+    SAVESPTR(GvSV(PL_defgv));
+    svarg = newSVuv(0);
+    svval = newSVuv(0);
+    GvSV(PL_defgv) = svarg;
+    while (next_sigma_range(ctx, &wlo, &whi, &sigma)) {
+      for (i = 0; i <= whi-wlo; i++) {
+        dSP;
+        sv_setuv(svarg, wlo+i);
+        sv_setuv(svval, sigma[i]);
+        PUSHMARK(SP);
+        XPUSHs(svval);
+        PUTBACK; call_sv((SV*)cv, G_VOID|G_DISCARD);
+      }
+    }
+    end_sigma_range(ctx);
+    SvREFCNT_dec(svval);
+    SvREFCNT_dec(svarg);
 
 void
 forpart (SV* block, IN SV* svn, IN SV* svh = 0)
@@ -6,9 +6,11 @@
 
 /* The AKS primality algorithm for native integers.
  *
- * There are two versions here.  The v6 algorithm from the latest AKS paper,
- * as well as one with improvements from Bernstein and Voloch and better r/s
- * selection derived from Folkmar Bornemann's 2002 Pari implementation.
+ * There are three versions here.  The v6 algorithm from the latest AKS paper,
+ * one with improvements from Bernstein and Voloch and better r/s selection
+ * derived from Folkmar Bornemann's 2002 Pari implementation, and (the
+ * default) r/s selection from theorem 4.1 of Bernstein's 2003 "Proving
+ * primality after Agrawal-Kayal-Saxena".
  *
  * Note that AKS is very, very slow compared to other methods.  It is, however,
  * polynomial in log(N), and log-log performance graphs show nice straight
@@ -39,16 +41,23 @@
 /* Use improvements from Bornemann's 2002 implementation */
 #define IMPL_BORNEMANN 1
 
+/* Use Bernstein's 2003 theorem 4.1 (with Voloch's counting) to pick r and
+ * s.  This takes precedence over IMPL_BORNEMANN, needing far fewer
+ * witnesses:  about 250 instead of 2100 for 64-bit n. */
+#define IMPL_BERN41 1
+
 #include "ptypes.h"
 #include "aks.h"
 #define FUNC_isqrt 1
 #define FUNC_gcd_ui 1
+#define FUNC_log2floor 1
 #include "util.h"
 #include "cache.h"
 #include "mulmod.h"
 #include "factor.h"
+#include "montmath.h"
 
-#if IMPL_BORNEMANN
+#if IMPL_BORNEMANN || IMPL_BERN41
 static int is_primitive_root(UV n, UV r)
 {
   UV fac[MPU_MAX_FACTORS+1];
@@ -85,6 +94,30 @@ static double log_gamma(double x)
 #define lgamma(x) log_gamma(x)
 #endif
 
+#if IMPL_BERN41
+static double log_binomial(UV n, UV k)
+{
+  if (k > n)  return -DBL_MAX;
+  return lgamma(n+1) - lgamma(k+1) - lgamma(n-k+1);
+}
+/* Bernstein 2003, theorem 4.1:  with n a primitive root mod prime r, s
+ * witnesses suffice if for some 0 <= i <= d <= r-2, 0 <= j <= r-2-d,
+ *   C(2s,i) C(d,i) C(2s-i,j) C(r-2-d,j) >= n^ceil(sqrt((r-1)/3))
+ * We use d and i,j near r/2 and 0.475r, which is close to best. */
+static int bern41_acceptable(UV n, UV r, UV s)
+{
+  double scmp = ceil(sqrt( (r-1)/3.0 )) * log(n);
+  UV d = (UV) (0.5 * (r-1));
+  UV i = (UV) (0.475 * (r-1));
+  UV j = i;
+  if (d > r-2)     d = r-2;
+  if (i > d)       i = d;
+  if (j > (r-2-d)) j = r-2-d;
+  if (i > 2*s)     return 0;
+  return (log_binomial(2*s,i) + log_binomial(d,i) + log_binomial(2*s-i,j) + log_binomial(r-2-d,j) >= scmp);
+}
+#endif
+
 #if 0
 /* Naive znorder.  Works well if limit is small.  Note arguments.  */
 static UV order(UV r, UV n, UV limit) {
@@ -185,7 +218,7 @@ static void poly_mod_sqr(UV* px, UV* res, UV r, UV mod)
       rindex = (d < r) ? d : d-r;  /* d % r */
       res[rindex] = (res[rindex] + sum) % mod;
 #if defined(HAVE_UINT128)
-    } else {
+    } else if (mod <= (UV_MAX >> 1)) {  /* Sums of products rarely overflow */
       uint128_t max = ((uint128_t)1 << 127) - 1;
       uint128_t c128, sum128 = 0;
 
@@ -210,7 +243,7 @@ static void poly_mod_sqr(UV* px, UV* res, UV r, UV mod)
       if (sum128 > max) sum128 %= mod;
       rindex = (d < r) ? d : d-r;  /* d % r */
       res[rindex] = ((uint128_t)res[rindex] + sum128) % mod;
-#else
+#endif
     } else {
       while (pp1 < ppend) {
         UV p1 = *pp1++;
@@ -224,18 +257,328 @@ static void poly_mod_sqr(UV* px, UV* res, UV r, UV mod)
         sum = addmod(sum, mulmod(2, mulmod(c, px[d-s_end], mod), mod), mod);
       rindex = (d < r) ? d : d-r;  /* d % r */
       res[rindex] = addmod(res[rindex], sum, mod);
-#endif
     }
   }
   memcpy(px, res, r * sizeof(UV)); /* put result in px */
 }
 
-static UV* poly_mod_pow(UV* pn, UV power, UV r, UV mod)
+#if USE_MONT_PRIMALITY
+/* Multiplication in Z_n[x]/(x^r-1) with number theoretic transforms.
+ *
+ * The coefficients of a product (before reduction mod n) are less than
+ * r*(n-1)^2, so we convolve modulo up to three 62-bit primes p = k*2^32+1
+ * and recover them with the CRT.  Each transform is O(N log N) for the
+ * power of two N >= 2r-1, replacing the O(r^2) mulmods of the schoolbook
+ * loops.
+ *
+ * Butterflies use Shoup's precomputed quotients for the twiddle products
+ * and Harvey's lazy reduction (values kept in [0,2p) or [0,4p)), which
+ * p < 2^62 allows.  Pointwise products and the CRT are Montgomery.
+ *
+ * Below the crossover the schoolbook code is faster, more so when it can use
+ * native products. */
+#define NTT_CROSSOVER(n)  ( ((n) < HALF_WORD) ? 128 : 80 )
+#define NTT_MAX_PRIMES 3
+static const uint64_t ntt_primes[NTT_MAX_PRIMES][2] = {  /* p, generator */
+  { UVCONST(4611685941117976577),  3 },
+  { UVCONST(4611685692009873409), 19 },
+  { UVCONST(4611685606110527489),  3 },
+};
+
+typedef struct {
+  uint64_t p, npi;  /* prime and -1/p mod 2^64 */
+  uint64_t r2;      /* 2^128 mod p, for Montgomery constants */
+  uint64_t red[2];  /* 1 and its Shoup quotient, to reduce inputs */
+  uint64_t scale[2];/* 2^64/N mod p and quotient, undoing pointwise 1/2^64 */
+  uint64_t *w, *wi; /* forward, inverse twiddles w_2len^j and quotients at
+                       [2(len+j)] and [2(len+j)+1] */
+} ntt_prime_t;
+
+typedef struct {
+  UV r, n, N;
+  int nprimes;
+  ntt_prime_t m[NTT_MAX_PRIMES];
+  /* Garner constants, as Montgomery multipliers:  mont(x,c) = x*c */
+  uint64_t crt1;      /* 1/p0 mod p1 */
+  uint64_t crt2a;     /* p0 mod p2 */
+  uint64_t crt2b;     /* 1/(p0*p1) mod p2 */
+  uint64_t nnpi;      /* -1/n mod 2^64 */
+  uint64_t c0, c1, c2;/* 1, p0, p0*p1 mod n */
+  uint64_t *fa, *fb;  /* transforms, nprimes*N values each */
+} ntt_ctx_t;
+
+#define ntt_mul(a, b, m)  mont_prod64(a, b, (m)->p, (m)->npi)
+static INLINE uint64_t ntt_add(uint64_t a, uint64_t b, uint64_t p)
+{
+  uint64_t t = a + b;             /* p < 2^62, so no overflow */
+  return (t >= p) ? t-p : t;
+}
+static INLINE uint64_t ntt_sub(uint64_t a, uint64_t b, uint64_t p)
+{
+  return (a >= b) ? a-b : a+p-b;
+}
+/* Multiplier c such that mont_prod64(x, c) = x*a mod m */
+#define ntt_mont_const(a, m) ntt_mul((a) % (m)->p, (m)->r2, m)
+
+/* floor(w * 2^64 / p) for w < p */
+static INLINE uint64_t ntt_shoup_quot(uint64_t w, uint64_t p)
+{
+  uint64_t q, rem;
+  asm("divq %4" : "=a"(q), "=d"(rem) : "a"(0), "d"(w), "rm"(p));
+  return q;
+}
+/* a*w mod p, in [0,2p), for any a < 2^64 */
+static INLINE uint64_t ntt_mul_shoup(uint64_t a, const uint64_t* w, uint64_t p)
+{
+  uint64_t q, lo;
+  asm("mulq %3" : "=a"(lo), "=d"(q) : "a"(a), "rm"(w[1]));
+  return a * w[0] - q * p;
+}
+
+static void ntt_ctx_init(ntt_ctx_t* ctx, UV r, UV n)
+{
+  UV N, len, j, nbits, nr;
+  int i;
+
+  for (N = 1; N < 2*r-1; N <<= 1)
+    ;
+  ctx->r = r;  ctx->n = n;  ctx->N = N;
+  /* Need prod(p) > r*(n-1)^2, and each p > 2^61 */
+  nbits = 2*log2floor(n-1) + 2 + log2floor(r) + 1;
+  ctx->nprimes = (nbits <= 61) ? 1 : (nbits <= 122) ? 2 : 3;
+
+  for (i = 0; i < ctx->nprimes; i++) {
+    ntt_prime_t* m = ctx->m + i;
+    uint64_t p = ntt_primes[i][0], g = ntt_primes[i][1];
+    uint64_t rmodp, wm, wim, t, ti;
+    m->p = p;
+    m->npi = modular_inverse64(p);
+    rmodp = compute_modn64(p);
+    m->r2 = mulmod(rmodp, rmodp, p);
+    m->red[0] = 1;
+    m->red[1] = ntt_shoup_quot(1, p);
+    m->scale[0] = mulmod(rmodp, powmod(N, p-2, p), p);
+    m->scale[1] = ntt_shoup_quot(m->scale[0], p);
+    New(0, m->w, 4*N, uint64_t);
+    m->wi = m->w + 2*N;
+    for (len = 1; len < N; len <<= 1) {
+      wm  = powmod(g, (p-1)/(2*len), p);
+      wim = powmod(wm, p-2, p);
+      t = ti = 1;
+      for (j = 0; j < len; j++) {
+        m->w[2*(len+j)]    = t;
+        m->w[2*(len+j)+1]  = ntt_shoup_quot(t, p);
+        m->wi[2*(len+j)]   = ti;
+        m->wi[2*(len+j)+1] = ntt_shoup_quot(ti, p);
+        t  = mulmod(t, wm, p);
+        ti = mulmod(ti, wim, p);
+      }
+    }
+  }
+  nr = compute_modn64(n);
+  ctx->nnpi = modular_inverse64(n);
+  ctx->c0 = nr;
+  ctx->c1 = ctx->c2 = 0;
+  if (ctx->nprimes > 1) {
+    const ntt_prime_t *m1 = ctx->m + 1, *m2 = ctx->m + 2;
+    uint64_t p0 = ctx->m[0].p, p1 = m1->p, p2 = m2->p;
+    ctx->crt1 = ntt_mont_const(powmod(p0 % p1, p1-2, p1), m1);
+    ctx->c1 = mulmod(p0 % n, nr, n);
+    if (ctx->nprimes > 2) {
+      ctx->crt2a = ntt_mont_const(p0, m2);
+      ctx->crt2b = ntt_mont_const(powmod(mulmod(p0%p2, p1%p2, p2), p2-2, p2), m2);
+      ctx->c2 = mulmod(mulmod(p0 % n, p1 % n, n), nr, n);
+    }
+  }
+  New(0, ctx->fa, 2 * ctx->nprimes * N, uint64_t);
+  ctx->fb = ctx->fa + ctx->nprimes * N;
+}
+static void ntt_ctx_destroy(ntt_ctx_t* ctx)
+{
+  int i;
+  for (i = 0; i < ctx->nprimes; i++)
+    Safefree(ctx->m[i].w);
+  Safefree(ctx->fa);
+}
+
+/* Polynomial px of r coefficients into nprimes transforms of N values each.
+ * Forward DIF, leaving the output in bit-reversed order, values in [0,p). */
+static void ntt_forward(const ntt_ctx_t* ctx, const UV* px, uint64_t* f)
+{
+  UV N = ctx->N, r = ctx->r, len, i, j;
+  int k;
+  for (k = 0; k < ctx->nprimes; k++, f += N) {
+    const ntt_prime_t* m = ctx->m + k;
+    uint64_t p = m->p, p2 = 2*p;
+    for (i = 0; i < r; i++)
+      f[i] = ntt_mul_shoup(px[i], m->red, p);
+    memset(f + r, 0, (N-r) * sizeof(uint64_t));
+    for (len = N/2; len > 1; len >>= 1) {
+      for (i = 0; i < N; i += 2*len) {
+        uint64_t *a = f + i, *b = f + i + len;
+        const uint64_t *w = m->w + 2*len;
+        for (j = 0; j < len; j++) {
+          uint64_t u = a[j], v = b[j], t = u + v;
+          a[j] = (t >= p2) ? t - p2 : t;
+          b[j] = ntt_mul_shoup(u - v + p2, w + 2*j, p);
+        }
+      }
+    }
+    for (i = 0; i < N; i += 2) {   /* Last level has w = 1 */
+      uint64_t u = f[i], v = f[i+1];
+      u = (u >= p) ? u - p : u;
+      v = (v >= p) ? v - p : v;
+      f[i]   = ntt_add(u, v, p);
+      f[i+1] = ntt_sub(u, v, p);
+    }
+  }
+}
+
+/* Inverse DIT transforms of f, folded mod x^r-1 and combined mod n. */
+static void ntt_inverse(const ntt_ctx_t* ctx, uint64_t* f, UV* res)
+{
+  UV N = ctx->N, r = ctx->r, n = ctx->n, nnpi = ctx->nnpi, len, i, j;
+  const ntt_prime_t *m1 = ctx->m + 1, *m2 = ctx->m + 2;
+  int k;
+  for (k = 0; k < ctx->nprimes; k++) {
+    const ntt_prime_t* m = ctx->m + k;
+    uint64_t p = m->p, p2 = 2*p, *g = f + k*N;
+    for (i = 0; i < N; i += 2) {   /* First level has w = 1 */
+      uint64_t u = g[i], v = g[i+1];
+      g[i]   = u + v;
+      g[i+1] = u - v + p2;
+    }
+    for (len = 2; len < N; len <<= 1) {
+      for (i = 0; i < N; i += 2*len) {
+        uint64_t *a = g + i, *b = g + i + len;
+        const uint64_t *w = m->wi + 2*len;
+        for (j = 0; j < len; j++) {
+          uint64_t u = a[j], v = ntt_mul_shoup(b[j], w + 2*j, p);
+          u = (u >= p2) ? u - p2 : u;
+          a[j] = u + v;
+          b[j] = u - v + p2;
+        }
+      }
+    }
+    /* Fold x^(r+i) into x^i, scale, and reduce to [0,p). */
+    for (i = 0; i < r; i++) {
+      uint64_t c = g[i];
+      c = (c >= p2) ? c - p2 : c;
+      if (i+r < N) {
+        uint64_t d = g[i+r];
+        c += (d >= p2) ? d - p2 : d;
+      }
+      c = ntt_mul_shoup(c, m->scale, p);
+      g[i] = (c >= p) ? c - p : c;
+    }
+  }
+  for (i = 0; i < r; i++) {
+    /* Garner:  x = v0 + p0*t1 + p0*p1*t2, then x mod n. */
+    uint64_t v0 = f[i], t1 = 0, t2 = 0, v, y;
+    if (ctx->nprimes > 1) {
+      v = (v0 >= m1->p) ? v0 - m1->p : v0;
+      t1 = ntt_mul(ntt_sub(f[N+i], v, m1->p), ctx->crt1, m1);
+    }
+    if (ctx->nprimes > 2) {
+      v = (v0 >= m2->p) ? v0 - m2->p : v0;
+      y = ntt_add(v, ntt_mul(t1, ctx->crt2a, m2), m2->p);
+      t2 = ntt_mul(ntt_sub(f[2*N+i], y, m2->p), ctx->crt2b, m2);
+    }
+    res[i] = addmod(addmod(mont_prod64(v0, ctx->c0, n, nnpi),
+                           mont_prod64(t1, ctx->c1, n, nnpi), n),
+                    mont_prod64(t2, ctx->c2, n, nnpi), n);
+  }
+}
+
+/* fa = fa*fb/2^64 mod p */
+static void ntt_pointwise(const ntt_ctx_t* ctx, uint64_t* fa, const uint64_t* fb)
+{
+  UV N = ctx->N, i;
+  int k;
+  for (k = 0; k < ctx->nprimes; k++, fa += N, fb += N) {
+    const ntt_prime_t* m = ctx->m + k;
+    for (i = 0; i < N; i++)
+      fa[i] = ntt_mul(fa[i], fb[i], m);
+  }
+}
+
+/* res = pn^power mod (x^r-1, mod) for odd mod.  The transform of pn is
+ * used for both the multiply into the result and the squaring. */
+static void poly_mod_pow_ntt(ntt_ctx_t* ctx, UV* res, UV* pn, UV power)
+{
+  UV r = ctx->r;
+  uint64_t *fa = ctx->fa, *fb = ctx->fb;
+  int res_is_one = 1;
+
+  memset(res, 0, r * sizeof(UV));
+  res[0] = 1;
+  while (power) {
+    ntt_forward(ctx, pn, fb);
+    if (power & 1) {
+      if (res_is_one) {
+        memcpy(res, pn, r * sizeof(UV));
+        res_is_one = 0;
+      } else {
+        ntt_forward(ctx, res, fa);
+        ntt_pointwise(ctx, fa, fb);
+        ntt_inverse(ctx, fa, res);
+      }
+    }
+    power >>= 1;
+    if (power) {
+      ntt_pointwise(ctx, fb, fb);
+      ntt_inverse(ctx, fb, pn);
+    }
+  }
+}
+#endif
+
+/* Polynomials and transform tables for one n and r, shared by every
+ * witness so each test_anr does no allocation or setup. */
+typedef struct {
+  UV n, r;
+  UV *pn, *res, *temp;
+#if USE_MONT_PRIMALITY
+  int use_ntt;
+  ntt_ctx_t ntt;
+#endif
+} aks_work_t;
+
+static void aks_work_init(aks_work_t* w, UV n, UV r)
+{
+  w->n = n;
+  w->r = r;
+  New(0, w->pn, 3*r, UV);
+  w->res = w->pn + r;
+  w->temp = w->pn + 2*r;
+#if USE_MONT_PRIMALITY
+  w->use_ntt = (r >= NTT_CROSSOVER(n) && (n & 1));
+  if (w->use_ntt)
+    ntt_ctx_init(&(w->ntt), r, n);
+#endif
+}
+static void aks_work_destroy(aks_work_t* w)
+{
+#if USE_MONT_PRIMALITY
+  if (w->use_ntt)
+    ntt_ctx_destroy(&(w->ntt));
+#endif
+  Safefree(w->pn);
+}
+
+/* w->res = w->pn^power, destroying w->pn */
+static void poly_mod_pow(aks_work_t* w, UV power)
 {
-  UV *res, *temp;
+  UV r = w->r, mod = w->n;
+  UV *pn = w->pn, *res = w->res, *temp = w->temp;
 
-  Newz(0, res, r, UV);
-  New(0, temp, r, UV);
+#if USE_MONT_PRIMALITY
+  if (w->use_ntt) {
+    poly_mod_pow_ntt(&(w->ntt), res, pn, power);
+    return;
+  }
+#endif
+  memset(res, 0, r * sizeof(UV));
   res[0] = 1;
 
   while (power) {
@@ -243,31 +586,26 @@ static UV* poly_mod_pow(UV* pn, UV power, UV r, UV mod)
     power >>= 1;
     if (power)      poly_mod_sqr(pn, temp, r, mod);
   }
-  Safefree(temp);
-  return res;
 }
 
-static int test_anr(UV a, UV n, UV r)
+/* Is (x+a)^n = x^n + a mod (x^r-1, n)? */
+static int test_anr(UV a, aks_work_t* w)
 {
-  UV* pn;
-  UV* res;
-  UV i;
-  int retval = 1;
-
-  Newz(0, pn, r, UV);
-  a %= r;
-  pn[0] = a;
-  pn[1] = 1;
-  res = poly_mod_pow(pn, n, r, n);
+  UV n = w->n, r = w->r, i;
+  UV* res = w->res;
+
+  memset(w->pn, 0, r * sizeof(UV));
+  a %= n;
+  w->pn[0] = a;
+  w->pn[1] = 1;
+  poly_mod_pow(w, n);
   res[n % r] = addmod(res[n % r], n - 1, n);
   res[0]     = addmod(res[0],     n - a, n);
 
   for (i = 0; i < r; i++)
     if (res[i] != 0)
-      retval = 0;
-  Safefree(res);
-  Safefree(pn);
-  return retval;
+      return 0;
+  return 1;
 }
 
 /*
@@ -280,6 +618,7 @@ static int test_anr(UV a, UV n, UV r)
 int _XS_is_aks_prime(UV n)
 {
   UV r, s, a;
+  aks_work_t work;
   int verbose;
 
   if (n < 2)
@@ -294,7 +633,53 @@ int _XS_is_aks_prime(UV n)
   /* if (!is_prob_prime(n)) return 0; */
 
   verbose = _XS_get_verbose();
-#if IMPL_BORNEMANN == 0
+#if IMPL_BERN41
+  {
+    UV fac[MPU_MAX_FACTORS+1];
+    UV slim, rt, st, cost, bestcost = 0;
+    double const log2n = log(n) / log(2);
+    /* Tuning: initial r, and how far past the best r we keep looking */
+    UV const r0 = (UV) (0.008 * log2n * log2n);
+    UV const rmult = 8;
+
+    r = s = 0;
+    for (rt = next_prime(r0 < 2 ? 2 : r0);  r == 0 || rt <= rmult*r;  rt = next_prime(rt)) {
+      if (!is_primitive_root(n, rt))
+        continue;
+      { /* Binary search for the least acceptable s */
+        UV i = 1, j = 100*rt + 1000;
+        if (!bern41_acceptable(n, rt, j))
+          continue;
+        while (i < j) {
+          st = i + (j-i)/2;
+          if (bern41_acceptable(n, rt, st))  j = st;
+          else                               i = st+1;
+        }
+        st = i;
+      }
+      /* Estimated work for the s powerings at this r */
+#if USE_MONT_PRIMALITY
+      if (rt >= NTT_CROSSOVER(n)) {
+        UV N, logN;
+        for (N = 1, logN = 0; N < 2*rt-1; N <<= 1, logN++)
+          ;
+        cost = st * 2 * N * logN;
+      } else
+#endif
+        cost = st * rt * rt;
+      if (r == 0 || cost < bestcost) {
+        r = rt;  s = st;  bestcost = cost;
+      }
+    }
+
+    slim = (r > s) ? r : s;
+    if (verbose > 1) printf("# aks trial to %lu\n", slim);
+    if (trial_factor(n, fac, slim) > 1)
+      return 0;
+    if (slim >= HALF_WORD || (slim*slim) >= n)
+      return 1;
+  }
+#elif IMPL_BORNEMANN == 0
   {
     UV sqrtn = isqrt(n);
     double log2n = log(n) / log(2);   /* C99 has a log2() function */
@@ -361,11 +746,13 @@ int _XS_is_aks_prime(UV n)
   /* Almost every composite will get recognized by the first test.
    * However, we need to run 's' tests to have the result proven for all n
    * based on the theorems we have available at this time. */
+  aks_work_init(&work, n, r);
   for (a = 1; a <= s; a++) {
-    if (! test_anr(a, n, r) )
-      return 0;
+    if (! test_anr(a, &work) )
+      break;
     if (verbose>1) { printf("."); fflush(stdout); }
   }
   if (verbose>1) { printf("\n"); }
-  return 1;
+  aks_work_destroy(&work);
+  return (a > s);
 }
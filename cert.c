@@ -0,0 +1,1220 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <ctype.h>
+
+/*
+ * Primality certificates for integers up to 128 bits, in the MPU text
+ * format that PrimalityProving.pm reads and writes.
+ *
+ * Inputs up to 2^64 get a "Small" certificate, since BPSW is deterministic
+ * there.  Above that, we build the same BLS75 theorem 5 (n-1) proof that
+ * primality_proof_bls75 does, but with Montgomery arithmetic on 128-bit
+ * integers and the native factoring code for any part of n-1 below 2^64.
+ * Factors of n-1 over 2^64 get their own BLS5 proofs recursively.
+ *
+ * There is no ECPP here, so if n-1 can't be factored to (n/2)^(1/3) we
+ * return nothing and the caller falls back to the Perl code.
+ *
+ * We also verify certificates in the same format, every step type that
+ * verify_cert knows, as long as all the numbers are below 2^128.
+ *
+ * Copyright 2015, Dana Jacobsen.
+ */
+
+#include "ptypes.h"
+#include "cert.h"
+#include "util.h"
+#include "cache.h"
+#include "sieve.h"
+#include "factor.h"
+#include "primality.h"
+#include "mulmod.h"
+
+#if defined(HAVE_UINT128)
+
+#define U128_MAX (~(uint128_t)0)
+
+/******************************************************************************/
+/*                          128-bit integer helpers                           */
+/******************************************************************************/
+
+static int u128_from_str(const char* s, uint128_t* n)
+{
+  uint128_t v = 0;
+  if (s == 0 || *s == '\0') return 0;
+  for ( ; *s; s++) {
+    unsigned d = *s - '0';
+    if (d > 9) return 0;
+    if (v > (U128_MAX - d) / 10) return 0;
+    v = 10*v + d;
+  }
+  *n = v;
+  return 1;
+}
+static int u128_to_str(uint128_t n, char* buf)
+{
+  char tmp[40];
+  int i = 0, len;
+  do { tmp[i++] = '0' + (int)(n % 10);  n /= 10; } while (n > 0);
+  for (len = 0; i > 0; len++)
+    buf[len] = tmp[--i];
+  buf[len] = '\0';
+  return len;
+}
+static uint128_t gcd128(uint128_t a, uint128_t b)
+{
+  while (b) { uint128_t t = a % b;  a = b;  b = t; }
+  return a;
+}
+static uint128_t isqrt128(uint128_t n)
+{
+  uint128_t r = (uint128_t) sqrtl((long double)n);
+  while (r > 0 && r*r > n)  r--;
+  while ((r+1)*(r+1) <= n)  r++;
+  return r;
+}
+/* hi:lo = a*b */
+static INLINE void mul128(uint128_t a, uint128_t b, uint128_t* hi, uint128_t* lo)
+{
+  uint64_t a0 = (uint64_t)a, a1 = (uint64_t)(a >> 64);
+  uint64_t b0 = (uint64_t)b, b1 = (uint64_t)(b >> 64);
+  uint128_t p00 = (uint128_t)a0 * b0, p01 = (uint128_t)a0 * b1;
+  uint128_t p10 = (uint128_t)a1 * b0, p11 = (uint128_t)a1 * b1;
+  uint128_t mid = (p00 >> 64) + (uint64_t)p01 + (uint64_t)p10;
+  *lo = (mid << 64) | (uint64_t)p00;
+  *hi = p11 + (p01 >> 64) + (p10 >> 64) + (mid >> 64);
+}
+
+/******************************************************************************/
+/*                   Montgomery arithmetic, odd n < 2^128                     */
+/******************************************************************************/
+
+typedef struct {
+  uint128_t n;
+  uint128_t npi;   /* -1/n mod 2^128 */
+  uint128_t one;   /* 2^128 mod n */
+  uint128_t r2;    /* 2^256 mod n */
+} mont128_t;
+
+static INLINE uint128_t addmod128(uint128_t a, uint128_t b, uint128_t n)
+{
+  uint128_t t = a + b;
+  return (t < a || t >= n) ? t - n : t;
+}
+static INLINE uint128_t submod128(uint128_t a, uint128_t b, uint128_t n)
+{
+  return (a >= b) ? a - b : a + (n - b);
+}
+static INLINE uint128_t mont128_mul(uint128_t a, uint128_t b, const mont128_t* m)
+{
+  uint128_t thi, tlo, mhi, mlo, u;
+  int carry;
+  mul128(a, b, &thi, &tlo);
+  mul128(tlo * m->npi, m->n, &mhi, &mlo);
+  /* tlo + mlo is 0 mod 2^128, carrying unless tlo is 0 */
+  u = thi + mhi;
+  carry = (u < thi);
+  if (tlo != 0)
+    carry |= (++u == 0);
+  return (carry || u >= m->n) ? u - m->n : u;
+}
+static void mont128_init(mont128_t* m, uint128_t n)
+{
+  uint128_t inv = n;
+  int i;
+  for (i = 0; i < 6; i++)       /* 3 bits correct, doubling each step */
+    inv *= 2 - n*inv;
+  m->n = n;
+  m->npi = -inv;
+  m->one = (0 - n) % n;
+  m->r2 = m->one;
+  for (i = 0; i < 128; i++)
+    m->r2 = addmod128(m->r2, m->r2, n);
+}
+#define mont128_to(a, m)    mont128_mul((a) % (m)->n, (m)->r2, m)
+#define mont128_from(a, m)  mont128_mul(a, 1, m)
+/* a^k in Montgomery form, for a in Montgomery form */
+static uint128_t mont128_pow(uint128_t a, uint128_t k, const mont128_t* m)
+{
+  uint128_t t = m->one;
+  while (k) {
+    if (k & 1)  t = mont128_mul(t, a, m);
+    k >>= 1;
+    if (k)      a = mont128_mul(a, a, m);
+  }
+  return t;
+}
+
+/* Miller-Rabin to several bases, so only used to decide what to try to
+ * prove.  Below 2^64 this is BPSW. */
+static int u128_is_prob_prime(uint128_t n)
+{
+  static const UV bases[12] = {2,3,5,7,11,13,17,19,23,29,31,37};
+  mont128_t m;
+  uint128_t d, mone;
+  int i, j, s;
+
+  if (n <= UV_MAX)  return is_prob_prime((UV)n) != 0;
+  if (!(n & 1))     return 0;
+  for (i = 1; i < 12; i++)
+    if (n % bases[i] == 0)  return 0;
+  mont128_init(&m, n);
+  mone = m.n - m.one;
+  for (d = n-1, s = 0; !(d & 1); d >>= 1)  s++;
+  for (i = 0; i < 12; i++) {
+    uint128_t x = mont128_pow(mont128_to(bases[i], &m), d, &m);
+    if (x == m.one || x == mone)  continue;
+    for (j = 1; j < s && x != mone; j++)
+      x = mont128_mul(x, x, &m);
+    if (x != mone)  return 0;
+  }
+  return 1;
+}
+
+/* Pollard-Brent on odd composite n, as pbrent_factor.  Returns a factor or
+ * 0 if none was found in the given rounds. */
+static uint128_t pbrent128(uint128_t n, UV rounds, UV a)
+{
+  mont128_t m;
+  uint128_t f = 1, Xi, Xm, saveXi = 0, c, q;
+  UV r = 1;
+  const UV inner = 64;
+
+  mont128_init(&m, n);
+  c = mont128_to(a, &m);
+  Xi = Xm = mont128_to(2, &m);
+  while (rounds > 0) {
+    UV rleft = (r > rounds) ? rounds : r;
+    /* Do rleft rounds, inner at a time */
+    while (rleft > 0) {
+      UV dorounds = (rleft > inner) ? inner : rleft;
+      saveXi = Xi;
+      rleft -= dorounds;
+      rounds -= dorounds;
+      q = m.one;
+      while (dorounds-- > 0) {
+        Xi = addmod128(mont128_mul(Xi, Xi, &m), c, n);
+        q = mont128_mul(q, (Xi > Xm) ? Xi-Xm : Xm-Xi, &m);
+      }
+      f = gcd128(q, n);
+      if (f != 1)
+        break;
+    }
+    if (f == 1) {
+      r *= 2;
+      Xm = Xi;
+      continue;
+    }
+    if (f == n) {  /* back up, with safety */
+      Xi = saveXi;
+      do {
+        Xi = addmod128(mont128_mul(Xi, Xi, &m), c, n);
+        f = gcd128((Xi > Xm) ? Xi-Xm : Xm-Xi, n);
+      } while (f == 1 && r-- != 0);
+    }
+    return (f == 1 || f == n) ? 0 : f;
+  }
+  return 0;
+}
+
+/******************************************************************************/
+/*                              Certificate text                              */
+/******************************************************************************/
+
+typedef struct {
+  char* s;
+  UV len;
+  UV alloc;
+} cert_text_t;
+
+static void cert_cat(cert_text_t* c, const char* str)
+{
+  UV slen = strlen(str);
+  if (c->len + slen + 1 > c->alloc) {
+    c->alloc = 2 * (c->len + slen + 1);
+    Renew(c->s, c->alloc, char);
+  }
+  memcpy(c->s + c->len, str, slen+1);
+  c->len += slen;
+}
+static void cert_cat_u128(cert_text_t* c, const char* pre, uint128_t n)
+{
+  char buf[80];
+  int len = strlen(pre);
+  memcpy(buf, pre, len);
+  len += u128_to_str(n, buf + len);
+  buf[len++] = '\n';
+  buf[len] = '\0';
+  cert_cat(c, buf);
+}
+
+/******************************************************************************/
+/*                             BLS75 n-1 proofs                               */
+/******************************************************************************/
+
+#define CERT_MAX_Q 64
+#define CERT_TRIAL_LIMIT 20000
+#define CERT_RHO_ROUNDS 4000000
+
+typedef struct {
+  uint128_t n, nm1;
+  uint128_t F, R;       /* F*R = n-1, F the product of the prime powers q^e */
+  uint128_t q[CERT_MAX_Q];
+  int nq;
+} bls5_t;
+
+/* Move every factor of prime q from R to F */
+static void bls5_add_q(bls5_t* b, uint128_t q)
+{
+  int i;
+  if (b->R % q != 0) return;
+  for (i = 0; i < b->nq; i++)
+    if (b->q[i] == q) return;
+  if (b->nq >= CERT_MAX_Q) return;
+  b->q[b->nq++] = q;
+  do { b->R /= q;  b->F *= q; } while (b->R % q == 0);
+}
+static void bls5_add_native(bls5_t* b, UV m)
+{
+  UV fac[MPU_MAX_FACTORS+1];
+  int i, nfac = factor(m, fac);
+  for (i = 0; i < nfac; i++)
+    bls5_add_q(b, fac[i]);
+}
+
+/* Theorem 5:  n < (F+1)(2F^2 + (r-1)F + 1) where R = 2Fs + r */
+static int bls5_enough(const bls5_t* b, uint128_t* s, uint128_t* r)
+{
+  uint128_t F = b->F, Q;
+  if (F >> 127) {       /* 2F overflows, but R < 2 */
+    *s = 0;  *r = b->R;
+  } else {
+    *s = b->R / (2*F);
+    *r = b->R % (2*F);
+  }
+  if (F >> 43)  return 1;     /* P > F^3 >= 2^129 */
+  Q = 2*F*F - F + (*r)*F + 1;
+  return (b->n / Q <= F);
+}
+
+/* Return 2 and append the proof if n is proven prime, 0 if composite, 1 if
+ * we couldn't tell. */
+static int _bls5_prove(uint128_t n, cert_text_t* cert)
+{
+  bls5_t b;
+  mont128_t m;
+  uint128_t stack[CERT_MAX_Q], s, r;
+  char abuf[40];
+  cert_text_t atext, sub;
+  int i, nstack = 0, res = 2;
+
+  if (n <= UV_MAX)  return is_prob_prime((UV)n) ? 2 : 0;
+  if (!(n & 1))     return 0;
+
+  b.n = n;
+  b.nm1 = b.R = n-1;
+  b.F = 1;
+  b.nq = 0;
+  bls5_add_q(&b, 2);
+  START_DO_FOR_EACH_PRIME(3, CERT_TRIAL_LIMIT) {
+    if (b.R > UV_MAX && b.R % p == 0)
+      bls5_add_q(&b, p);
+  } END_DO_FOR_EACH_PRIME
+  if (b.R > 1)
+    stack[nstack++] = b.R;
+
+  /* Split the cofactor until the factored part is large enough */
+  while (nstack > 0 && !bls5_enough(&b, &s, &r)) {
+    uint128_t c = stack[--nstack], f;
+    if (c <= UV_MAX) {
+      bls5_add_native(&b, (UV)c);
+    } else if (u128_is_prob_prime(c)) {
+      bls5_add_q(&b, c);
+    } else if (nstack+2 <= CERT_MAX_Q && (f = pbrent128(c, CERT_RHO_ROUNDS, 1)) != 0) {
+      stack[nstack++] = f;
+      stack[nstack++] = c / f;
+    }
+  }
+  if (!bls5_enough(&b, &s, &r))
+    return 1;
+  /* With r >= 2^63, F > 2^62 so 8s < 64 < 2r-1, and r^2-8s falls strictly
+   * between (r-1)^2 and r^2. */
+  if (s != 0 && !(r >> 63) && r*r >= 8*s) {
+    uint128_t t = r*r - 8*s, sq = isqrt128(t);
+    if (sq*sq == t)  return 1;
+  }
+
+  /* Sort Q ascending, 2 stays first */
+  for (i = 2; i < b.nq; i++) {
+    uint128_t t = b.q[i];
+    int j = i;
+    while (j > 1 && b.q[j-1] > t) { b.q[j] = b.q[j-1];  j--; }
+    b.q[j] = t;
+  }
+
+  mont128_init(&m, n);
+  New(0, atext.s, 64, char);  atext.len = 0;  atext.alloc = 64;  atext.s[0] = '\0';
+  New(0, sub.s, 64, char);    sub.len = 0;    sub.alloc = 64;    sub.s[0] = '\0';
+
+  cert_cat(cert, "Type BLS5\n");
+  cert_cat_u128(cert, "N ", n);
+  for (i = 0; i < b.nq && res == 2; i++) {
+    uint128_t q = b.q[i];
+    UV a;
+    for (a = 2; a < 10000; a++) {
+      uint128_t ma = mont128_to(a, &m), t;
+      if (mont128_pow(ma, b.nm1, &m) != m.one) { res = 0; break; }
+      t = mont128_from(mont128_pow(ma, b.nm1 / q, &m), &m);
+      if (gcd128(submod128(t, 1, n), n) == 1)  break;
+    }
+    if (res != 2)  break;
+    if (a >= 10000) { res = 1; break; }
+    if (i > 0) {
+      sprintf(abuf, "Q[%d] ", i);
+      cert_cat_u128(cert, abuf, q);
+    }
+    if (a != 2) {
+      sprintf(abuf, "A[%d] %lu\n", i, (unsigned long)a);
+      cert_cat(&atext, abuf);
+    }
+    if (q > UV_MAX) {
+      cert_cat(&sub, "\n");
+      res = _bls5_prove(q, &sub);
+      if (res == 0)  res = 1;   /* Our probable prime test was wrong */
+    }
+  }
+  if (res == 2) {
+    cert_cat(cert, atext.s);
+    cert_cat(cert, "----\n");
+    cert_cat(cert, sub.s);
+  }
+  Safefree(atext.s);
+  Safefree(sub.s);
+  return res;
+}
+
+char* bls75_certificate(const char* nstr)
+{
+  uint128_t n;
+  cert_text_t cert;
+
+  if (!u128_from_str(nstr, &n) || n <= UV_MAX || !u128_is_prob_prime(n))
+    return 0;
+  New(0, cert.s, 256, char);
+  cert.len = 0;  cert.alloc = 256;  cert.s[0] = '\0';
+  if (_bls5_prove(n, &cert) != 2) {
+    Safefree(cert.s);
+    return 0;
+  }
+  return cert.s;
+}
+
+/******************************************************************************/
+/*                          Certificate verification                          */
+/******************************************************************************/
+
+/*
+ * This follows verify_cert in PrimalityProving.pm step for step, with the
+ * same failure messages.  Anything we don't handle here -- numbers of 2^128
+ * or more, negative values where they make no sense, even N in a step that
+ * needs a modular power, and every malformed line -- makes us return
+ * CERT_DEFER and the Perl code takes the whole certificate.
+ */
+
+#define CERT_FAIL    0
+#define CERT_OK      1
+#define CERT_DEFER (-1)
+
+typedef struct {
+  uint128_t n;
+  UV qstart, nq;        /* this step's q values in vc->qs */
+} vpart_t;
+
+typedef struct {
+  char** lines;
+  UV nlines, pos;
+  int verbose;
+  uint128_t* qs;        /* "n is prime if these q are prime" */
+  UV nqs, qalloc;
+  vpart_t* parts;
+  UV nparts, palloc;
+} vcert_t;
+
+static int _vfail(const vcert_t* vc, const char* type, uint128_t n, const char* what)
+{
+  if (vc->verbose) {
+    char nstr[40];
+    u128_to_str(n, nstr);
+    printf("primality fail: %s: %s failed %s\n", type, nstr, what);
+    fflush(stdout);
+  }
+  return CERT_FAIL;
+}
+#define VFAIL(what)  return _vfail(vc, type, n, what)
+
+static void _vpush_q(vcert_t* vc, uint128_t q)
+{
+  if (vc->nqs >= vc->qalloc) {
+    vc->qalloc = 2 * vc->qalloc + 16;
+    Renew(vc->qs, vc->qalloc, uint128_t);
+  }
+  vc->qs[vc->nqs++] = q;
+}
+/* Record that n is prime if the last nq values pushed are, replacing any
+ * earlier step for the same n as the Perl hash does. */
+static int _vadd_part(vcert_t* vc, uint128_t n, UV nq)
+{
+  UV i;
+  for (i = 0; i < vc->nparts; i++)
+    if (vc->parts[i].n == n)
+      break;
+  if (i == vc->nparts) {
+    if (vc->nparts >= vc->palloc) {
+      vc->palloc = 2 * vc->palloc + 16;
+      Renew(vc->parts, vc->palloc, vpart_t);
+    }
+    vc->nparts++;
+  }
+  vc->parts[i].n = n;
+  vc->parts[i].qstart = vc->nqs - nq;
+  vc->parts[i].nq = nq;
+  return CERT_OK;
+}
+
+/* Lines that are blank or start with '#' are skipped everywhere */
+static int _vskip(const char* s)
+{
+  while (isspace((unsigned char)*s))  s++;
+  return (*s == '#' || *s == '\0');
+}
+static char* _vnext(vcert_t* vc)
+{
+  while (vc->pos < vc->nlines) {
+    char* line = vc->lines[vc->pos++];
+    if (!_vskip(line))
+      return line;
+  }
+  return 0;
+}
+/* Read -?\d+ at *s.  Returns 1, 0 if there is no number, -1 if it needs more
+ * than 128 bits. */
+static int _vnum(const char** s, uint128_t* v, int* neg)
+{
+  const char* p = *s;
+  uint128_t r = 0;
+  int isneg = 0;
+  if (*p == '-' && neg != 0) { isneg = 1; p++; }
+  if (!isdigit((unsigned char)*p))  return 0;
+  for ( ; isdigit((unsigned char)*p); p++) {
+    unsigned d = *p - '0';
+    if (r > (U128_MAX - d) / 10)  return -1;
+    r = 10*r + d;
+  }
+  *s = p;
+  *v = r;
+  if (neg != 0) *neg = isneg;
+  return 1;
+}
+/* "^str\s+(\d+)" */
+static int _vkeynum(const char* line, const char* key, uint128_t* v)
+{
+  size_t klen = strlen(key);
+  if (strncmp(line, key, klen) != 0 || !isspace((unsigned char)line[klen]))
+    return 0;
+  line += klen;
+  while (isspace((unsigned char)*line))  line++;
+  return _vnum(&line, v, 0);
+}
+/* "^str\[(\d+)\]\s+(\d+)" */
+static int _vindexnum(const char* line, char key, UV* idx, uint128_t* v)
+{
+  uint128_t i;
+  if (line[0] != key || line[1] != '[')  return 0;
+  line += 2;
+  if (_vnum(&line, &i, 0) != 1 || i > 1000000 || *line != ']')  return 0;
+  line++;
+  if (!isspace((unsigned char)*line))  return 0;
+  while (isspace((unsigned char)*line))  line++;
+  *idx = (UV)i;
+  return _vnum(&line, v, 0);
+}
+
+/* As _read_vars:  every name must appear exactly once */
+static int _vread_vars(vcert_t* vc, const char* const* names, int nnames,
+                       uint128_t* vals, int* negs)
+{
+  int i, seen = 0;
+  while (seen != (1 << nnames) - 1) {
+    char* line = _vnext(vc);
+    const char* p;
+    size_t len;
+    if (line == 0 || strncmp(line, "Type ", 5) == 0)  return CERT_DEFER;
+    for (len = 0; line[len] != '\0' && !isspace((unsigned char)line[len]); len++)
+      ;
+    if (len == 0 || line[len] == '\0')  return CERT_DEFER;
+    for (i = 0; i < nnames; i++) {
+      size_t j;
+      if (strlen(names[i]) != len) continue;
+      for (j = 0; j < len; j++)
+        if (toupper((unsigned char)line[j]) != names[i][j])
+          break;
+      if (j == len) break;
+    }
+    if (i == nnames || (seen & (1 << i)))  return CERT_DEFER;
+    for (p = line+len; isspace((unsigned char)*p); p++)
+      ;
+    if (_vnum(&p, vals+i, negs+i) != 1)  return CERT_DEFER;
+    seen |= 1 << i;
+  }
+  return CERT_OK;
+}
+static int _vpositive(const int* negs, int nvals)
+{
+  int i;
+  for (i = 0; i < nvals; i++)
+    if (negs[i])
+      return 0;
+  return 1;
+}
+
+static uint128_t _vres(uint128_t v, int neg, uint128_t n)
+{
+  v %= n;
+  return (neg && v != 0) ? n - v : v;
+}
+static uint128_t _vpowmod(uint128_t a, uint128_t k, const mont128_t* m)
+{
+  return mont128_from(mont128_pow(mont128_to(a, m), k, m), m);
+}
+static uint128_t modinverse128(uint128_t a, uint128_t n)
+{
+  uint128_t t = 0, nt = 1, r = n, nr = a;
+  while (nr != 0) {
+    uint128_t quot = r / nr;
+    { uint128_t tmp = nt;  nt = t - quot*nt;  t = tmp; }
+    { uint128_t tmp = nr;  nr = r - quot*nr;  r = tmp; }
+  }
+  if (r > 1) return 0;  /* No inverse */
+  if (t >> 127) t += n;
+  return t;
+}
+static int jacobi128(uint128_t a, uint128_t n)
+{
+  int j = 1;
+  a %= n;
+  while (a != 0) {
+    while (!(a & 1)) {
+      a >>= 1;
+      if ((n & 7) == 3 || (n & 7) == 5)  j = -j;
+    }
+    { uint128_t t = a;  a = n;  n = t; }
+    if ((a & 3) == 3 && (n & 3) == 3)  j = -j;
+    a %= n;
+  }
+  return (n == 1) ? j : 0;
+}
+/* V_k(P,Q) mod n with P and Q in Montgomery form */
+static uint128_t lucas_v128(uint128_t P, uint128_t Q, uint128_t k, const mont128_t* m)
+{
+  uint128_t V = addmod128(m->one, m->one, m->n), W = P, Qk = m->one;
+  int b;
+  for (b = 127; b >= 0 && !((k >> b) & 1); b--)
+    ;
+  for ( ; b >= 0; b--) {
+    uint128_t PQk = mont128_mul(P, Qk, m);
+    if ((k >> b) & 1) {
+      uint128_t Qk1 = mont128_mul(Qk, Q, m);
+      V = submod128(mont128_mul(V, W, m), PQk, m->n);
+      W = submod128(mont128_mul(W, W, m), addmod128(Qk1, Qk1, m->n), m->n);
+      Qk = mont128_mul(Qk, Qk1, m);
+    } else {
+      W = submod128(mont128_mul(V, W, m), PQk, m->n);
+      V = submod128(mont128_mul(V, V, m), addmod128(Qk, Qk, m->n), m->n);
+      Qk = mont128_mul(Qk, Qk, m);
+    }
+  }
+  return mont128_from(V, m);
+}
+
+/* Affine points on y^2 = x^3 + ax + b mod n, coordinates in Montgomery
+ * form.  A nonzero denominator with no inverse means n is composite, which
+ * we note in bad so the step fails. */
+typedef struct { uint128_t x, y; int inf; } ecpt128_t;
+typedef struct { const mont128_t* m; uint128_t a; int bad; } ec128_t;
+
+static uint128_t _ec_div(ec128_t* e, uint128_t num, uint128_t den)
+{
+  uint128_t inv = modinverse128(mont128_from(den, e->m), e->m->n);
+  if (inv == 0) { e->bad = 1;  return 0; }
+  return mont128_mul(num, mont128_to(inv, e->m), e->m);
+}
+static void _ec_double(ec128_t* e, ecpt128_t* P)
+{
+  const mont128_t* m = e->m;
+  uint128_t lam, x3;
+  if (P->inf)  return;
+  if (P->y == 0) { P->inf = 1;  return; }
+  lam = mont128_mul(P->x, P->x, m);
+  lam = addmod128(addmod128(lam, lam, m->n), addmod128(lam, e->a, m->n), m->n);
+  lam = _ec_div(e, lam, addmod128(P->y, P->y, m->n));
+  x3 = submod128(mont128_mul(lam, lam, m), addmod128(P->x, P->x, m->n), m->n);
+  P->y = submod128(mont128_mul(lam, submod128(P->x, x3, m->n), m), P->y, m->n);
+  P->x = x3;
+}
+static void _ec_add(ec128_t* e, ecpt128_t* P, const ecpt128_t* Q)
+{
+  const mont128_t* m = e->m;
+  uint128_t lam, x3;
+  if (Q->inf)  return;
+  if (P->inf) { *P = *Q;  return; }
+  if (P->x == Q->x) {
+    if (P->y == Q->y)                        _ec_double(e, P);
+    else if (addmod128(P->y, Q->y, m->n) == 0)  P->inf = 1;
+    else                                     e->bad = 1;
+    return;
+  }
+  lam = _ec_div(e, submod128(Q->y, P->y, m->n), submod128(Q->x, P->x, m->n));
+  x3 = submod128(mont128_mul(lam, lam, m), addmod128(P->x, Q->x, m->n), m->n);
+  P->y = submod128(mont128_mul(lam, submod128(P->x, x3, m->n), m), P->y, m->n);
+  P->x = x3;
+}
+static void _ec_mul(ec128_t* e, ecpt128_t* P, uint128_t k)
+{
+  ecpt128_t R;
+  int b;
+  R.x = R.y = 0;  R.inf = 1;
+  for (b = 127; b >= 0 && !e->bad; b--) {
+    _ec_double(e, &R);
+    if ((k >> b) & 1)
+      _ec_add(e, &R, P);
+  }
+  *P = R;
+}
+
+/* a, b, x, y are residues mod n */
+static int _verify_ecpp(vcert_t* vc, uint128_t n, uint128_t a, uint128_t b,
+                        uint128_t M, uint128_t q, uint128_t x, uint128_t y)
+{
+  const char* type = "ECPP";
+  mont128_t m;
+  ec128_t e;
+  ecpt128_t P;
+  uint128_t ma, mb, mx, t, s, r4;
+
+  if (n == 0)                      VFAIL("N > 0");
+  if (n % 2 == 0 || n % 3 == 0)    VFAIL("gcd(N, 6) = 1");
+  if (n < 5)                       return CERT_DEFER;
+  mont128_init(&m, n);
+  ma = mont128_to(a, &m);  mb = mont128_to(b, &m);  mx = mont128_to(x, &m);
+  t = mont128_mul(mont128_mul(ma, ma, &m), ma, &m);
+  t = addmod128(mont128_mul(mont128_to(4, &m), t, &m),
+                mont128_mul(mont128_to(27, &m), mont128_mul(mb, mb, &m), &m), n);
+  if (gcd128(mont128_from(t, &m), n) != 1)
+    VFAIL("gcd(4*a^3 + 27*b^2, N) = 1");
+  t = addmod128(mont128_mul(addmod128(mont128_mul(mx, mx, &m), ma, n), mx, &m), mb, n);
+  if (mont128_mul(mont128_to(y, &m), mont128_to(y, &m), &m) != t)
+    VFAIL("Y^2 = X^3 + A*X + B mod N");
+  s = isqrt128(n);
+  t = (s*s + s < n) ? 2*s+1 : 2*s;        /* floor(sqrt(4N)) */
+  if (M < n + 1 - t)               VFAIL("M >= N - 2*sqrt(N) + 1");
+  if (n + 1 + t > n && M > n + 1 + t)  VFAIL("M <= N + 2*sqrt(N) + 1");
+  r4 = isqrt128(s);
+  if (q <= (r4+1)*(r4+1))          VFAIL("Q > (N^(1/4)+1)^2");
+  if (q >= n)                      VFAIL("Q < N");
+  if (M == q)                      VFAIL("M != Q");
+  if (M % q != 0)                  VFAIL("Q divides M");
+
+  /* Compute U = (m/q)P, check U != point at infinity, then V = qU */
+  e.m = &m;  e.a = ma;  e.bad = 0;
+  P.x = mx;  P.y = mont128_to(y, &m);  P.inf = 0;
+  _ec_mul(&e, &P, M / q);
+  if (e.bad || P.inf)              VFAIL("elliptic curve conditions");
+  _ec_mul(&e, &P, q);
+  if (e.bad || !P.inf)             VFAIL("elliptic curve conditions");
+  _vpush_q(vc, q);
+  return _vadd_part(vc, n, 1);
+}
+static int _prove_ecpp(vcert_t* vc)
+{
+  static const char* const names[] = {"N","A","B","M","Q","X","Y"};
+  uint128_t v[7];
+  int neg[7], res = _vread_vars(vc, names, 7, v, neg);
+  if (res != CERT_OK)  return res;
+  if (neg[0] || neg[3] || neg[4] || neg[5] || neg[6] || v[0] == 0)
+    return CERT_DEFER;
+  return _verify_ecpp(vc, v[0], _vres(v[1], neg[1], v[0]), _vres(v[2], neg[2], v[0]),
+                      v[3], v[4], v[5] % v[0], v[6] % v[0]);
+}
+/* Primo types 3 and 4 give the curve as a, b and a point from t */
+static int _vecpp_t(vcert_t* vc, uint128_t n, uint128_t a, uint128_t b,
+                    uint128_t s, uint128_t r, uint128_t t)
+{
+  mont128_t m;
+  uint128_t ma, mb, mt, l, l2;
+  if (s != 0 && r > U128_MAX / s)  return CERT_DEFER;
+  mont128_init(&m, n);
+  ma = mont128_to(a, &m);  mb = mont128_to(b, &m);  mt = mont128_to(t, &m);
+  l = addmod128(mont128_mul(addmod128(mont128_mul(mt, mt, &m), ma, n), mt, &m), mb, n);
+  l2 = mont128_mul(l, l, &m);
+  return _verify_ecpp(vc, n,
+                      mont128_from(mont128_mul(ma, l2, &m), &m),
+                      mont128_from(mont128_mul(mb, mont128_mul(l2, l, &m), &m), &m),
+                      r*s, r,
+                      mont128_from(mont128_mul(mt, l, &m), &m),
+                      mont128_from(l2, &m));
+}
+static int _prove_ecpp3(vcert_t* vc)
+{
+  static const char* const names[] = {"N","S","R","A","B","T"};
+  const char* type = "ECPP3";
+  uint128_t v[6], n;
+  int neg[6], res = _vread_vars(vc, names, 6, v, neg);
+  if (res != CERT_OK)  return res;
+  n = v[0];
+  if (neg[0] || neg[1] || neg[2] || neg[5])  return CERT_DEFER;
+  if (v[3] > n/2)  VFAIL("|A| <= N/2");
+  if (v[4] > n/2)  VFAIL("|B| <= N/2");
+  if (v[5] >= n)   VFAIL("T < N");
+  if (n < 5 || !(n & 1))  return CERT_DEFER;
+  return _vecpp_t(vc, n, _vres(v[3], neg[3], n), _vres(v[4], neg[4], n), v[1], v[2], v[5]);
+}
+static int _prove_ecpp4(vcert_t* vc)
+{
+  static const char* const names[] = {"N","S","R","J","T"};
+  const char* type = "ECPP4";
+  uint128_t v[5], n, j, k, a, b;
+  int neg[5], res = _vread_vars(vc, names, 5, v, neg);
+  if (res != CERT_OK)  return res;
+  n = v[0];
+  if (neg[0] || neg[1] || neg[2] || neg[4])  return CERT_DEFER;
+  if (v[3] > n/2)  VFAIL("|J| <= N/2");
+  if (v[4] >= n)   VFAIL("T < N");
+  if (n < 5 || !(n & 1))  return CERT_DEFER;
+  {
+    mont128_t m;
+    mont128_init(&m, n);
+    /* a = 3j(1728-j), b = 2j(1728-j)^2 */
+    j = mont128_to(_vres(v[3], neg[3], n), &m);
+    k = submod128(mont128_to(1728, &m), j, n);
+    a = mont128_mul(mont128_mul(mont128_to(3, &m), j, &m), k, &m);
+    b = mont128_mul(mont128_mul(mont128_to(2, &m), j, &m), mont128_mul(k, k, &m), &m);
+    a = mont128_from(a, &m);
+    b = mont128_from(b, &m);
+  }
+  return _vecpp_t(vc, n, a, b, v[1], v[2], v[4]);
+}
+
+static int _prove_bls15(vcert_t* vc)
+{
+  static const char* const names[] = {"N","Q","LP","LQ"};
+  const char* type = "BLS15";
+  mont128_t m;
+  uint128_t v[4], n, q, M, lp, lq, D;
+  int neg[4], res = _vread_vars(vc, names, 4, v, neg);
+  if (res != CERT_OK)  return res;
+  n = v[0];  q = v[1];
+  if (neg[0] || neg[1] || n == U128_MAX || v[2] >> 64)  return CERT_DEFER;
+  if (!(q & 1))                    VFAIL("Q odd");
+  if (q <= 2)                      VFAIL("Q > 2");
+  if ((n+1) % q != 0)              VFAIL("Q divides N+1");
+  M = (n+1) / q;
+  if (M == 0)                      VFAIL("M > 0");
+  if (q <= U128_MAX/2 && 2*q-1 <= isqrt128(n))  VFAIL("2Q-1 > sqrt(N)");
+  if (!neg[3] && v[3] <= U128_MAX/4 && v[2]*v[2] == 4*v[3])  VFAIL("D != 0");
+  if (n < 3 || !(n & 1))           VFAIL("jacobi(D,N) = -1");
+  mont128_init(&m, n);
+  lp = mont128_to(_vres(v[2], neg[2], n), &m);
+  lq = mont128_to(_vres(v[3], neg[3], n), &m);
+  D = submod128(mont128_mul(lp, lp, &m), mont128_mul(mont128_to(4, &m), lq, &m), n);
+  if (jacobi128(mont128_from(D, &m), n) != -1)  VFAIL("jacobi(D,N) = -1");
+  if (lucas_v128(lp, lq, M/2, &m) == 0)        VFAIL("V_{m/2} mod N != 0");
+  if (lucas_v128(lp, lq, (n+1)/2, &m) != 0)    VFAIL("V_{(N+1)/2} mod N == 0");
+  _vpush_q(vc, q);
+  return _vadd_part(vc, n, 1);
+}
+
+static int _prove_bls3(vcert_t* vc)
+{
+  static const char* const names[] = {"N","Q","A"};
+  const char* type = "BLS3";
+  mont128_t m;
+  uint128_t v[3], n, q, M;
+  int neg[3], res = _vread_vars(vc, names, 3, v, neg);
+  if (res != CERT_OK)  return res;
+  n = v[0];  q = v[1];
+  if (!_vpositive(neg, 3) || n < 3 || !(n & 1))  return CERT_DEFER;
+  if (!(q & 1))                    VFAIL("Q odd");
+  if (q <= 2)                      VFAIL("Q > 2");
+  if ((n-1) % q != 0)              VFAIL("Q divides N-1");
+  M = (n-1) / q;
+  if (M == 0)                      VFAIL("M > 0");
+  if (2*q+1 <= isqrt128(n))        VFAIL("2Q+1 > sqrt(n)");
+  mont128_init(&m, n);
+  if (_vpowmod(v[2], (n-1)/2, &m) != n-1)  VFAIL("A^((N-1)/2) = N-1 mod N");
+  if (_vpowmod(v[2], M/2, &m) == n-1)      VFAIL("A^(M/2) != N-1 mod N");
+  _vpush_q(vc, q);
+  return _vadd_part(vc, n, 1);
+}
+
+static int _prove_pock(vcert_t* vc)
+{
+  static const char* const names[] = {"N","Q","A"};
+  const char* type = "Pocklington";
+  mont128_t m;
+  uint128_t v[3], n, q, a, M;
+  int neg[3], res = _vread_vars(vc, names, 3, v, neg);
+  if (res != CERT_OK)  return res;
+  n = v[0];  q = v[1];  a = v[2];
+  if (!_vpositive(neg, 3) || n < 3 || !(n & 1) || q == 0)  return CERT_DEFER;
+  if ((n-1) % q != 0)              VFAIL("Q divides N-1");
+  M = (n-1) / q;
+  if (M & 1)                       VFAIL("M is even");
+  if (M == 0)                      VFAIL("M > 0");
+  if (M >= q)                      VFAIL("M < Q");
+  if (a <= 1)                      VFAIL("A > 1");
+  mont128_init(&m, n);
+  if (_vpowmod(a, n-1, &m) != 1)   VFAIL("A^(N-1) mod N = 1");
+  if (gcd128(submod128(_vpowmod(a, M, &m), 1, n), n) != 1)
+    VFAIL("gcd(A^M - 1, N) = 1");
+  _vpush_q(vc, q);
+  return _vadd_part(vc, n, 1);
+}
+
+static int _prove_small(vcert_t* vc)
+{
+  static const char* const names[] = {"N"};
+  uint128_t n;
+  int neg, res = _vread_vars(vc, names, 1, &n, &neg);
+  if (res != CERT_OK)  return res;
+  if (neg)  return CERT_DEFER;
+  if (n > UV_MAX || !is_prob_prime((UV)n)) {
+    if (vc->verbose) {
+      char nstr[40];
+      u128_to_str(n, nstr);
+      printf("primality fail: Small n %s %s\n", nstr,
+             (n > UV_MAX) ? "is > 2^64" : "does not pass BPSW");
+      fflush(stdout);
+    }
+    return CERT_FAIL;
+  }
+  return _vadd_part(vc, n, 0);
+}
+
+/* Q[i] and A[i] lines.  Q[0] = 2 is implicit, and A[i] defaults to 2. */
+static int _prove_bls5(vcert_t* vc)
+{
+  const char* type = "BLS5";
+  mont128_t m;
+  uint128_t n = 0, nm1, F, R, s = 0, r = 0, P, val, *A;
+  UV qstart = vc->nqs, nq, i, idx, aalloc = 16;
+  char* line;
+  char buf[64];
+  int haven = 0, res = CERT_OK;
+
+  _vpush_q(vc, 2);
+  Newz(0, A, aalloc, uint128_t);
+  while (res == CERT_OK) {
+    if ( (line = _vnext(vc)) == 0 ) { res = CERT_DEFER;  break; }
+    if (line[0] == '-')  break;
+    if (_vkeynum(line, "N", &val) == 1) {
+      if (haven) res = CERT_DEFER;
+      n = val;  haven = 1;
+    } else if (_vindexnum(line, 'Q', &idx, &val) == 1) {
+      if (idx != vc->nqs - qstart)  res = CERT_DEFER;
+      else                          _vpush_q(vc, val);
+    } else if (_vindexnum(line, 'A', &idx, &val) == 1) {
+      if (idx >= vc->nqs - qstart)  { res = CERT_DEFER;  break; }
+      if (idx >= aalloc) {
+        UV oldalloc = aalloc;
+        while (aalloc <= idx)  aalloc *= 2;
+        Renew(A, aalloc, uint128_t);
+        memset(A + oldalloc, 0, (aalloc - oldalloc) * sizeof(uint128_t));
+      }
+      A[idx] = val + 1;            /* 0 means not given */
+    } else {
+      res = CERT_DEFER;
+    }
+  }
+  if (res == CERT_OK && (!haven || n < 3 || !(n & 1)))
+    res = CERT_DEFER;
+  if (res != CERT_OK) {
+    Safefree(A);
+    return res;
+  }
+  nq = vc->nqs - qstart;
+  while (aalloc < nq) {            /* Every index below nq is readable */
+    UV oldalloc = aalloc;
+    aalloc *= 2;
+    Renew(A, aalloc, uint128_t);
+    memset(A + oldalloc, 0, (aalloc - oldalloc) * sizeof(uint128_t));
+  }
+  for (i = 0; i < nq; i++)
+    A[i] = (A[i] == 0) ? 2 : A[i]-1;
+
+  nm1 = n-1;
+  F = 1;
+  R = nm1;
+  for (i = 0; i < nq && res == CERT_OK; i++) {
+    uint128_t q = vc->qs[qstart+i];
+    buf[0] = '\0';
+    if      (q <= 1)          sprintf(buf, "Q[%lu] > 1", (unsigned long)i);
+    else if (q >= nm1)        sprintf(buf, "Q[%lu] < N-1", (unsigned long)i);
+    else if (A[i] <= 1)       sprintf(buf, "A[%lu] > 1", (unsigned long)i);
+    else if (A[i] >= n)       sprintf(buf, "A[%lu] < N", (unsigned long)i);
+    else if (nm1 % q != 0)    sprintf(buf, "Q[%lu] divides N-1", (unsigned long)i);
+    if (buf[0] != '\0') {
+      res = _vfail(vc, type, n, buf);
+      break;
+    }
+    while (R % q == 0) {
+      F *= q;
+      R /= q;
+    }
+  }
+  if (res == CERT_OK) {
+    if (F & 1)                      res = _vfail(vc, type, n, "F is even");
+    else if (gcd128(F, R) != 1)     res = _vfail(vc, type, n, "gcd(F, R) = 1");
+  }
+  if (res == CERT_OK) {
+    /* n < P = (F+1)(2F^2 + (r-1)F + 1) */
+    if (F >> 127) {                 /* 2F overflows, but R < 2 */
+      s = 0;  r = R;
+    } else {
+      s = R / (2*F);
+      r = R % (2*F);
+    }
+    if (!(F >> 43)) {
+      P = 2*F*F + r*F + 1 - F;
+      if (n / (F+1) >= P)           res = _vfail(vc, type, n, "n < P");
+    }
+  }
+  if (res == CERT_OK && s != 0 && (r >> 63))
+    res = CERT_DEFER;
+  if (res == CERT_OK && s != 0 && s <= (U128_MAX >> 3) && r*r >= 8*s) {
+    uint128_t t = r*r - 8*s, sq = isqrt128(t);
+    if (sq*sq == t)
+      res = _vfail(vc, type, n, "s=0 OR r^2-8s not a perfect square");
+  }
+  if (res == CERT_OK) {
+    mont128_init(&m, n);
+    for (i = 0; i < nq && res == CERT_OK; i++) {
+      uint128_t ma = mont128_to(A[i], &m);
+      if (mont128_pow(ma, nm1, &m) != m.one)
+        res = _vfail(vc, type, n, "A[i]^(N-1) mod N = 1");
+      else if (gcd128(submod128(mont128_from(mont128_pow(ma, nm1 / vc->qs[qstart+i], &m), &m), 1, n), n) != 1)
+        res = _vfail(vc, type, n, "gcd(A[i]^((N-1)/Q[i])-1, N) = 1");
+    }
+  }
+  Safefree(A);
+  return (res == CERT_OK) ? _vadd_part(vc, n, nq) : res;
+}
+
+/* Q[i] lines, i from 1, then A */
+static int _prove_lucas(vcert_t* vc)
+{
+  const char* type = "Lucas";
+  mont128_t m;
+  uint128_t n = 0, a = 0, nm1, F, R, val;
+  UV qstart = vc->nqs, nq, i, idx;
+  char* line;
+  char buf[64];
+  int haven = 0;
+
+  while (1) {
+    if ( (line = _vnext(vc)) == 0 )  return CERT_DEFER;
+    if (_vkeynum(line, "N", &val) == 1) {
+      if (haven)  return CERT_DEFER;
+      n = val;  haven = 1;
+    } else if (_vindexnum(line, 'Q', &idx, &val) == 1) {
+      if (idx != vc->nqs - qstart + 1)  return CERT_DEFER;
+      _vpush_q(vc, val);
+    } else if (_vkeynum(line, "A", &val) == 1) {
+      a = val;
+      break;
+    } else {
+      return CERT_DEFER;
+    }
+  }
+  if (!haven || n < 3 || !(n & 1))  return CERT_DEFER;
+  nq = vc->nqs - qstart;
+  if (a <= 1)                      VFAIL("A > 1");
+  if (a >= n)                      VFAIL("A < N");
+  nm1 = n-1;
+  F = 1;
+  R = nm1;
+  mont128_init(&m, n);
+  if (_vpowmod(a, nm1, &m) != 1)   VFAIL("A^(N-1) mod N = 1");
+  for (i = 0; i < nq; i++) {
+    uint128_t q = vc->qs[qstart+i];
+    buf[0] = '\0';
+    if      (q <= 1)          sprintf(buf, "Q[%lu] > 1", (unsigned long)i+1);
+    else if (q >= nm1)        sprintf(buf, "Q[%lu] < N-1", (unsigned long)i+1);
+    else if (nm1 % q != 0)    sprintf(buf, "Q[%lu] divides N-1", (unsigned long)i+1);
+    else if (_vpowmod(a, nm1/q, &m) == 1)
+      sprintf(buf, "A^((N-1)/Q[%lu]) mod N != 1", (unsigned long)i+1);
+    if (buf[0] != '\0')
+      VFAIL(buf);
+    while (R % q == 0) {
+      F *= q;
+      R /= q;
+    }
+  }
+  if (R != 1 || F != nm1)          VFAIL("N-1 has only factors Q");
+  return _vadd_part(vc, n, nq);
+}
+
+static int _vdispatch(vcert_t* vc, const char* type)
+{
+  if (!strcmp(type, "ECPP"))         return _prove_ecpp(vc);
+  if (!strcmp(type, "ECPP3"))        return _prove_ecpp3(vc);
+  if (!strcmp(type, "ECPP4"))        return _prove_ecpp4(vc);
+  if (!strcmp(type, "BLS15"))        return _prove_bls15(vc);
+  if (!strcmp(type, "BLS3"))         return _prove_bls3(vc);
+  if (!strcmp(type, "BLS5"))         return _prove_bls5(vc);
+  if (!strcmp(type, "SMALL"))        return _prove_small(vc);
+  if (!strcmp(type, "POCKLINGTON"))  return _prove_pock(vc);
+  if (!strcmp(type, "LUCAS"))        return _prove_lucas(vc);
+  return CERT_DEFER;
+}
+
+static int _verify_cert(vcert_t* vc)
+{
+  static const char* const names[] = {"N"};
+  static const char* const header = " - Primality Certificate]";
+  uint128_t N = 0, *queue;
+  UV head, tail, qalloc, i;
+  int haveN = 0, mpu = 0, neg, res;
+  char* line;
+
+  while ( (line = _vnext(vc)) != 0 ) {
+    if (line[0] == '[') {
+      size_t len;
+      for (len = 1; line[len] != '\0' && !isspace((unsigned char)line[len]); len++)
+        ;
+      if (len > 1 && strncmp(line+len, header, strlen(header)) == 0) {
+        if (len != 4 || strncmp(line+1, "MPU", 3) != 0)
+          return CERT_DEFER;
+        mpu = 1;
+        continue;
+      }
+    }
+    if (mpu && strncmp(line, "Proof for:", 10) == 0) {
+      if (haveN)  return CERT_DEFER;
+      if (_vread_vars(vc, names, 1, &N, &neg) != CERT_OK || neg)
+        return CERT_DEFER;
+      haveN = 1;
+      if (!u128_is_prob_prime(N)) {
+        if (vc->verbose) {
+          char nstr[40];
+          u128_to_str(N, nstr);
+          printf("primality fail: N '%s' does not look prime.\n", nstr);
+          fflush(stdout);
+        }
+        return CERT_FAIL;
+      }
+      continue;
+    }
+    if (strncmp(line, "Base ", 5) == 0 && isdigit((unsigned char)line[5])) {
+      if (strncmp(line+5, "10", 2) != 0 || isdigit((unsigned char)line[7]))
+        return CERT_DEFER;
+      continue;
+    }
+    if (strncmp(line, "Type ", 5) == 0) {
+      char type[16];
+      size_t len = strlen(line+5);
+      if (!haveN)  return CERT_DEFER;
+      while (len > 0 && isspace((unsigned char)line[5+len-1]))  len--;
+      if (len >= sizeof(type))  return CERT_DEFER;
+      for (i = 0; i < len; i++)
+        type[i] = toupper((unsigned char)line[5+i]);
+      type[len] = '\0';
+      res = _vdispatch(vc, type);
+      if (res != CERT_OK)  return res;
+    }
+  }
+  if (!haveN)  return CERT_DEFER;
+
+  /* Walk the chain:  every q must have its own step or be a small prime */
+  qalloc = 64;
+  New(0, queue, qalloc, uint128_t);
+  head = tail = 0;
+  queue[tail++] = N;
+  res = CERT_OK;
+  while (head < tail && res == CERT_OK) {
+    uint128_t q = queue[head++];
+    for (i = 0; i < vc->nparts; i++)
+      if (vc->parts[i].n == q)
+        break;
+    if (i == vc->nparts) {
+      if (q > UV_MAX || !is_prob_prime((UV)q)) {
+        if (vc->verbose) {
+          char nstr[40];
+          u128_to_str(q, nstr);
+          if (q > UV_MAX) printf("primality fail: q value %s has no proof\n", nstr);
+          else            printf("primality fail: Small n %s does not pass BPSW\n", nstr);
+          fflush(stdout);
+        }
+        res = CERT_FAIL;
+      }
+    } else {
+      vpart_t* p = vc->parts + i;
+      if (tail + p->nq > qalloc) {
+        qalloc = 2 * (tail + p->nq);
+        Renew(queue, qalloc, uint128_t);
+      }
+      memcpy(queue + tail, vc->qs + p->qstart, p->nq * sizeof(uint128_t));
+      tail += p->nq;
+    }
+  }
+  Safefree(queue);
+  return res;
+}
+
+int verify_cert_text(const char* cert)
+{
+  vcert_t vc;
+  char *text, *s;
+  UV alloc = 64;
+  int res;
+
+  New(0, text, strlen(cert)+1, char);
+  strcpy(text, cert);
+  New(0, vc.lines, alloc, char*);
+  vc.nlines = vc.pos = 0;
+  for (s = text; s != 0; ) {
+    if (vc.nlines >= alloc) {
+      alloc *= 2;
+      Renew(vc.lines, alloc, char*);
+    }
+    vc.lines[vc.nlines++] = s;
+    s = strchr(s, '\n');
+    if (s != 0)  *s++ = '\0';
+  }
+  vc.verbose = _XS_get_verbose();
+  vc.qs = 0;     vc.nqs = vc.qalloc = 0;
+  vc.parts = 0;  vc.nparts = vc.palloc = 0;
+
+  res = _verify_cert(&vc);
+
+  Safefree(vc.qs);
+  Safefree(vc.parts);
+  Safefree(vc.lines);
+  Safefree(text);
+  return res;
+}
+
+#else
+
+char* bls75_certificate(const char* nstr)
+{
+  return 0;
+}
+
+int verify_cert_text(const char* cert)
+{
+  return -1;
+}
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef MPU_CERT_H
+#define MPU_CERT_H
+
+#include "ptypes.h"
+
+/* A BLS75 n-1 certificate (MPU text format, without the header) for the
+ * decimal string n, 2^64 <= n < 2^128.  Returns NULL if n is out of range,
+ * not prime, or we could not factor enough of n-1.  Caller frees. */
+extern char* bls75_certificate(const char* nstr);
+
+/* Verify an MPU text certificate whose numbers are all below 2^128.
+ * Returns 1 if it proves N prime, 0 if a step fails (printing why when
+ * verbose), and -1 if it should be left to the Perl verifier. */
+extern int verify_cert_text(const char* cert);
+
+#endif
@@ -1,8 +1,7 @@
 #!/usr/bin/env perl
 use warnings;
 use strict;
-use Math::Prime::Util qw/euler_phi/;
+use Math::Prime::Util qw/totient_sum/;
 
-my $sum = 0;
-$sum += $_ for euler_phi(2,1000000);
-print "$sum\n";
+# Reduced fractions n/d with 0 < n < d <= 1000000
+print totient_sum(1000000) - 1, "\n";
@@ -1,13 +1,14 @@
 #!/usr/bin/env perl
 use warnings;
 use strict;
-use Math::Prime::Util qw/moebius mertens/;
+use Math::Prime::Util qw/moebius mertens squarefree_count/;
 
 my $lim = shift || 2**50;
 my $method = shift || 'mertens';
 
 # See http://arxiv.org/pdf/1107.4890v1.pdf
 
+#  0.0s  native
 #  2.9s  mertens
 #  9.8s  block
 # 10.0s  monolithic
@@ -16,7 +17,10 @@ my $method = shift || 'mertens';
 
 my $sum = 0;
 
-if ($method eq 'brute') {
+if ($method eq 'native') {
+  # The same method as 'mertens', in C with a table for Mertens
+  $sum = squarefree_count($lim);
+} elsif ($method eq 'brute') {
   # Far too slow
   for (1 .. $lim) { $sum++ if moebius($_) }
 } elsif ($method eq 'simple') {
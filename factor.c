@@ -9,11 +9,13 @@
 #include "mulmod.h"
 #include "cache.h"
 #include "primality.h"
+#include "montmath.h"
 #define FUNC_isqrt  1
 #define FUNC_icbrt  1
 #define FUNC_gcd_ui 1
 #define FUNC_is_perfect_square 1
 #define FUNC_clz 1
+#define FUNC_log2floor 1
 #include "util.h"
 
 /*
@@ -49,6 +51,61 @@ static const unsigned short primes_small[] =
    1949,1951,1973,1979,1987,1993,1997,1999,2003,2011};
 #define NPRIMES_SMALL (sizeof(primes_small)/sizeof(primes_small[0]))
 
+/* For each odd prime in primes_small, its inverse mod 2^BITS_PER_WORD and
+ * the largest multiple quotient.  n is divisible by p iff n*inv <= lim, and
+ * then n/p = n*inv exactly (Granlund and Montgomery 1994).  This replaces
+ * the hardware divides of trial division with multiplies.  The inverses
+ * are found by Newton's method, 3 correct bits doubling to 96, and all of
+ * it folds to constants at compile time. */
+#define INVSTEP(p,x)  ((x)*(2-(p)*(x)))
+#define INVUV(p)      INVSTEP(p,INVSTEP(p,INVSTEP(p,INVSTEP(p,INVSTEP(p,p)))))
+#define PINV(p)       { INVUV((UV)p), UV_MAX/(p) }
+static const struct { UV inv; UV lim; } primes_small_inv[] = {
+  {0,0},{0,0},PINV(3),PINV(5),PINV(7),PINV(11),PINV(13),PINV(17),PINV(19),PINV(23),PINV(29),PINV(31),PINV(37),
+  PINV(41),PINV(43),PINV(47),PINV(53),PINV(59),PINV(61),PINV(67),PINV(71),PINV(73),PINV(79),PINV(83),PINV(89),
+  PINV(97),PINV(101),PINV(103),PINV(107),PINV(109),PINV(113),PINV(127),PINV(131),PINV(137),PINV(139),PINV(149),
+  PINV(151),PINV(157),PINV(163),PINV(167),PINV(173),PINV(179),PINV(181),PINV(191),PINV(193),PINV(197),
+  PINV(199),PINV(211),PINV(223),PINV(227),PINV(229),PINV(233),PINV(239),PINV(241),PINV(251),PINV(257),
+  PINV(263),PINV(269),PINV(271),PINV(277),PINV(281),PINV(283),PINV(293),PINV(307),PINV(311),PINV(313),
+  PINV(317),PINV(331),PINV(337),PINV(347),PINV(349),PINV(353),PINV(359),PINV(367),PINV(373),PINV(379),
+  PINV(383),PINV(389),PINV(397),PINV(401),PINV(409),PINV(419),PINV(421),PINV(431),PINV(433),PINV(439),
+  PINV(443),PINV(449),PINV(457),PINV(461),PINV(463),PINV(467),PINV(479),PINV(487),PINV(491),PINV(499),
+  PINV(503),PINV(509),PINV(521),PINV(523),PINV(541),PINV(547),PINV(557),PINV(563),PINV(569),PINV(571),
+  PINV(577),PINV(587),PINV(593),PINV(599),PINV(601),PINV(607),PINV(613),PINV(617),PINV(619),PINV(631),
+  PINV(641),PINV(643),PINV(647),PINV(653),PINV(659),PINV(661),PINV(673),PINV(677),PINV(683),PINV(691),
+  PINV(701),PINV(709),PINV(719),PINV(727),PINV(733),PINV(739),PINV(743),PINV(751),PINV(757),PINV(761),
+  PINV(769),PINV(773),PINV(787),PINV(797),PINV(809),PINV(811),PINV(821),PINV(823),PINV(827),PINV(829),
+  PINV(839),PINV(853),PINV(857),PINV(859),PINV(863),PINV(877),PINV(881),PINV(883),PINV(887),PINV(907),
+  PINV(911),PINV(919),PINV(929),PINV(937),PINV(941),PINV(947),PINV(953),PINV(967),PINV(971),PINV(977),
+  PINV(983),PINV(991),PINV(997),PINV(1009),PINV(1013),PINV(1019),PINV(1021),PINV(1031),PINV(1033),
+  PINV(1039),PINV(1049),PINV(1051),PINV(1061),PINV(1063),PINV(1069),PINV(1087),PINV(1091),PINV(1093),
+  PINV(1097),PINV(1103),PINV(1109),PINV(1117),PINV(1123),PINV(1129),PINV(1151),PINV(1153),PINV(1163),
+  PINV(1171),PINV(1181),PINV(1187),PINV(1193),PINV(1201),PINV(1213),PINV(1217),PINV(1223),PINV(1229),
+  PINV(1231),PINV(1237),PINV(1249),PINV(1259),PINV(1277),PINV(1279),PINV(1283),PINV(1289),PINV(1291),
+  PINV(1297),PINV(1301),PINV(1303),PINV(1307),PINV(1319),PINV(1321),PINV(1327),PINV(1361),PINV(1367),
+  PINV(1373),PINV(1381),PINV(1399),PINV(1409),PINV(1423),PINV(1427),PINV(1429),PINV(1433),PINV(1439),
+  PINV(1447),PINV(1451),PINV(1453),PINV(1459),PINV(1471),PINV(1481),PINV(1483),PINV(1487),PINV(1489),
+  PINV(1493),PINV(1499),PINV(1511),PINV(1523),PINV(1531),PINV(1543),PINV(1549),PINV(1553),PINV(1559),
+  PINV(1567),PINV(1571),PINV(1579),PINV(1583),PINV(1597),PINV(1601),PINV(1607),PINV(1609),PINV(1613),
+  PINV(1619),PINV(1621),PINV(1627),PINV(1637),PINV(1657),PINV(1663),PINV(1667),PINV(1669),PINV(1693),
+  PINV(1697),PINV(1699),PINV(1709),PINV(1721),PINV(1723),PINV(1733),PINV(1741),PINV(1747),PINV(1753),
+  PINV(1759),PINV(1777),PINV(1783),PINV(1787),PINV(1789),PINV(1801),PINV(1811),PINV(1823),PINV(1831),
+  PINV(1847),PINV(1861),PINV(1867),PINV(1871),PINV(1873),PINV(1877),PINV(1879),PINV(1889),PINV(1901),
+  PINV(1907),PINV(1913),PINV(1931),PINV(1933),PINV(1949),PINV(1951),PINV(1973),PINV(1979),PINV(1987),
+  PINV(1993),PINV(1997),PINV(1999),PINV(2003),PINV(2011)};
+#undef PINV
+#define DIVIDES_SP(n, sp) \
+  ((UV)((n)*primes_small_inv[sp].inv) <= primes_small_inv[sp].lim)
+#define DIVIDE_SP(n, sp) \
+  ((n) *= primes_small_inv[sp].inv)
+
+/* Largest input for lehman_factor, keeping 4kn in range */
+#if BITS_PER_WORD == 64
+  #define LEHMAN_MAX  UVCONST(35184372088831)   /* 2^45-1 */
+#else
+  #define LEHMAN_MAX  UVCONST(4194303)          /* 2^22-1 */
+#endif
+
 
 /* The main factoring loop */
 /* Puts factors in factors[] and returns the number found. */
@@ -65,40 +122,32 @@ int factor(UV n, UV *factors)
 
   if (f*f <= n) {
     UV sp = 4, lastsp = 83;
-    /* Trial division from 7 to 421.  Use 32-bit if possible. */
-    if (n <= 4294967295U) {
-      unsigned int un = n;
-      while (sp < lastsp) {
-        while ( (un%f) == 0 ) {
-          factors[nfactors++] = f;
-          un /= f;
-        }
-        f = primes_small[++sp];
-        if (f*f > un) break;
-      }
-      n = un;
-    } else {
-      while (sp < lastsp) {
-        while ( (n%f) == 0 ) {
+    /* Trial division from 7 to 421, testing four primes at a time while
+     * none of them divide. */
+    while (sp < lastsp) {
+      if (sp+4 <= lastsp && !(DIVIDES_SP(n,sp)   | DIVIDES_SP(n,sp+1) |
+                              DIVIDES_SP(n,sp+2) | DIVIDES_SP(n,sp+3))) {
+        sp += 4;
+      } else {
+        while (DIVIDES_SP(n,sp)) {
           factors[nfactors++] = f;
-          n /= f;
+          DIVIDE_SP(n,sp);
         }
-        f = primes_small[++sp];
-        if (f*f > n) break;
+        sp++;
       }
+      f = primes_small[sp];
+      if (f*f > n) break;
     }
     /* If n is small and still composite, finish it here */
     if (n < 2011*2011 && f*f <= n) {  /* Trial division from 431 to 2003 */
-      unsigned int un = n;
       while (sp < NPRIMES_SMALL) {
-        while ( (un%f) == 0 ) {
+        while (DIVIDES_SP(n,sp)) {
           factors[nfactors++] = f;
-          un /= f;
+          DIVIDE_SP(n,sp);
         }
         f = primes_small[++sp];
-        if (f*f > un) break;
+        if (f*f > n) break;
       }
-      n = un;
     }
   }
   if (f*f > n) {
@@ -149,6 +198,16 @@ int factor(UV n, UV *factors)
                                             : (MULMODS_ARE_FAST ? 2000 : 2000);
       UV const sq_rounds = 200000; /* 20k 91%, 40k 98%, 80k 99.9%, 120k 99.99%*/
 
+#if BITS_PER_WORD == 64
+      /* Without fast mulmods, Pollard-Rho is 10x slower than SQUFOF for 33
+       * to 42 bit inputs.  Lehman finishes anything SQUFOF misses. */
+      if (!MULMODS_ARE_FAST && n > 4294967295U && n < UVCONST(4398046511104)) {
+        split_success = squfof_factor(n, tofac_stack+ntofac, sq_rounds)-1;
+        if (!split_success)
+          split_success = lehman_factor(n, tofac_stack+ntofac, 1)-1;
+        if (verbose) printf("squfof/lehman %d\n", split_success);
+      }
+#endif
       /* 99.7% of 32-bit, 94% of 64-bit random inputs factored here */
       if (!split_success) {
         split_success = pbrent_factor(n, tofac_stack+ntofac, br_rounds, 3)-1;
@@ -164,6 +223,11 @@ int factor(UV n, UV *factors)
         split_success = squfof_factor(n,tofac_stack+ntofac, sq_rounds)-1;
         if (verbose) printf("squfof %d\n", split_success);
       }
+      /* Lehman is guaranteed to work for inputs up to 45 bits. */
+      if (!split_success && n <= LEHMAN_MAX) {
+        split_success = lehman_factor(n, tofac_stack+ntofac, 1)-1;
+        if (verbose) printf("lehman %d\n", split_success);
+      }
       /* At this point we should only have 16+ digit semiprimes. */
       if (!split_success) {
         split_success = pminus1_factor(n, tofac_stack+ntofac, 8000, 120000)-1;
@@ -247,6 +311,156 @@ int factor_exp(UV n, UV *factors, UV* exponents)
   return j;
 }
 
+/* Factoring a range of consecutive integers.  Rather than calling factor()
+ * for each value, we sieve windows of the range with the odd primes up to
+ * sqrt(hi), recording the distinct primes dividing each entry.  Each value
+ * then comes out with a few divisions to find exponents, plus at most one
+ * large prime left over.  Memory use is bounded by the window size and the
+ * list of sieving primes. */
+
+#define FACTOR_RANGE_MIN_WINDOW 8192
+#define FACTOR_RANGE_MAX_WINDOW 65536
+
+typedef struct {
+  UV        lo;          /* next value to return */
+  UV        hi;          /* last value to return */
+  int       done;
+  UV        wlo;         /* current sieved window is [wlo, whi] */
+  UV        whi;
+  UV        wsize;       /* window size */
+  UV        nprimes;     /* Odd sieving primes.  0 means use factor() */
+  uint32_t *primes;
+  int       maxd;        /* Maximum distinct odd primes for any n <= hi */
+  UV       *prod;        /* Product of sieved primes dividing each entry */
+  unsigned char *nfac;   /* Number of sieved primes dividing each entry */
+  uint32_t *fac;         /* The primes, maxd slots per entry */
+} factor_range_t;
+
+static void _factor_range_sieve(factor_range_t* ctx)
+{
+  UV i, j, p, wsize;
+  int maxd = ctx->maxd;
+
+  ctx->wlo = ctx->lo;
+  ctx->whi = (ctx->hi - ctx->lo < ctx->wsize) ? ctx->hi
+                                              : ctx->lo + ctx->wsize - 1;
+  wsize = ctx->whi - ctx->wlo + 1;
+  for (i = 0; i < wsize; i++)  ctx->prod[i] = 1;
+  memset(ctx->nfac, 0, wsize);
+  for (j = 0; j < ctx->nprimes; j++) {
+    p = ctx->primes[j];
+    if (p > ctx->whi/p) break;
+    i = (ctx->wlo % p) ? p - (ctx->wlo % p) : 0;
+    if (ctx->wlo == 0) i = p;        /* Every p divides 0 */
+    for ( ; i < wsize; i += p) {
+      ctx->fac[i*maxd + ctx->nfac[i]++] = p;
+      ctx->prod[i] *= p;
+    }
+  }
+}
+
+void* start_factor_range(UV lo, UV hi)
+{
+  factor_range_t* ctx;
+  UV sqrthi, prod;
+  int maxd;
+
+  New(0, ctx, 1, factor_range_t);
+  ctx->lo = lo;
+  ctx->hi = hi;
+  ctx->done = (lo > hi);
+  ctx->nprimes = 0;
+  ctx->primes = 0;
+  if (ctx->done) return ctx;
+
+  /* Small or narrow ranges use factor() directly.  The sieve is a win once
+   * the range is wide enough to amortize generating the sieving primes,
+   * and we limit sqrt(hi) to keep the prime list under 16MB. */
+  sqrthi = isqrt(hi);
+  if (hi < 1000 || hi-lo < 200 || sqrthi > 67108864 || hi-lo < sqrthi/1000)
+    return ctx;
+
+  {
+    unsigned char* segment;
+    UV seg_base, seg_low, seg_high, maxprimes;
+    void* sctx;
+    maxprimes = 10 + (UV)(1.3 * (double)sqrthi / log(sqrthi));
+    New(0, ctx->primes, maxprimes, uint32_t);
+    ctx->primes[0] = 3;
+    ctx->primes[1] = 5;
+    ctx->nprimes = 2;
+    sctx = start_segment_primes(7, sqrthi, &segment);
+    while (next_segment_primes(sctx, &seg_base, &seg_low, &seg_high)) {
+      START_DO_FOR_EACH_SIEVE_PRIME( segment, seg_low - seg_base, seg_high - seg_base ) {
+        ctx->primes[ctx->nprimes++] = seg_base + p;
+      } END_DO_FOR_EACH_SIEVE_PRIME
+    }
+    end_segment_primes(sctx);
+  }
+
+  /* The most distinct odd primes any n <= hi can have */
+  for (maxd = 0, prod = 1; prod <= hi / ctx->primes[maxd]; maxd++)
+    prod *= ctx->primes[maxd];
+  ctx->maxd = (maxd < 1) ? 1 : maxd;
+
+  /* Larger windows mean fewer passes over the sieving primes. */
+  ctx->wsize = sqrthi/64;
+  if (ctx->wsize < FACTOR_RANGE_MIN_WINDOW) ctx->wsize = FACTOR_RANGE_MIN_WINDOW;
+  if (ctx->wsize > FACTOR_RANGE_MAX_WINDOW) ctx->wsize = FACTOR_RANGE_MAX_WINDOW;
+  if (ctx->wsize > hi-lo+1)                 ctx->wsize = hi-lo+1;
+  New(0, ctx->prod, ctx->wsize, UV);
+  New(0, ctx->nfac, ctx->wsize, unsigned char);
+  New(0, ctx->fac, ctx->wsize * ctx->maxd, uint32_t);
+  _factor_range_sieve(ctx);
+  return ctx;
+}
+
+int next_factor_range(void* vctx, UV *n, UV *factors)
+{
+  factor_range_t* ctx = (factor_range_t*) vctx;
+  UV v, i, p, cof;
+  int j, nfactors = 0;
+
+  if (ctx->done) return -1;
+  v = *n = ctx->lo;
+  if (v == ctx->hi)  ctx->done = 1;
+  else               ctx->lo++;
+
+  if (ctx->nprimes == 0)
+    return factor(v, factors);
+
+  i = v - ctx->wlo;
+  if (v < 4) {
+    if (v != 1) factors[nfactors++] = v;
+  } else {
+    cof = v;
+    while (!(cof & 1)) { factors[nfactors++] = 2;  cof >>= 1; }
+    cof /= ctx->prod[i];
+    for (j = 0; j < ctx->nfac[i]; j++) {
+      p = ctx->fac[i*ctx->maxd + j];
+      factors[nfactors++] = p;
+      while ( (cof % p) == 0 ) { factors[nfactors++] = p;  cof /= p; }
+    }
+    if (cof > 1)  factors[nfactors++] = cof;
+  }
+
+  if (v == ctx->whi && !ctx->done)
+    _factor_range_sieve(ctx);
+  return nfactors;
+}
+
+void end_factor_range(void* vctx)
+{
+  factor_range_t* ctx = (factor_range_t*) vctx;
+  if (ctx->primes != 0) {
+    Safefree(ctx->primes);
+    Safefree(ctx->prod);
+    Safefree(ctx->nfac);
+    Safefree(ctx->fac);
+  }
+  Safefree(ctx);
+}
+
 
 int trial_factor(UV n, UV *factors, UV maxtrial)
 {
@@ -269,9 +483,9 @@ int trial_factor(UV n, UV *factors, UV maxtrial)
     while (++sp < NPRIMES_SMALL) {
       f = primes_small[sp];
       if (f*f > n || f > maxtrial) break;
-      while ( (n%f) == 0 ) {
+      while (DIVIDES_SP(n,sp)) {
         factors[nfactors++] = f;
-        n /= f;
+        DIVIDE_SP(n,sp);
       }
     }
     /* Trial division using a mod-30 wheel for larger values */
@@ -354,6 +568,110 @@ UV* _divisor_list(UV n, UV *num_divisors)
   return divs;
 }
 
+/* Divisors one at a time in sorted order, without a full list.  Split the
+ * prime powers in two halves with about sqrt(d(n)) divisors each, then
+ * merge the products with a heap holding one entry per divisor of the
+ * smaller half. */
+typedef struct {
+  UV v, a, j;       /* v = A[a] * B[j] */
+} divheap_t;
+
+typedef struct {
+  UV *A, *B, nA, nB;
+  divheap_t* heap;
+  UV nheap;
+} divisor_iter_t;
+
+static UV* _half_divisors(int n, UV* fac, UV* exp, UV* num) {
+  UV i, ndiv = 1, *divs;
+  for (i = 0; i < (UV)n; i++)
+    ndiv *= exp[i] + 1;
+  New(0, divs, ndiv, UV);
+  if (n == 0) divs[0] = 1;
+  else        (void) _divisors_from_factors(1, n, fac, exp, divs);
+  qsort(divs, ndiv, sizeof(UV), numcmp);
+  *num = ndiv;
+  return divs;
+}
+
+void* start_divisors(UV n)
+{
+  divisor_iter_t* ctx;
+  UV fac[MPU_MAX_FACTORS+1], exp[MPU_MAX_FACTORS+1];
+  UV fa[MPU_MAX_FACTORS+1], ea[MPU_MAX_FACTORS+1], na = 1;
+  UV fb[MPU_MAX_FACTORS+1], eb[MPU_MAX_FACTORS+1], nb = 1;
+  UV a;
+  int i, nfactors, ia = 0, ib = 0;
+
+  Newz(0, ctx, 1, divisor_iter_t);
+  if (n <= 1) {   /* Same as _divisor_list: 0 gives 0,1 and 1 gives 1 */
+    New(0, ctx->A, 2, UV);
+    ctx->nA = (n == 0) ? 2 : 1;
+    ctx->A[0] = n;  ctx->A[1] = 1;
+    New(0, ctx->B, 1, UV);
+    ctx->nB = 1;  ctx->B[0] = 1;
+    New(0, ctx->heap, 2, divheap_t);
+    for (i = 0; i < (int)ctx->nA; i++) {
+      ctx->heap[i].v = ctx->A[i];  ctx->heap[i].a = i;  ctx->heap[i].j = 0;
+    }
+    ctx->nheap = ctx->nA;
+    return ctx;
+  }
+  nfactors = factor_exp(n, fac, exp);
+  /* Balance the divisor counts of the two halves */
+  for (i = nfactors-1; i >= 0; i--) {
+    if (na <= nb) { fa[ia] = fac[i]; ea[ia++] = exp[i]; na *= exp[i]+1; }
+    else          { fb[ib] = fac[i]; eb[ib++] = exp[i]; nb *= exp[i]+1; }
+  }
+  ctx->A = _half_divisors(ia, fa, ea, &ctx->nA);
+  ctx->B = _half_divisors(ib, fb, eb, &ctx->nB);
+  if (ctx->nA > ctx->nB) {
+    UV* t = ctx->A;  ctx->A = ctx->B;  ctx->B = t;
+    a = ctx->nA;  ctx->nA = ctx->nB;  ctx->nB = a;
+  }
+  /* A is sorted and B[0] = 1, so the initial heap is already ordered */
+  New(0, ctx->heap, ctx->nA, divheap_t);
+  for (a = 0; a < ctx->nA; a++) {
+    ctx->heap[a].v = ctx->A[a];
+    ctx->heap[a].a = a;
+    ctx->heap[a].j = 0;
+  }
+  ctx->nheap = ctx->nA;
+  return ctx;
+}
+
+int next_divisor(void* vctx, UV *d)
+{
+  divisor_iter_t* ctx = (divisor_iter_t*) vctx;
+  divheap_t* h = ctx->heap;
+  divheap_t top;
+  UV i, c, nheap = ctx->nheap;
+
+  if (nheap == 0) return 0;
+  *d = h[0].v;
+  /* Replace the top with its next product, or drop it, then sift down */
+  top = h[0];
+  if (++top.j < ctx->nB) top.v = ctx->A[top.a] * ctx->B[top.j];
+  else                   top = h[--nheap];
+  for (i = 0; (c = 2*i+1) < nheap; i = c) {
+    if (c+1 < nheap && h[c+1].v < h[c].v) c++;
+    if (top.v <= h[c].v) break;
+    h[i] = h[c];
+  }
+  if (nheap > 0) h[i] = top;
+  ctx->nheap = nheap;
+  return 1;
+}
+
+void end_divisors(void* vctx)
+{
+  divisor_iter_t* ctx = (divisor_iter_t*) vctx;
+  if (ctx->A != 0)    Safefree(ctx->A);
+  if (ctx->B != 0)    Safefree(ctx->B);
+  if (ctx->heap != 0) Safefree(ctx->heap);
+  Safefree(ctx);
+}
+
 
 /* The usual method, on OEIS for instance, is:
  *    (p^(k*(e+1))-1) / (p^k-1)
@@ -499,9 +817,129 @@ int holf_factor(UV n, UV *factors, UV rounds)
 }
 
 
+/* Lehman's method (1974).  If n has no factors below n^(1/3), then there
+ * is a k <= n^(1/3) and an a with sqrt(4kn) <= a <= sqrt(4kn)+n^(1/6)/(4k^.5)
+ * such that a^2-4kn is a perfect square b^2, and gcd(a+b,n) is a factor.
+ * Parity restricts a:  a is odd for even k, and a = k+n mod 4 for odd k.
+ * Without the trial division it is a heuristic that still splits most
+ * inputs with two similar sized factors very quickly. */
+int lehman_factor(UV n, UV *factors, int do_trial)
+{
+  UV k, a, amax, b2, kn4, cbrtn;
+  double n16, sqrt4n;
+  int pass;
+
+  MPUassert( (n >= 3) && ((n%2) != 0) , "bad n in lehman_factor");
+  if (n > LEHMAN_MAX) { factors[0] = n; return 1; }
+
+  cbrtn = icbrt(n);
+  if (cbrtn*cbrtn*cbrtn < n) cbrtn++;
+  if (do_trial) {
+    UV f, sp;
+    for (sp = 2; sp < NPRIMES_SMALL; sp++) {
+      f = primes_small[sp];
+      if (f > cbrtn) break;
+      if ( (n%f) == 0 ) return found_factor(n, f, factors);
+    }
+    if (f <= cbrtn) {
+      UV m = f % 30;
+      for (f += wheeladvance30[m], m = nextwheel30[m];  f <= cbrtn;
+           f += wheeladvance30[m], m = nextwheel30[m])
+        if ( (n%f) == 0 ) return found_factor(n, f, factors);
+    }
+  }
+
+  n16 = pow((double)n, 1.0/6.0) / 4.0;
+  sqrt4n = 2.0 * sqrt((double)n);
+  /* Multiples of 6 find most balanced factors fastest, so do them first. */
+  for (pass = 0; pass < 2; pass++) {
+    UV kstart = (pass == 0) ? 6 : 1,  kinc = (pass == 0) ? 6 : 1;
+    for (k = kstart; k <= cbrtn; k += kinc) {
+      UV inc, r;
+      double sqrtk;
+      if (pass == 1 && (k % 6) == 0) continue;
+      inc = (k & 1) ? 4 : 2;
+      r   = (k & 1) ? (k+n) % 4 : 1;
+      sqrtk = sqrt((double)k);
+      kn4 = 4*k*n;
+      a = (UV) (sqrt4n * sqrtk);
+      while (a*a < kn4) a++;
+      amax = (UV) (sqrt4n * sqrtk + n16/sqrtk);
+      a += (r + inc - (a % inc)) % inc;
+      for (b2 = a*a - kn4;  a <= amax;  b2 += inc*(2*a+inc), a += inc) {
+        if (is_perfect_square(b2)) {
+          UV f = gcd_ui(a + isqrt(b2), n);
+          if (f > 1 && f < n)
+            return found_factor(n, f, factors);
+        }
+      }
+    }
+  }
+  factors[0] = n;
+  return 1;
+}
+
+#if USE_MONT_PRIMALITY
+/* Brent's Rho in Montgomery form, which replaces the two divides per step
+ * with multiplies.  Differences and the product are also in Montgomery form,
+ * which doesn't change their gcd with n.  The constant a becomes a*2^64. */
+static int pbrent_factor_mont(UV n, UV *factors, UV rounds, UV a)
+{
+  const uint64_t npi = modular_inverse64(n);
+  const uint64_t mont1 = compute_modn64(n);
+  const uint64_t c = compute_a_times_2_64_mod_n(a % n, n, mont1);
+  const UV inner = (n <= 4000000000UL) ? 32 : 160;
+  uint64_t f, m, r = 1;
+  uint64_t Xi = addmod(mont1, mont1, n);   /* 2 */
+  uint64_t Xm = Xi;
+
+  while (rounds > 0) {
+    UV rleft = (r > rounds) ? rounds : r;
+    uint64_t saveXi;
+    /* Do rleft rounds, inner at a time */
+    while (rleft > 0) {
+      UV dorounds = (rleft > inner) ? inner : rleft;
+      saveXi = Xi;
+      rleft -= dorounds;
+      rounds -= dorounds;
+      Xi = addmod(mont_square64(Xi, n, npi), c, n);
+      m = (Xi>Xm) ? Xi-Xm : Xm-Xi;
+      while (--dorounds > 0) {
+        Xi = addmod(mont_square64(Xi, n, npi), c, n);
+        f = (Xi>Xm) ? Xi-Xm : Xm-Xi;
+        m = mont_prod64(m, f, n, npi);
+      }
+      f = gcd_ui(m, n);
+      if (f != 1)
+        break;
+    }
+    /* If f == 1, then we didn't find a factor.  Move on. */
+    if (f == 1) {
+      r *= 2;
+      Xm = Xi;
+      continue;
+    }
+    if (f == n) {  /* back up, with safety */
+      Xi = saveXi;
+      do {
+        Xi = addmod(mont_square64(Xi, n, npi), c, n);
+        f = gcd_ui( (Xi>Xm) ? Xi-Xm : Xm-Xi, n);
+      } while (f == 1 && r-- != 0);
+    }
+    return found_factor(n, f, factors);
+  }
+  factors[0] = n;
+  return 1;
+}
+#endif
+
 /* Pollard / Brent.  Brent's modifications to Pollard's Rho.  Maybe faster. */
 int pbrent_factor(UV n, UV *factors, UV rounds, UV a)
 {
+#if USE_MONT_PRIMALITY
+  MPUassert( (n >= 3) && ((n%2) != 0) , "bad n in pbrent_factor");
+  return pbrent_factor_mont(n, factors, rounds, a);
+#else
   UV f, m, r;
   UV Xi = 2;
   UV Xm = 2;
@@ -547,6 +985,7 @@ int pbrent_factor(UV n, UV *factors, UV rounds, UV a)
   }
   factors[0] = n;
   return 1;
+#endif
 }
 
 /* Pollard's Rho. */
@@ -1164,9 +1603,382 @@ UV dlp_bsgs(UV a, UV g, UV p, UV n, UV maxent) {
   return result;
 }
 
-/* Find smallest k where a = g^k mod p */
+/******************************************************************************/
+/* DLP - Rho with distinguished points, and Kangaroo */
+/******************************************************************************/
+
 #define DLP_TRIAL_NUM  10000
 #define DLP_RHO_NUM    40000
+#ifndef DLP_IC_MIN
+#define DLP_IC_MIN     UVCONST(4294967296)
+#endif
+
+#define DLP_WALK_BITS  5
+#define DLP_WALK_NMULT (1 << DLP_WALK_BITS)
+#if BITS_PER_WORD == 64
+  #define DLP_HASH(x)  ((x) * UVCONST(11400714819323198485))
+#else
+  #define DLP_HASH(x)  ((x) * UVCONST(2654435769))
+#endif
+#define DLP_HASH_TOP(h,bits)  ((h) >> (BITS_PER_WORD-(bits)))
+
+static UV _dlp_rand(UV* state, UV n) {
+  UV x = *state;
+#if BITS_PER_WORD == 64
+  x ^= x << 13;  x ^= x >> 7;  x ^= x << 17;
+#else
+  x ^= x << 13;  x ^= x >> 17;  x ^= x << 5;
+#endif
+  *state = x;
+  return x % n;
+}
+
+/* Find k where a = g^k mod p, with g of prime order n.  Teske's r-adding
+ * walk costs one mulmod per step and behaves like a random map, unlike the
+ * 3-way walk of dlp_prho.  Only distinguished points (about 1 in 2^dpbits)
+ * are stored, so memory stays small.  Walks could run in parallel sharing
+ * the point table; here they run one after another. */
+UV dlp_prho_dp(UV a, UV g, UV p, UV n, UV maxrounds) {
+  UV M[DLP_WALK_NMULT], S[DLP_WALK_NMULT], T[DLP_WALK_NMULT];
+  UV *dpu = 0, *dpv = 0;
+  UV i, j, x, u, v, dpmask, walklen, rounds, seed, ndp = 0, maxdp = 0, k = 0;
+  int dpbits;
+  bsgs_page_top_t DP;
+#ifdef DEBUG
+  int const verbose = _XS_get_verbose();
+#else
+  int const verbose = 0;
+#endif
+
+  if (a == 1 || n < 2) return 0;
+  if (maxrounds == 0) maxrounds = UV_MAX;
+
+  dpbits = (int)log2floor(n)/2 - 6;
+  if (dpbits < 0) dpbits = 0;
+  dpmask = (UVCONST(1) << dpbits) - 1;
+  /* A walk that finds no distinguished point in this long is in a cycle */
+  walklen = UVCONST(32) << dpbits;
+
+  seed = (a ^ UVCONST(2463534242)) | 1;
+  for (j = 0; j < DLP_WALK_NMULT; j++) {
+    S[j] = _dlp_rand(&seed, n);
+    T[j] = _dlp_rand(&seed, n);
+    M[j] = mulmod(powmod(g, S[j], p), powmod(a, T[j], p), p);
+  }
+
+  DP.size = 1021;
+  DP.first = 0;
+  DP.nused = 0;
+  DP.npages = 0;
+  Newz(0, DP.table, DP.size, bsgs_hash_t*);
+
+  for (rounds = 0; rounds < maxrounds && k == 0; ) {
+    /* Start a new walk at a random point g^u a^v */
+    u = _dlp_rand(&seed, n);
+    v = _dlp_rand(&seed, n);
+    x = mulmod(powmod(g, u, p), powmod(a, v, p), p);
+    for (i = 0; i < walklen && rounds < maxrounds; i++, rounds++) {
+      UV h = DLP_HASH(x);
+      if ((h & dpmask) == 0) {
+        UV idx = bsgs_hash_get(&DP, x);
+        if (idx == 0) {
+          if (ndp >= maxdp) {
+            maxdp = 2*maxdp + 256;
+            Renew(dpu, maxdp, UV);
+            Renew(dpv, maxdp, UV);
+          }
+          dpu[ndp] = u;
+          dpv[ndp] = v;
+          bsgs_hash_put(&DP, x, ++ndp);
+          i = 0;
+        } else {
+          /* g^u a^v = g^u' a^v'  gives  k = (u'-u)/(v-v') mod n */
+          UV du = submod(dpu[idx-1], u, n), dv = submod(v, dpv[idx-1], n);
+          if (dv != 0) {
+            k = divmod(du, dv, n);
+            if (powmod(g, k, p) != a) k = 0;
+          }
+          break;   /* Success, or a useless collision needing a new walk */
+        }
+      }
+      j = DLP_HASH_TOP(h, DLP_WALK_BITS);
+      x = mulmod(x, M[j], p);
+      u = addmod(u, S[j], n);
+      v = addmod(v, T[j], n);
+    }
+  }
+  if (verbose) printf("  dlp rho dp: %s after %"UVuf" steps, %"UVuf" points\n", k ? "solution" : "failure", rounds, ndp);
+  destroy_pages(&DP);
+  Safefree(DP.table);
+  Safefree(dpu);
+  Safefree(dpv);
+  return k;
+}
+
+/* Find k in [0,b) where a = g^k mod p.  Pollard's kangaroo method: a tame
+ * kangaroo hops from g^b leaving a trap, then a wild one from a follows
+ * with the same jumps until it lands in the trap or passes it.  About
+ * 4*sqrt(b) mulmods and constant memory.  The result may be k plus a
+ * multiple of the order of g. */
+UV dlp_kangaroo(UV a, UV g, UV p, UV b) {
+  UV J[BITS_PER_WORD], D[BITS_PER_WORD];
+  UV i, j, nj, sqrtb, xt, dt, xw, dw;
+  int salt;
+
+  if (a == 1 || b < 2) return 0;
+  if (b > UV_MAX/4) b = UV_MAX/4;
+  sqrtb = isqrt(b);
+  /* Jumps are powers of 2 with mean about sqrt(b)/2 */
+  for (nj = 1; nj < BITS_PER_WORD-2 && ((UVCONST(1) << nj) - 1) / nj < sqrtb/2; nj++)
+    ;
+  for (i = 0; i < nj; i++) {
+    D[i] = UVCONST(1) << i;
+    J[i] = powmod(g, D[i], p);
+  }
+  /* Each attempt uses a different jump function */
+  for (salt = 0; salt < 4; salt++) {
+    xt = powmod(g, b, p);
+    for (dt = 0, i = 0; i < 2*sqrtb; i++) {
+      j = DLP_HASH_TOP(DLP_HASH(xt+salt), 6) % nj;
+      xt = mulmod(xt, J[j], p);
+      dt += D[j];
+    }
+    for (xw = a, dw = 0; dw <= b + dt; ) {
+      if (xw == xt) {
+        UV k = b + dt - dw;
+        if (powmod(g, k, p) == a) return k;
+        break;
+      }
+      j = DLP_HASH_TOP(DLP_HASH(xw+salt), 6) % nj;
+      xw = mulmod(xw, J[j], p);
+      dw += D[j];
+    }
+  }
+  return 0;
+}
+
+/******************************************************************************/
+/* DLP - Index calculus */
+/******************************************************************************/
+
+/* Logs in the subgroup of prime order q, where q exactly divides p-1 and p
+ * is prime.  Values g^k are written as r/t mod p with |r|,|t| < sqrt(p) by
+ * rational reconstruction, and kept when both are smooth over the primes
+ * in primes_small up to B.  With L() the log to any primitive root, the
+ * unknowns are x_l = L(l)/L(g) mod q, which is well defined as q does not
+ * divide L(g).  L(-1) = (p-1)/2 is 0 mod q, so signs are dropped. */
+struct dlp_ic_t {
+  UV g, p, q;
+  int nfb;                  /* factor base is primes_small[1..nfb] */
+  UV B;
+  UV maxtries;              /* give up on a smooth pair after this many */
+  UV* logs;                 /* x_l mod q, UV_MAX if unknown */
+  unsigned short* col;      /* prime -> index in logs, for primes <= B */
+};
+
+/* Find |r|,|t| < sqrt(p) with y = r/t mod p */
+static void _rat_recon(UV y, UV p, UV sqrtp, UV* r, UV* t) {
+  UV r0 = p, r1 = y;
+  IV t0 = 0, t1 = 1;
+  while (r1 > sqrtp) {
+    UV qt = r0 / r1, rt = r0 - qt*r1;
+    IV tt = t0 - (IV)qt*t1;
+    r0 = r1;  r1 = rt;
+    t0 = t1;  t1 = tt;
+  }
+  *r = r1;
+  *t = (t1 < 0) ? (UV)(-t1) : (UV)t1;
+}
+
+/* Add the exponents of n's factors (times sign) to row.  0 if not smooth. */
+static int _ic_smooth(const dlp_ic_t* ic, UV n, UV* row, int sign) {
+  UV f[MPU_MAX_FACTORS+1];
+  int i, nf;
+  if (n == 0) return 0;
+  nf = trial_factor(n, f, ic->B);
+  if (nf > 0 && f[nf-1] > ic->B) return 0;
+  if (row != 0)
+    for (i = 0; i < nf; i++) {
+      UV* e = row + ic->col[f[i]];
+      *e = (sign > 0) ? addmod(*e, 1, ic->q) : submod(*e, 1, ic->q);
+    }
+  return 1;
+}
+
+/* Sum x_l over n's factors, or UV_MAX if any are unknown */
+static UV _ic_logsum(const dlp_ic_t* ic, UV n) {
+  UV f[MPU_MAX_FACTORS+1], sum = 0;
+  int i, nf = trial_factor(n, f, ic->B);
+  for (i = 0; i < nf; i++) {
+    if (f[i] <= 1) continue;
+    if (ic->logs[ic->col[f[i]]] == UV_MAX) return UV_MAX;
+    sum = addmod(sum, ic->logs[ic->col[f[i]]], ic->q);
+  }
+  return sum;
+}
+
+dlp_ic_t* dlp_ic_new(UV g, UV p, UV q) {
+  dlp_ic_t* ic;
+  UV *M, *rhs, *nz;
+  UV i, j, c, r, k, c0, gc, gk, sqrtp, tries, nrel, maxrel, rank;
+  int bbits, nfb;
+  UV seed = (g ^ UVCONST(2463534242)) | 1;
+  int const verbose = _XS_get_verbose();
+
+  if (p < 1000 || q < 3 || (p-1) % q != 0 || ((p-1)/q) % q == 0) return 0;
+  if (!is_prob_prime(p)) return 0;
+
+  /* Make r and t about 2.9 times the digits of B */
+  bbits = (log2floor(p)+1) * 10 / 58;
+  if (bbits < 6) bbits = 6;
+  Newz(0, ic, 1, dlp_ic_t);
+  ic->g = g;  ic->p = p;  ic->q = q;
+  ic->B = (bbits >= 11) ? 2011 : (UVCONST(1) << bbits);
+  for (nfb = 0; nfb+1 < (int)NPRIMES_SMALL && primes_small[nfb+1] <= ic->B; nfb++)
+    ;
+  ic->nfb = nfb;
+  New(0, ic->logs, nfb, UV);
+  Newz(0, ic->col, ic->B+1, unsigned short);
+  for (i = 0; i < (UV)nfb; i++)
+    ic->col[primes_small[i+1]] = i;
+
+  /* 1. Collect relations g^k = r/t with k stepping by a random c */
+  maxrel = nfb + 20;
+  Newz(0, M, maxrel * nfb, UV);
+  New(0, rhs, maxrel, UV);
+  New(0, nz, nfb, UV);
+  sqrtp = isqrt(p);
+  /* Dickman's rho(u) is near u^-u for the u here (2 to 3), so about one
+   * pair in u^2u is smooth.  Allow 20 times that per relation, and hand
+   * back to Rho if we can't get them all. */
+  {
+    double u = log((double)sqrtp) / log((double)ic->B);
+    ic->maxtries = 20 * ((u <= 1) ? 1 : (UV)pow(u, 2*u) + 1);
+  }
+  c0 = 1 + _dlp_rand(&seed, q-1);
+  gc = powmod(g, c0, p);
+  k = 1 + _dlp_rand(&seed, q-1);
+  gk = powmod(g, k, p);
+  for (nrel = 0, tries = 0; nrel < maxrel && tries < maxrel*ic->maxtries; tries++) {
+    UV rr, tt;
+    gk = mulmod(gk, gc, p);
+    k = addmod(k, c0, q);
+    _rat_recon(gk, p, sqrtp, &rr, &tt);
+    if (!_ic_smooth(ic, rr, 0, 0) || !_ic_smooth(ic, tt, 0, 0)) continue;
+    _ic_smooth(ic, rr, M + nrel*nfb,  1);
+    _ic_smooth(ic, tt, M + nrel*nfb, -1);
+    rhs[nrel++] = k;
+  }
+  if (verbose) printf("  dlp ic: B=%"UVuf", %"UVuf" relations from %"UVuf" tries\n", ic->B, nrel, tries);
+  if (nrel < maxrel) {
+    Safefree(nz);  Safefree(rhs);  Safefree(M);
+    dlp_ic_free(ic);
+    return 0;
+  }
+
+  /* 2. Gauss-Jordan elimination mod q */
+  for (i = 0; i < (UV)nfb; i++)  ic->logs[i] = UV_MAX;
+  for (c = 0, rank = 0; c < (UV)nfb && rank < nrel; c++) {
+    UV *prow, inv, nnz = 0;
+    for (r = rank; r < nrel && M[r*nfb+c] == 0; r++)
+      ;
+    if (r == nrel) continue;    /* c is a free column */
+    if (r != rank) {
+      for (j = 0; j < (UV)nfb; j++)
+        { UV t = M[r*nfb+j]; M[r*nfb+j] = M[rank*nfb+j]; M[rank*nfb+j] = t; }
+      { UV t = rhs[r]; rhs[r] = rhs[rank]; rhs[rank] = t; }
+    }
+    prow = M + rank*nfb;
+    inv = modinverse(prow[c], q);
+    for (j = 0; j < (UV)nfb; j++)
+      if (prow[j]) { prow[j] = mulmod(prow[j], inv, q); nz[nnz++] = j; }
+    rhs[rank] = mulmod(rhs[rank], inv, q);
+    for (r = 0; r < nrel; r++) {
+      UV f, *row = M + r*nfb;
+      if (r == rank || row[c] == 0) continue;
+      f = row[c];
+      for (j = 0; j < nnz; j++)
+        row[nz[j]] = submod(row[nz[j]], mulmod(f, prow[nz[j]], q), q);
+      rhs[r] = submod(rhs[r], mulmod(f, rhs[rank], q), q);
+    }
+    rank++;
+  }
+  /* A pivot row gives its log unless free columns remain in it */
+  for (r = 0; r < rank; r++) {
+    UV *row = M + r*nfb, pc = UV_MAX, others = 0;
+    for (j = 0; j < (UV)nfb; j++)
+      if (row[j]) { if (pc == UV_MAX) pc = j; else others++; }
+    if (pc != UV_MAX && others == 0)
+      ic->logs[pc] = rhs[r];
+  }
+  if (verbose) printf("  dlp ic: rank %"UVuf" of %d\n", rank, nfb);
+  Safefree(nz);
+  Safefree(rhs);
+  Safefree(M);
+  return ic;
+}
+
+/* Returns 1 and sets k where a = g^k mod p, or 0 on failure */
+int dlp_ic_solve(const dlp_ic_t* ic, UV a, UV* k) {
+  UV i, c0, gc, sqrtp, p = ic->p, q = ic->q, seed = (a ^ UVCONST(2463534242)) | 1;
+  UV y, e;
+
+  if (a == 1) { *k = 0; return 1; }
+  sqrtp = isqrt(p);
+  c0 = 1 + _dlp_rand(&seed, q-1);
+  gc = powmod(ic->g, c0, p);
+  /* Find e with a*g^e = r/t, both smooth with known logs */
+  for (i = 0, e = 0, y = a; i < ic->maxtries; i++) {
+    UV rr, tt, lr, lt;
+    _rat_recon(y, p, sqrtp, &rr, &tt);
+    if (_ic_smooth(ic, rr, 0, 0) && _ic_smooth(ic, tt, 0, 0)) {
+      lr = _ic_logsum(ic, rr);
+      lt = _ic_logsum(ic, tt);
+      if (lr != UV_MAX && lt != UV_MAX) {
+        *k = submod(submod(lr, lt, q), e, q);
+        if (powmod(ic->g, *k, p) == a) return 1;
+      }
+    }
+    y = mulmod(y, gc, p);
+    e = addmod(e, c0, q);
+  }
+  return 0;
+}
+
+void dlp_ic_free(dlp_ic_t* ic) {
+  if (ic == 0) return;
+  Safefree(ic->logs);
+  Safefree(ic->col);
+  Safefree(ic);
+}
+
+/* Find k where a = g^k mod p, with g of prime order q. */
+static UV _dlp_prime_order(UV a, UV g, UV p, UV q, int* ok) {
+  UV k = 0;
+  *ok = 1;
+  if (a == 1) return 0;
+  if (q <= DLP_TRIAL_NUM) {
+    k = dlp_trial(a, g, p, q);
+  } else if (q <= UVCONST(4294967296)) {
+    k = dlp_bsgs(a, g, p, q, isqrt(q)+1);
+  } else {
+    dlp_ic_t* ic = (q >= DLP_IC_MIN) ? dlp_ic_new(g, p, q) : 0;
+    if (ic != 0) {
+      if (!dlp_ic_solve(ic, a, &k)) k = 0;
+      dlp_ic_free(ic);
+    }
+    if (k == 0)
+      k = dlp_prho_dp(a, g, p, q, 64*isqrt(q));
+    if (k == 0) {
+      k = dlp_kangaroo(a, g, p, q);
+      if (k >= q) k %= q;
+    }
+  }
+  if (k == 0) *ok = 0;
+  return k;
+}
+
+/* Find smallest k where a = g^k mod p */
 UV znlog_solve(UV a, UV g, UV p) {
   UV i, k, n, sqrtn;
   const int verbose = _XS_get_verbose();
@@ -1225,28 +2037,37 @@ UV znlog_solve(UV a, UV g, UV p) {
   return k;
 }
 
-/* Silver-Pohlig-Hellman */
+/* Silver-Pohlig-Hellman.  Each q^e part is lifted one base q digit at a
+ * time, so every discrete log solved is in a subgroup of prime order q. */
 UV znlog_ph(UV a, UV g, UV p) {
   UV fac[MPU_MAX_FACTORS+1];
   UV exp[MPU_MAX_FACTORS+1];
-  int i, nfactors;
+  int i, ok, nfactors;
   UV x, j, p1 = znorder(g,p);
 
   if (p1 == 0) return 0;   /* TODO: Should we plow on with p1=p-1? */
+  if (powmod(a, p1, p) != 1) return 0;
   nfactors = factor_exp(p1, fac, exp);
-  if (nfactors == 1)
-    return znlog_solve(a, g, p);
   for (i = 0; i < nfactors; i++) {
-    UV pi, delta, gamma;
+    UV pi, gi, ai, giinv, gq, xi = 0, qj = 1;
     pi = fac[i];   for (j = 1; j < exp[i]; j++)  pi *= fac[i];
-    delta = powmod(a,p1/pi,p);
-    gamma = powmod(g,p1/pi,p);
-    /* printf(" solving znlog(%lu,%lu,%lu)\n", delta, gamma, p); */
-    fac[i] = znlog_solve( delta, gamma, p );
+    gi = powmod(g, p1/pi, p);
+    ai = powmod(a, p1/pi, p);
+    giinv = modinverse(gi, p);
+    gq = powmod(gi, pi/fac[i], p);
+    for (j = 0; j < exp[i]; j++) {
+      UV d, h = mulmod(ai, powmod(giinv, xi, p), p);
+      h = powmod(h, pi / (qj * fac[i]), p);
+      d = _dlp_prime_order(h, gq, p, fac[i], &ok);
+      if (!ok) return 0;
+      xi += d * qj;
+      qj *= fac[i];
+    }
+    fac[i] = xi;
     exp[i] = pi;
   }
-  x = chinese(fac, exp, nfactors, &i);
-  if (i == 1 && powmod(g, x, p) == a)
+  x = (nfactors == 0) ? 0 : chinese(fac, exp, nfactors, &i);
+  if ((nfactors == 0 || i == 1) && powmod(g, x, p) == a)
     return x;
   return 0;
 }
@@ -1272,6 +2093,148 @@ UV znlog(UV a, UV g, UV p) {
   return znlog_solve(a, g, p);
 }
 
+/******************************************************************************/
+/* DLP - reusable context for many targets with a fixed g and p */
+/******************************************************************************/
+
+/* The order n of g is factored once.  For each prime q^e dividing n we keep
+ * a baby step table of gq^j where gq = g^(n/q) has order q, so each target
+ * costs e searches of about q/m giant steps per prime plus a CRT. */
+typedef struct {
+  UV q, e, qe;     /* q^e exactly divides the order */
+  UV gq;           /* g^(n/q), of order q */
+  UV gqinvm;       /* gq^-m */
+  UV giinv;        /* g^-(n/q^e) */
+  UV m;            /* number of baby steps stored */
+  bsgs_page_top_t pages;
+  dlp_ic_t* ic;    /* index calculus, used instead of a table if possible */
+} znlog_ctx_prime_t;
+
+struct znlog_ctx_t {
+  UV g, p, n;
+  int nfactors;
+  znlog_ctx_prime_t pf[MPU_MAX_FACTORS+1];
+};
+
+znlog_ctx_t* znlog_ctx_new(UV g, UV p, UV maxent) {
+  znlog_ctx_t* ctx;
+  UV fac[MPU_MAX_FACTORS+1];
+  UV exp[MPU_MAX_FACTORS+1];
+  int i;
+
+  Newz(0, ctx, 1, znlog_ctx_t);
+  if (p >= 2 && g >= p) g %= p;
+  ctx->g = g;
+  ctx->p = p;
+  ctx->n = (p < 2 || g == 0) ? 0 : znorder(g, p);
+  if (ctx->n == 0) return ctx;   /* Solves will use znlog */
+  if (maxent == 0) maxent = 1;
+
+  /* Primes are in ascending order.  Each takes up to an even share of what
+   * is left, so the largest primes get the leftover budget.  Tables larger
+   * than sqrt(q) are intended: every extra baby step removes giant steps
+   * from each later solve.  Large primes use index calculus if they can. */
+  ctx->nfactors = factor_exp(ctx->n, fac, exp);
+  for (i = 0; i < ctx->nfactors; i++) {
+    znlog_ctx_prime_t* pf = ctx->pf + i;
+    UV j, S, hashmap_count, share = maxent / (ctx->nfactors - i);
+    UV m = fac[i];
+
+    pf->q = fac[i];
+    pf->e = exp[i];
+    for (pf->qe = pf->q, j = 1; j < pf->e; j++)  pf->qe *= pf->q;
+    pf->gq = powmod(g, ctx->n / pf->q, p);
+    pf->giinv = modinverse(powmod(g, ctx->n / pf->qe, p), p);
+    pf->ic = (pf->q >= DLP_IC_MIN) ? dlp_ic_new(pf->gq, p, pf->q) : 0;
+
+    if (pf->ic != 0) m = 1;
+    if (m > share) m = share;
+    if (m < 1)     m = 1;
+    maxent = (maxent > m) ? maxent - m : 0;
+    pf->m = m;
+
+    hashmap_count = next_prime( m / 2 );
+    if (hashmap_count < 17) hashmap_count = 17;
+    pf->pages.size = hashmap_count;
+    Newz(0, pf->pages.table, hashmap_count, bsgs_hash_t*);
+    /* Store j+1 so a miss (0) is distinguishable from gq^0 */
+    for (j = 0, S = 1; j < m; j++) {
+      bsgs_hash_put(&pf->pages, S, j+1);
+      S = mulmod(S, pf->gq, p);
+    }
+    pf->gqinvm = modinverse(S, p);
+  }
+  return ctx;
+}
+
+void znlog_ctx_free(znlog_ctx_t* ctx) {
+  int i;
+  if (ctx == 0) return;
+  for (i = 0; i < ctx->nfactors; i++) {
+    destroy_pages(&(ctx->pf[i].pages));
+    Safefree(ctx->pf[i].pages.table);
+    dlp_ic_free(ctx->pf[i].ic);
+  }
+  Safefree(ctx);
+}
+
+/* Find d where h = gq^d, with h of order dividing q.  Returns 0 on failure. */
+static int _znlog_ctx_prime(znlog_ctx_prime_t* pf, UV h, UV p, UV* d) {
+  UV i, j, T = h, steps = (pf->q + pf->m - 1) / pf->m;
+  if (pf->ic != 0 && dlp_ic_solve(pf->ic, h, d))
+    return 1;
+  /* If the budget left this table far too small, use the general solver */
+  if (steps > 8*pf->m) {
+    int ok;
+    *d = _dlp_prime_order(h, pf->gq, p, pf->q, &ok);
+    return ok;
+  }
+  for (i = 0; i < steps; i++) {
+    j = bsgs_hash_get(&pf->pages, T);
+    if (j) { *d = i*pf->m + j-1; return 1; }
+    T = mulmod(T, pf->gqinvm, p);
+  }
+  return 0;
+}
+
+UV znlog_ctx_solve(znlog_ctx_t* ctx, UV a) {
+  UV x[MPU_MAX_FACTORS+1];
+  UV mod[MPU_MAX_FACTORS+1];
+  UV k, g = ctx->g, p = ctx->p, n = ctx->n;
+  int i, status;
+
+  if (p < 2) return 0;
+  if (a >= p) a %= p;
+  if (a == 1 || g == 0)
+    return 0;
+  if (n == 0) return znlog(a, g, p);
+  if (a == 0 || powmod(a, n, p) != 1) return 0;   /* a is not in <g> */
+
+  for (i = 0; i < ctx->nfactors; i++) {
+    znlog_ctx_prime_t* pf = ctx->pf + i;
+    UV j, d, xi = 0, qj = 1, ai = powmod(a, n / pf->qe, p);
+    /* Lift xi = log(ai) mod q^e one digit at a time */
+    for (j = 0; j < pf->e; j++) {
+      UV h = mulmod(ai, powmod(pf->giinv, xi, p), p);
+      h = powmod(h, pf->qe / (qj * pf->q), p);
+      if (!_znlog_ctx_prime(pf, h, p, &d)) return 0;
+      xi += d * qj;
+      qj *= pf->q;
+    }
+    x[i] = xi;
+    mod[i] = pf->qe;
+  }
+  k = (ctx->nfactors == 0) ? 0 : chinese(x, mod, ctx->nfactors, &status);
+  if (ctx->nfactors > 0 && status != 1) return 0;
+  return (powmod(g, k, p) == a) ? k : 0;
+}
+
+void znlog_ctx_solve_batch(znlog_ctx_t* ctx, const UV* a, UV* k, UV num) {
+  UV i;
+  for (i = 0; i < num; i++)
+    k[i] = znlog_ctx_solve(ctx, a[i]);
+}
+
 /* Compile with:
  *  gcc -O3 -fomit-frame-pointer -march=native -Wall -DFACTOR_STANDALONE -DSTANDALONE factor.c util.c sieve.c cache.c primality.c lmo.c -lm
  */
@@ -9,10 +9,15 @@ extern int factor(UV n, UV *factors);
 extern int factor_exp(UV n, UV *factors, UV* exponents);
 extern UV  divisor_sum(UV n, UV k);
 
+extern void* start_factor_range(UV lo, UV hi);
+extern int   next_factor_range(void* ctx, UV *n, UV *factors);
+extern void  end_factor_range(void* ctx);
+
 extern int trial_factor(UV n, UV *factors, UV maxtrial);
 
 extern int fermat_factor(UV n, UV *factors, UV rounds);
 extern int holf_factor(UV n, UV *factors, UV rounds);
+extern int lehman_factor(UV n, UV *factors, int do_trial);
 extern int pbrent_factor(UV n, UV *factors, UV maxrounds, UV a);
 extern int prho_factor(UV n, UV *factors, UV maxrounds);
 extern int pminus1_factor(UV n, UV *factors, UV B1, UV B2);
@@ -21,11 +26,33 @@ extern int squfof_factor(UV n, UV *factors, UV rounds);
 
 extern UV* _divisor_list(UV n, UV *num_divisors);
 
+extern void* start_divisors(UV n);
+extern int   next_divisor(void* ctx, UV *d);
+extern void  end_divisors(void* ctx);
+
 extern UV dlp_trial(UV a, UV g, UV p, UV maxrounds);
 extern UV dlp_prho(UV a, UV g, UV p, UV n, UV maxrounds);
 extern UV dlp_bsgs(UV a, UV g, UV p, UV n, UV maxent);
+extern UV dlp_prho_dp(UV a, UV g, UV p, UV n, UV maxrounds);
+extern UV dlp_kangaroo(UV a, UV g, UV p, UV b);
+
+/* Index calculus for g of prime order q, with q exactly dividing p-1 */
+typedef struct dlp_ic_t dlp_ic_t;
+extern dlp_ic_t* dlp_ic_new(UV g, UV p, UV q);
+extern int dlp_ic_solve(const dlp_ic_t* ic, UV a, UV* k);
+extern void dlp_ic_free(dlp_ic_t* ic);
+
 extern UV znlog_solve(UV a, UV g, UV p);
 extern UV znlog_ph(UV a, UV g, UV p);
 extern UV znlog(UV a, UV g, UV p);
 
+/* Precompute for many znlog calls with the same g and p.  maxent bounds the
+ * total number of baby step table entries. */
+typedef struct znlog_ctx_t znlog_ctx_t;
+#define ZNLOG_CTX_MAXENT 262144
+extern znlog_ctx_t* znlog_ctx_new(UV g, UV p, UV maxent);
+extern UV znlog_ctx_solve(znlog_ctx_t* ctx, UV a);
+extern void znlog_ctx_solve_batch(znlog_ctx_t* ctx, const UV* a, UV* k, UV num);
+extern void znlog_ctx_free(znlog_ctx_t* ctx);
+
 #endif
@@ -15,6 +15,7 @@ our @EXPORT_OK =
   qw( prime_get_config prime_set_config
       prime_precalc prime_memfree
       is_prime is_prob_prime is_provable_prime is_provable_prime_with_cert
+      is_prime_batch is_prime_range
       prime_certificate verify_prime
       is_pseudoprime is_strong_pseudoprime
       is_lucas_pseudoprime
@@ -24,12 +25,14 @@ our @EXPORT_OK =
       is_frobenius_pseudoprime
       is_perrin_pseudoprime
       is_frobenius_underwood_pseudoprime is_aks_prime is_bpsw_prime
-      is_mersenne_prime
+      is_mersenne_prime lucas_lehmer
       is_power
       miller_rabin_random
+      spsp2_range carmichael_count
       lucas_sequence lucasu lucasv
       primes twin_primes
-      forprimes forcomposites foroddcomposites fordivisors
+      forprimes forcomposites foroddcomposites fordivisors forfactored
+      fortotients formoebius forsigma
       forpart forcomb forperm
       prime_iterator prime_iterator_object
       next_prime  prev_prime
@@ -43,19 +46,20 @@ our @EXPORT_OK =
       random_maurer_prime random_maurer_prime_with_cert
       random_shawe_taylor_prime random_shawe_taylor_prime_with_cert
       primorial pn_primorial consecutive_integer_lcm gcdext chinese
-      gcd lcm factor factor_exp divisors valuation invmod hammingweight
+      gcd lcm factor factor_exp factor_range divisors valuation invmod hammingweight
       vecsum vecmin vecmax vecprod vecreduce
       moebius mertens euler_phi jordan_totient exp_mangoldt liouville
+      totient_sum squarefree_count
       partitions bernfrac bernreal
       chebyshev_theta chebyshev_psi
-      divisor_sum carmichael_lambda kronecker
+      divisor_sum divisor_summatory carmichael_lambda kronecker
       binomial factorial stirling znorder znprimroot znlog legendre_phi
       ExponentialIntegral LogarithmicIntegral RiemannZeta RiemannR LambertW Pi
   );
 our %EXPORT_TAGS = (all => [ @EXPORT_OK ]);
 
 # These are only exported if specifically asked for
-push @EXPORT_OK, (qw/trial_factor fermat_factor holf_factor squfof_factor prho_factor pbrent_factor pminus1_factor pplus1_factor ecm_factor/);
+push @EXPORT_OK, (qw/trial_factor fermat_factor holf_factor lehman_factor squfof_factor prho_factor pbrent_factor pminus1_factor pplus1_factor ecm_factor/);
 
 my %_Config;
 
@@ -112,6 +116,11 @@ BEGIN {
     *prime_count   = \&Math::Prime::Util::_generic_prime_count;
     *factor        = \&Math::Prime::Util::_generic_factor;
     *factor_exp    = \&Math::Prime::Util::_generic_factor_exp;
+    *factor_range  = \&Math::Prime::Util::_generic_factor_range;
+    *is_prime_batch = \&Math::Prime::Util::_generic_is_prime_batch;
+    *is_prime_range = \&Math::Prime::Util::_generic_is_prime_range;
+    *spsp2_range   = \&Math::Prime::Util::_generic_spsp2_range;
+    *carmichael_count = \&Math::Prime::Util::_generic_carmichael_count;
   };
 
   $_Config{'nobigint'} = 0;
@@ -495,7 +504,8 @@ sub partitions {
 }
 
 #############################################################################
-# forprimes, forcomposites, fordivisors.
+# forprimes, forcomposites, fordivisors, forfactored, fortotients, formoebius,
+# forsigma.
 # These are used when the XS code can't handle it.
 
 sub _generic_forprimes {
@@ -567,6 +577,81 @@ sub _generic_fordivisors {
   }
 }
 
+sub _generic_forfactored {
+  my($sub, $beg, $end) = @_;
+  if (!defined $end) { $end = $beg; $beg = 1; }
+  _validate_positive_integer($beg);
+  _validate_positive_integer($end);
+  $end = Math::BigInt->new(''.~0) if ref($end) ne 'Math::BigInt' && $end == ~0;
+  {
+    my $pp;
+    local *_ = \$pp;
+    for ( ; $beg <= $end ; $beg++ ) {
+      $pp = $beg;
+      $sub->(factor($beg));
+    }
+  }
+}
+
+sub _generic_factor_range {
+  my($lo, $hi) = @_;
+  if (defined $hi) { _validate_num($lo) || _validate_positive_integer($lo); }
+  else             { ($lo,$hi) = (1, $lo);                                   }
+  _validate_num($hi) || _validate_positive_integer($hi);
+  my @factors;
+  forfactored( sub { push @factors, [@_] }, $lo, $hi ) if $lo <= $hi;
+  return \@factors;
+}
+
+sub _generic_fortotients {
+  my($sub, $beg, $end) = @_;
+  if (!defined $end) { $end = $beg; $beg = 1; }
+  _validate_positive_integer($beg);
+  _validate_positive_integer($end);
+  $end = Math::BigInt->new(''.~0) if ref($end) ne 'Math::BigInt' && $end == ~0;
+  {
+    my $pp;
+    local *_ = \$pp;
+    for ( ; $beg <= $end ; $beg++ ) {
+      $pp = $beg;
+      $sub->(euler_phi($beg));
+    }
+  }
+}
+
+sub _generic_formoebius {
+  my($sub, $beg, $end) = @_;
+  if (!defined $end) { $end = $beg; $beg = 1; }
+  _validate_positive_integer($beg);
+  _validate_positive_integer($end);
+  $end = Math::BigInt->new(''.~0) if ref($end) ne 'Math::BigInt' && $end == ~0;
+  {
+    my $pp;
+    local *_ = \$pp;
+    for ( ; $beg <= $end ; $beg++ ) {
+      $pp = $beg;
+      $sub->( ($beg == 0) ? 0 : moebius($beg) );
+    }
+  }
+}
+
+sub _generic_forsigma {
+  my($sub, $k, $beg, $end) = @_;
+  if (!defined $end) { $end = $beg; $beg = 1; }
+  _validate_positive_integer($k);
+  _validate_positive_integer($beg);
+  _validate_positive_integer($end);
+  $end = Math::BigInt->new(''.~0) if ref($end) ne 'Math::BigInt' && $end == ~0;
+  {
+    my $pp;
+    local *_ = \$pp;
+    for ( ; $beg <= $end ; $beg++ ) {
+      $pp = $beg;
+      $sub->(divisor_sum($beg, $k));
+    }
+  }
+}
+
 #############################################################################
 # Iterators
 
@@ -622,6 +707,63 @@ sub _generic_prime_count {
   return Math::Prime::Util::PP::prime_count($low,$high);
 }
 
+sub _generic_is_prime_batch {
+  my($aref) = @_;
+  croak "is_prime_batch argument must be an array reference"
+    unless ref($aref) eq 'ARRAY';
+  return map { is_prime($_) } @$aref;
+}
+
+sub _generic_is_prime_range {
+  my($lo, $hi, $step) = @_;
+  _validate_num($lo) || _validate_positive_integer($lo);
+  _validate_num($hi) || _validate_positive_integer($hi);
+  if (defined $step) {
+    _validate_num($step) || _validate_positive_integer($step);
+    croak "is_prime_range step must be positive" if $step == 0;
+  } else {
+    $step = 1;
+  }
+  my($bits, $k) = ('', 0);
+  for (my $n = $lo; $n <= $hi; $n += $step) {
+    vec($bits, $k, 1) = 1 if is_prime($n);
+    $k++;
+  }
+  $bits .= "\0" x (int(($k+7)/8) - length($bits));
+  return $bits;
+}
+
+sub _generic_spsp2_range {
+  my($lo, $hi) = @_;
+  if (defined $hi) { _validate_num($lo) || _validate_positive_integer($lo); }
+  else             { ($lo,$hi) = (0, $lo);                                   }
+  _validate_num($hi) || _validate_positive_integer($hi);
+  my @spsp;
+  $lo = 9 if $lo < 9;
+  $lo++ unless $lo % 2;
+  for (my $n = $lo; $n <= $hi; $n += 2) {
+    push @spsp, $n if is_strong_pseudoprime($n, 2) && !is_prime($n);
+  }
+  return \@spsp;
+}
+
+sub _generic_carmichael_count {
+  my($lo, $hi) = @_;
+  if (defined $hi) { _validate_num($lo) || _validate_positive_integer($lo); }
+  else             { ($lo,$hi) = (0, $lo);                                   }
+  _validate_num($hi) || _validate_positive_integer($hi);
+  my $count = 0;
+  $lo = 9 if $lo < 9;
+  $lo++ unless $lo % 2;
+  for (my $n = $lo; $n <= $hi; $n += 2) {
+    next unless is_pseudoprime($n, 2) && !is_prime($n);
+    my @pe = factor_exp($n);
+    next if @pe < 3 || grep { $_->[1] > 1 || ($n-1) % ($_->[0]-1) } @pe;
+    $count++;
+  }
+  return $count;
+}
+
 sub _generic_factor {
   my($n) = @_;
   _validate_num($n) || _validate_positive_integer($n);
@@ -693,6 +835,12 @@ sub is_provable_prime_with_cert {
     return (2, $header . "Type Small\nN $n\n") if $isp == 2;
   }
 
+  # Up to 2^128, a BLS75 n-1 proof in C if n-1 factors far enough.
+  if ($_Config{'xs'} && length("$n") <= 39) {
+    my $cert = _bls75_certificate("$n");
+    return (2, $header . $cert) if defined $cert;
+  }
+
   # Choice of methods for proof:
   #   ECPP         needs a fair bit of programming work
   #   APRCL        needs a lot of programming work
@@ -1117,6 +1265,33 @@ L<Math::Prime::Util/random_maurer_prime> or
 L<Math::Prime::Util/random_shawe_taylor_prime> which construct random
 provable primes.
 
+=head2 is_prime_batch
+
+  my @isp = is_prime_batch(\@candidates);
+
+Takes an array reference and returns a list with the result of L</is_prime>
+for each element, in the same order.  For native inputs this is done with a
+single call into C, and inputs above C<2^32> are tested several at a time
+with their Montgomery multiplies interleaved.  This is noticeably faster than
+calling L</is_prime> in a loop when testing many 64-bit candidates.
+If any element is not a native integer, each is tested with L</is_prime>.
+
+=head2 is_prime_range
+
+  my $bits = is_prime_range(10**15, 10**15 + 10**6);
+  my @tp = grep { vec($bits, $_, 1) && vec($bits, $_+2, 1) } 0 .. 10**6-2;
+
+  # Primes of the form 6k+1 from 1e12 on
+  $bits = is_prime_range(10**12+1, 10**12+600001, 6);
+
+Given a low and high value and an optional positive step (default 1),
+returns a string used as a bit vector, where C<vec($bits, $k, 1)> is 1 if
+C<low + k*step> is prime.  Every term up to C<high> is included.
+
+Ranges wide enough to amortize the sieving primes use the segment sieve.
+Otherwise the progression is sieved by small primes and the survivors are
+tested with BPSW, so sparse or short windows of large numbers are fast too.
+
 
 =head2 primes
 
@@ -1203,7 +1378,57 @@ C<9, 15, 21, 25, 27, 33, 35, ...>.
 
 Given a block and a non-negative number C<n>, the block is called with
 C<$_> set to each divisor in sorted order.  Also see L</divisor_sum>.
+Divisors are generated as needed rather than built as a list first, so
+memory use grows only with the square root of the number of divisors.
+
+
+=head2 forfactored
+
+  forfactored { say "$_: @_"; } 100;       # factor 1 to 100
+  forfactored { $n++ if @_ == 2 } 1e6,2e6; # count semiprimes
+
+Given a block and either an end number or a start and end pair, calls the
+block for each integer in the inclusive range with C<$_> set to the
+integer and C<@_> set to its factors, exactly as L</factor> would return
+them.  The default start is 1, which is called with an empty C<@_>.
+
+For ranges of native integers the factors are found with a segmented sieve
+rather than factoring each value separately, which is much faster than
+calling L</factor> in a loop.
+
 
+=head2 fortotients
+
+  fortotients { say "phi($_) = $_[0]" } 100;
+  my $sum = 0;  fortotients { $sum += $_[0] } 10**9;
+
+Given a block and either an end number or a start and end pair, calls the
+block for each integer in the inclusive range with C<$_> set to the integer
+and C<$_[0]> set to its totient, as L</euler_phi> would return it.  The
+default start is 1.
+
+The totients are sieved a window at a time, so memory use does not grow
+with the size of the range.  This makes it practical to walk ranges much
+too large for the list form of L</euler_phi>.
+
+=head2 formoebius
+
+  my $M = 0;  formoebius { $M += $_[0] } 10**9;   # Mertens(10^9)
+
+As L</fortotients>, with C<$_[0]> set to the Moebius function of C<$_>.
+
+=head2 forsigma
+
+  forsigma { $sum += $_ if is_power($_[0],2) } 2, 64_000_000;
+  forsigma { say "$_ is abundant" if $_[0] > 2*$_ } 1, 100;
+
+Given a block, a non-negative integer C<k>, and either an end number or a
+start and end pair, calls the block for each integer C<$_> in the range
+with C<$_[0]> set to C<divisor_sum($_, k)>.  The default start is 1.
+
+As with L</fortotients>, the values are sieved a window at a time.  If
+C<sigma_k> could overflow a native integer within the range, each value
+is found with L</divisor_sum> instead.
 
 =head2 forpart
 
@@ -1502,6 +1727,33 @@ Removing primes, given base 2 this produces the sequence L<OEIS A001567|http://o
 For practical use, L</is_strong_pseudoprime> is a much stronger test with
 similar or better performance.
 
+=head2 spsp2_range
+
+  # The base 2 strong pseudoprimes below 2^32
+  my $aref = spsp2_range(2**32);
+  my $spsp = spsp2_range(10**12, 10**12 + 10**8);
+
+Given a high value, or a low and high value, returns an array reference
+of the odd composites in the range (inclusive) that are strong pseudoprimes
+to base 2.  Below 2^64 these are L<OEIS A001262|http://oeis.org/A001262>.
+
+Every prime factor p of a base 2 pseudoprime n has n/p = 1 mod the order
+of 2 mod p, and p^2 can't divide n unless p is a Wieferich prime.  The
+range is sieved for these so only a small fraction of the odd numbers get
+a strong test, as in the first stage of Feitsma's search.  This is about
+20x faster than testing every odd number with L</is_strong_pseudoprime>.
+
+=head2 carmichael_count
+
+  say carmichael_count(10**9);            # 646
+  say carmichael_count(10**12, 10**13);
+
+Given a high value, or a low and high value, returns the number of
+Carmichael numbers in the range (inclusive).  These are the odd composites
+that are squarefree with p-1 dividing n-1 for every prime factor p
+(Korselt's criterion), L<OEIS A002997|http://oeis.org/A002997>.  The
+same sieve as L</spsp2_range> is used, with p-1 in place of the order.
+
 =head2 is_strong_pseudoprime
 
   my $maybe_prime = is_strong_pseudoprime($n, 2);
@@ -1592,8 +1844,11 @@ While pseudoprimes are relatively rare (the first two are 271441 and 904631),
 infinitely many exist.
 The pseudoprime sequence is L<OEIS A013998|http://oeis.org/A013998>.
 
-The implementation uses modular 3x3 matrix exponentiation, which is efficient
-but still quite slow compared to the other probable prime tests.
+The implementation doubles the signatures C<P(k-1), P(k), P(k+1)> and
+C<P(-k-1), P(-k), P(-k+1)> as described by Adams and Shanks (1982), which
+takes six modular multiplications per bit of C<n>.  This is much faster
+than the 3x3 matrix power used previously, though still slower than a
+strong pseudoprime test.
 
 =head2 is_frobenius_pseudoprime
 
@@ -1710,6 +1965,9 @@ The pure Perl implementation uses theorem 5 of BLS75 (Brillhart, Lehmer, and
 Selfridge's 1975 paper), an improvement on the Pocklington-Lehmer test.
 This requires C<n-1> to be factored to C<(n/2)^(1/3))>.  This is often fast,
 but as C<n> gets larger, it takes exponentially longer to find factors.
+Without GMP, inputs below C<2^128> first try the same proof in C, with
+128-bit Montgomery arithmetic and native factoring of C<n-1>, which is
+usually over 1000 times faster than the Perl code.
 
 L<Math::Prime::Util::GMP> implements both the BLS75 theorem 5 test as well
 as ECPP (elliptic curve primality proving).  It will typically try a quick
@@ -1753,6 +2011,9 @@ Math::BigInt, so you probably want to install and use Math::BigInt::GMP,
 and ECPP certificates will be faster with Math::Prime::Util::GMP for
 its elliptic curve computations.
 
+Certificates whose numbers are all below C<2^128> are verified in C on
+64-bit platforms with 128-bit integer support, which is much faster.
+
 If the certificate is malformed, the routine will carp a warning in addition
 to returning 0.  If the C<verbose> option is set (see L</prime_set_config>)
 then if the validation fails, the reason for the failure is printed in
@@ -1982,7 +2243,9 @@ We have ECPP, and indeed it is much faster.
 
 This implementation includes the v6 improvements from Lenstra as well as
 further improvements from Bernstein and Voloch.  It runs substantially
-faster than the original or v6 versions.  The GMP implementation uses
+faster than the original or v6 versions.  The C code selects C<r> and C<s>
+with Bernstein's 2003 theorem 4.1, so a 64-bit prime needs about 250
+witnesses and is proven in well under a second.  The GMP implementation uses
 a binary segmentation method for modular polynomial multiplication
 (see Bernstein's 2007 Quartic paper), which reduces to a single scalar
 multiplication, at which GMP excels.  Because of this, the GMP
@@ -1999,14 +2262,29 @@ Mersenne primes is used to accelerate this.  Beyond the highest sequential
 Mersenne prime (currently 32,582,657) this performs pretesting followed by
 the Lucas-Lehmer test.
 
+Since we use the table for "small" numbers, the test itself will only run
+from this function for numbers with over 9.8 million digits.  At this size,
+tools such as C<prime95> are greatly preferred.  Use L</lucas_lehmer> to
+run the test on smaller exponents.
+
+
+=head2 lucas_lehmer
+
+  say "M4253 is prime" if lucas_lehmer(4253);
+
+Takes a positive number C<p> as input and returns 1 if C<2^p-1> is prime,
+running the Lucas-Lehmer test rather than using the table of known
+Mersenne primes.  Composite C<p> returns 0 immediately, and for C<p>
+larger than a word, small factors C<2kp+1> are looked for first.
+
 The Lucas-Lehmer test is a deterministic unconditional test that runs
 very fast compared to other primality methods for numbers of comparable
 size, and vastly faster than any known general-form primality proof methods.
-While this test is fast, the GMP implementation is not nearly as fast as
-specialized programs such as C<prime95>.  Additionally, since we use the
-table for "small" numbers, testing via this function call will only occur
-for numbers with over 9.8 million digits.  At this size, tools such as
-C<prime95> are greatly preferred.
+The C code squares mod C<2^p-1> with a floating point FFT (an irrational
+base weighted transform), checking the round-off error each iteration.
+This is good for exponents up to a few hundred thousand: M44497 takes
+about 5 seconds.  It is not nearly as fast as specialized programs such
+as C<prime95>, and does not use threads.
 
 
 =head2 is_power
@@ -2271,6 +2549,33 @@ faster.  Lastly, one of the advanced prime count algorithms could be
 theoretically used to create a faster solution.
 
 
+=head2 totient_sum
+
+  say totient_sum(1000);          # 304192
+  say totient_sum(10**10);        # 30396355092886216366
+
+Returns the sum of L</euler_phi> for C<1> to C<n>, which is also the number
+of reduced fractions C<a/b> with C<0 E<lt> a E<lt>= b E<lt>= n> (OEIS A002088).
+Since C<sum(totient_sum(n/k), k=1..n) = n(n+1)/2>, the sums at every
+C<int(n/k)> can be built from the largest C<k> down, starting from
+totients sieved to about C<n^(2/3)>.  This takes C<O(n^(2/3))> time and
+C<O(n^(1/3))> memory: 32 bytes for each C<int(n/k)> above C<n^(2/3)> plus
+the sieve windows, about 120MB at C<2^64>.  The result grows as
+C<3n^2/pi^2>, so inputs over C<2^32> may return a bigint.
+
+
+=head2 squarefree_count
+
+  say squarefree_count(10**12);   # 607927102274
+
+Returns the number of squarefree integers from C<1> to C<n> (OEIS A013928
+offset by one), using C<Q(n) = sum(moebius(d) * int(n/d^2))> for C<d> to
+C<sqrt(n)>.  The terms with C<d> above about C<n^(2/5)> are regrouped into
+C<n^(1/5)> values of L</mertens>, each computed from a table of Mertens
+values by the same recursion as L</totient_sum>.  The total is
+C<O(n^(2/5))> time and memory, under two seconds for any 64-bit input.
+
+
 =head2 euler_phi
 
   say "The Euler totient of $n is ", euler_phi($n);
@@ -2286,6 +2591,8 @@ Pari pre-2.6.2 raises and exception, and Pari 2.6.2 and newer returns 2.
 If called with two arguments, they define a range C<low> to C<high>, and the
 function returns an array with the totient of every n from low to high
 inclusive.
+The values are sieved a window at a time.  L</fortotients> walks a range
+without building the list.
 
 
 =head2 jordan_totient
@@ -2375,6 +2682,23 @@ if necessary.  For the code reference case, the user must take care to return
 bigints if overflow will be a concern.
 
 
+=head2 divisor_summatory
+
+  say divisor_summatory(10**12, 0);   # 27785452449086
+  say divisor_summatory(10**6);       # sigma sum, 822468118437
+
+Returns the sum of C<divisor_sum(i, k)> for C<i> from 1 to C<n>.  As with
+L</divisor_sum>, the default C<k> is 1.  With C<k = 0> this is the divisor
+summatory function C<D(n)> (OEIS A006218), and with C<k = 1> the sum of
+sigma (OEIS A024916).
+
+For C<k> of 0, 1, or 2 this counts the pairs C<a*b E<lt>= n> by the
+hyperbola method in C<O(n^(1/2))> time, and C<D(n)> walks the lattice
+points just above the hyperbola (Sladkey 2012) in about C<O(n^(1/3))>.
+The result will be a bigint if necessary.  Other C<k> sum over all
+C<d E<lt>= n>, which is only practical for small inputs.
+
+
 =head2 primorial
 
   $prim = primorial(11); #        11# = 2*3*5*7*11 = 2310
@@ -2560,9 +2884,16 @@ Returns the integer C<k> that solves the equation C<a = g^k mod p>, or
 undef if no solution is found.  This is the discrete logarithm problem.
 
 The implementation for native integers first applies Silver-Pohlig-Hellman
-on the group order to possibly reduce the problem to a set of smaller
-problems.  The solutions are then performed using a relatively fast Shanks
-BSGS, as well as trial and Pollard's DLP Rho.
+on the group order to reduce the problem to a set of problems in
+subgroups of prime order.  These are solved with trial, Shanks BSGS, or
+for primes over C<2^32> index calculus when C<p> is prime and the subgroup
+order divides C<p-1> once.  Otherwise Pollard's Rho with distinguished
+points is used, falling back to Pollard's Kangaroo.  64-bit primes take
+about a tenth of a second.
+Repeated calls with the same C<g> and C<p> reuse the order factorization,
+index calculus logs, and a baby step table of about 256k entries kept
+from the previous call,
+making each further solution much faster.
 
 The PP implementation is less sophisticated, with only a memory-heavy BSGS
 being used.
@@ -2981,6 +3312,21 @@ The internals are identical to L</factor>, so all comments there apply.
 Just the way the factors are arranged is different.
 
 
+=head2 factor_range
+
+  my $f = factor_range(10**12, 10**12 + 1000);
+  say "@{$f->[7]}";       # factors of 10**12 + 7
+
+Given a high value, or a low and high value, returns an array reference
+with one entry for each integer in the range (inclusive).  Each entry is
+an array reference holding the factors of that integer, exactly as
+L</factor> would return them.  The default low value is 1.
+
+The range is factored with the same segmented sieve as L</forfactored>.
+Use that iterator instead for wide ranges, as this builds every list
+before returning.
+
+
 =head2 divisors
 
   my @divisors = divisors(30);   # returns (1, 2, 3, 5, 6, 10, 15, 30)
@@ -3030,6 +3376,18 @@ premultiplier.  It is an interesting alternative to Fermat's algorithm,
 and there are some inputs it can rapidly factor.  Overall it has the
 same advantages and disadvantages as Fermat's method.
 
+=head2 lehman_factor
+
+  my @factors = lehman_factor($n);
+
+Produces factors, not necessarily prime, of the positive number input.  This
+is Lehman's method, which is guaranteed to find a factor of composites in
+its range, with complexity C<O(n^1/3)>.  An optional second argument of 0
+skips the trial division to C<n^1/3>, making it a heuristic that quickly
+splits inputs with two similar sized factors.  Inputs larger than C<2^45>
+(C<2^22> on 32-bit machines) are returned unfactored.  This is used in
+L</factor> for some 33 to 45 bit inputs.
+
 =head2 squfof_factor
 
   my @factors = squfof_factor($n);
@@ -501,6 +501,78 @@ sub primes {
   $sref;
 }
 
+# For bigints, a BPSW test costs far more than sieving.  Sieve a window of
+# odd candidates, about two average gaps wide, by the small primes and test
+# only the survivors.  Residues are taken from the decimal string a chunk at
+# a time, for groups of primes whose product keeps it all native.
+{
+  my($_pwmax, $_pwdigits) = (MPU_32BIT) ? (65536, 4) : (4294967296, 9);
+  my %_pwgroups;
+  sub _prime_window_groups {
+    my($plimit) = @_;
+    return $_pwgroups{$plimit} if defined $_pwgroups{$plimit};
+    my(@groups, @g);
+    my $m = 1;
+    foreach my $p (@_primes_small[2 .. $#_primes_small]) {
+      last if $p > $plimit;
+      if ($m * $p >= $_pwmax) {
+        push @groups, [$m, @g];
+        ($m, @g) = (1);
+      }
+      $m *= $p;
+      push @g, $p;
+    }
+    push @groups, [$m, @g] if @g;
+    $_pwgroups{$plimit} = \@groups;
+  }
+  sub _prime_window_sieve {
+    my($beg, $width, $groups) = @_;
+    my $str = "$beg";
+    my @chunks = unpack("(A$_pwdigits)*",
+                        ("0" x (-length($str) % $_pwdigits)) . $str);
+    my $cmul = 10 ** $_pwdigits;
+    my $sieve = "0" x $width;
+    foreach my $g (@$groups) {
+      my($m, @gp) = @$g;
+      my $r = 0;
+      $r = ($r * $cmul + $_) % $m for @chunks;
+      foreach my $p (@gp) {
+        # beg+2k = 0 mod p
+        my $t = ($p - $r % $p) % $p;
+        for (my $k = ($t & 1) ? ($t+$p) >> 1 : $t >> 1;  $k < $width;  $k += $p) {
+          substr($sieve, $k, 1) = "1";
+        }
+      }
+    }
+    $sieve;
+  }
+}
+sub _next_prime_window {
+  my($n, $dir) = @_;
+  my $bits = length($n->as_bin) - 2;
+  my $width = 16 + int(0.7 * $bits);
+  my $groups = _prime_window_groups( ($bits < 250) ? 20*$bits : 5000 );
+
+  # Odd window start.  Going down the window ends at the odd below n.
+  my $beg = $n->copy;
+  if ($dir > 0) { $beg->binc; $beg->binc if $beg->is_even; }
+  else          { $beg->bdec; $beg->bdec if $beg->is_even;
+                  $beg->bsub(2*($width-1)); }
+  while (1) {
+    my $sieve = _prime_window_sieve($beg, $width, $groups);
+    my @k;
+    for (my $k = index($sieve, "0");  $k >= 0;  $k = index($sieve, "0", $k+1)) {
+      push @k, $k;
+    }
+    @k = reverse @k if $dir < 0;
+    foreach my $k (@k) {
+      my $c = $beg->copy->badd(2*$k);
+      return $c if _miller_rabin_2($c) && is_extra_strong_lucas_pseudoprime($c);
+    }
+    $beg->badd($dir * 2 * $width);
+  }
+}
+
 sub next_prime {
   my($n) = @_;
   _validate_positive_integer($n);
@@ -515,6 +587,7 @@ sub next_prime {
   if ($n > 4294967295 && Math::Prime::Util::prime_get_config()->{'gmp'}) {
     return Math::Prime::Util::_reftyped($_[0], Math::Prime::Util::GMP::next_prime($n));
   }
+  return _next_prime_window($n, 1) if ref($n) eq 'Math::BigInt';
 
   do {
     $n += $_wheeladvance30[$n%30];
@@ -529,6 +602,7 @@ sub prev_prime {
   if ($n > 4294967295 && Math::Prime::Util::prime_get_config()->{'gmp'}) {
     return Math::Prime::Util::_reftyped($_[0], Math::Prime::Util::GMP::prev_prime($n));
   }
+  return _next_prime_window($n, -1) if ref($n) eq 'Math::BigInt';
 
   do {
     $n -= $_wheelretreat30[$n%30];
@@ -766,6 +840,53 @@ sub mertens {
   return $sum;
 }
 
+# Phi(n) = n(n+1)/2 - sum[k=2..n] Phi(n/k).  All the arguments are some
+# n/j, so compute Phi(n/j) for n/j > sqrt(n) from the largest j down, using
+# prefix sums of totients below that.
+sub totient_sum {
+  my($n) = @_;
+  return $n if $n <= 2;
+  # The sum is about 0.3n^2, so use bigints past a half word.
+  $n = Math::BigInt->new("$n") if !ref($n) && $n >= MPU_HALFWORD;
+  my $r = ref($n) ? 0+$n->copy->bsqrt : int(sqrt($n));
+  my $J = 0+int($n/($r+1));
+  my $tsum = 0;
+  my @S = (0, map { $tsum += $_ } Math::Prime::Util::euler_phi(1, $r));
+  my @B;
+  for (my $j = $J; $j >= 1; $j--) {
+    my $x = int($n/$j);
+    my $s = ref($x) ? 0+$x->copy->bsqrt : int(sqrt($x));
+    my $sum = $x * ($x+1) / 2;
+    foreach my $k (2 .. $s) {
+      my $m = $j * $k;
+      $sum -= ($m <= $J) ? $B[$m] : $S[int($x/$k)];
+    }
+    my $khi = $x;
+    foreach my $q (1 .. int($x/($s+1))) {
+      my $klo = int($x/($q+1));
+      $klo = $s if $klo < $s;
+      $sum -= $S[$q] * ($khi - $klo);
+      $khi = $klo;
+    }
+    $B[$j] = $sum;
+  }
+  return $B[1];
+}
+
+sub squarefree_count {
+  my($n) = @_;
+  return $n if $n < 4;
+  $n = Math::BigInt->new("$n") if !ref($n) && $n > 2**53;
+  my $r = ref($n) ? 0+$n->copy->bsqrt : int(sqrt($n));
+  my @mu = (0, Math::Prime::Util::moebius(1, $r));
+  my $sum = 0;
+  foreach my $d (1 .. $r) {
+    next if $mu[$d] == 0;
+    $sum += $mu[$d] * int($n/($d*$d));
+  }
+  return $sum;
+}
+
 sub liouville {
   my($n) = @_;
   my $l = (-1) ** scalar factor($n);
@@ -889,6 +1010,39 @@ sub divisor_sum {
   $product;
 }
 
+# Sum of divisor_sum(i,k) for i = 1 .. n.  For k <= 2 this is the hyperbola
+# method with sums of powers in closed form, O(sqrt(n)).
+sub divisor_summatory {
+  my($n, $k) = @_;
+  $k = 1 unless defined $k;
+  return $n if $n <= 1;
+
+  if ($k > 2) {
+    $n = Math::BigInt->new("$n") unless ref($n);
+    my $sum = BZERO->copy;
+    for (my $d = BONE->copy; $d <= $n; $d->binc) {
+      $sum += $d->copy->bpow($k) * ($n / $d);
+    }
+    return $sum;
+  }
+
+  my $lim = ($k == 0) ? (MPU_64BIT ? 2**49 : 2**24)
+                      : int(2 ** ((MPU_MAXBITS-3)/($k+1)));
+  $n = Math::BigInt->new("$n") if !ref($n) && $n > $lim;
+  my $F = ($k == 0) ? sub { $_[0] }
+        : ($k == 1) ? sub { $_[0] * ($_[0]+1) / 2 }
+        :             sub { $_[0] * ($_[0]+1) * (2*$_[0]+1) / 6 };
+  my $s = ref($n) ? 0+$n->copy->bsqrt : int(sqrt($n));
+  my $sum = 0;
+  foreach my $a (1 .. $s) {
+    my $q = int($n/$a);
+    my $ak = ($k == 0) ? 1 : ($k == 1) ? $a : $a*$a;
+    $sum += $ak * $q + $F->($q);
+  }
+  $sum -= $s * $F->($s);
+  return $sum;
+}
+
 #############################################################################
 #                       Lehmer prime count
 #
@@ -2799,39 +2953,26 @@ sub is_frobenius_underwood_pseudoprime {
   return ($s == 0 && $t == $temp1) ? 1 : 0;
 }
 
-sub _mat_mulmod_3x3 {
-  my($aref, $bref, $n) = @_;
-  my @t;
-  for my $row (0..2) {
-    for my $col (0..2) {
-      my $i1 = $aref->[3*$row+0] * $bref->[0+$col];
-      my $i2 = $aref->[3*$row+1] * $bref->[3+$col];
-      my $i3 = $aref->[3*$row+2] * $bref->[6+$col];
-      push @t, ($i1 + $i2 + $i3) % $n;
-    }
-  }
-  @$aref = @t;
-}
-sub _mat_powmod_3x3 {
-  my($mref, $k, $n) = @_;
-  my $res = [1,0,0,  0,1,0,  0,0,1];
-  while ($k) {
-    # The next line prevents Perl 5.6.2 from segfaulting
-    $k = _bigint_to_int($k) if ref($k) && $k <= BMAX;
-    _mat_mulmod_3x3($res, $mref, $n)  if $k & 1;
-    $k >>= 1;
-    _mat_mulmod_3x3($mref, $mref, $n) if $k;
-  }
-  @$mref = @$res;
-}
-
 sub is_perrin_pseudoprime {
   my($n) = @_;
+  return 0+($n >= 1) if $n < 3;
   $n = Math::BigInt->new("$n") unless ref($n) eq 'Math::BigInt' || $n < (MPU_HALFWORD >> 1);
-  my @m = (0,1,0,  0,0,1,  1,1,0);
-  _mat_powmod_3x3(\@m, $n, $n);
-  my $trace = ($m[0] + $m[4] + $m[8]) % $n;
-  return ($trace == 0) ? 1 : 0;
+  # Double the signatures A(k-1..k+1) and B(k-1..k+1) = A(1-k..-1-k), as
+  # in the C code.  Six products per bit instead of a 3x3 matrix power.
+  my @A = (3, 0, 2);
+  my @B = (3, -1, 1);
+  my $bits = ref($n) ? substr($n->as_bin, 3) : substr(sprintf("%b",$n), 1);
+  foreach my $bit (split(//, $bits)) {
+    my $a2 = ($A[1]*$A[1] - 2*$B[1]) % $n;
+    my $a3 = ($A[1]*$A[2] + $B[0]) % $n;
+    my $a4 = ($A[2]*$A[2] - 2*$B[2]) % $n;
+    my $b2 = ($B[1]*$B[1] - 2*$A[1]) % $n;
+    my $b3 = ($B[1]*$B[2] + $A[1] + $A[0]) % $n;
+    my $b4 = ($B[2]*$B[2] - 2*$A[2]) % $n;
+    if ($bit) { @A = ($a2, $a3, $a4);  @B = ($b2, $b3, $b4); }
+    else      { @A = (($a4-$a2) % $n, $a2, $a3);  @B = (($b4+$b3) % $n, $b2, $b3); }
+  }
+  return ($A[1] == 0) ? 1 : 0;
 }
 
 sub is_frobenius_pseudoprime {
@@ -2889,6 +3030,11 @@ sub is_mersenne_prime {
   return 1 if exists $_mersenne_primes{$p};
   return 0 if $p < 32593019; # GIMPS has checked all below
   # Past this we do a generic Mersenne prime test
+  return lucas_lehmer($p);
+}
+
+sub lucas_lehmer {
+  my $p = shift;
 
   return 1 if $p == 2;
   return 0 unless is_prob_prime($p);
@@ -3638,6 +3784,50 @@ sub holf_factor {
   @factors;
 }
 
+sub lehman_factor {
+  my($n, $dotrial) = @_;
+  $dotrial = 1 unless defined $dotrial;
+
+  my @factors = _basic_factor($n);
+  return @factors if $n < 4;
+
+  # Keep 4kn in native range.
+  if (ref($n) eq 'Math::BigInt' || $n > (MPU_32BIT ? 4194303 : 35184372088831)) {
+    push @factors, $n;
+    return @factors;
+  }
+
+  my $cbrtn = int($n ** (1/3));
+  $cbrtn++ while $cbrtn*$cbrtn*$cbrtn < $n;
+  if ($dotrial) {
+    foreach my $f (@{primes(7, $cbrtn)}) {
+      return _found_factor($f, $n, "Lehman trial", @factors) unless $n % $f;
+    }
+  }
+
+  my $n16 = ($n ** (1/6)) / 4;
+  my $sqrt4n = 2 * sqrt($n);
+  foreach my $k (1 .. $cbrtn) {
+    my $inc = ($k & 1) ? 4 : 2;
+    my $r   = ($k & 1) ? ($k+$n) % 4 : 1;
+    my $sqrtk = sqrt($k);
+    my $kn4 = 4*$k*$n;
+    my $a = int($sqrt4n * $sqrtk);
+    $a++ while $a*$a < $kn4;
+    my $amax = int($sqrt4n * $sqrtk + $n16/$sqrtk);
+    for ($a += ($r + $inc - ($a % $inc)) % $inc;  $a <= $amax;  $a += $inc) {
+      my $b2 = $a*$a - $kn4;
+      my $b = int(sqrt($b2));
+      next unless $b*$b == $b2;
+      my $f = _gcd_ui($a + $b, $n);
+      return _found_factor($f, $n, "Lehman ($k rounds)", @factors)
+        if $f > 1 && $f < $n;
+    }
+  }
+  push @factors, $n;
+  @factors;
+}
+
 sub fermat_factor {
   my($n, $rounds) = @_;
   $rounds = 64*1024*1024 unless defined $rounds;
@@ -58,6 +58,16 @@ sub mertens {
   _validate_positive_integer($n);
   return Math::Prime::Util::PP::mertens($n);
 }
+sub totient_sum {
+  my($n) = @_;
+  _validate_positive_integer($n);
+  return Math::Prime::Util::PP::totient_sum($n);
+}
+sub squarefree_count {
+  my($n) = @_;
+  _validate_positive_integer($n);
+  return Math::Prime::Util::PP::squarefree_count($n);
+}
 sub liouville {
   my($n) = @_;
   _validate_positive_integer($n);
@@ -219,6 +229,11 @@ sub is_mersenne_prime {
   _validate_positive_integer($p);
   return Math::Prime::Util::PP::is_mersenne_prime($p);
 }
+sub lucas_lehmer {
+  my($p) = @_;
+  _validate_positive_integer($p);
+  return Math::Prime::Util::PP::lucas_lehmer($p);
+}
 
 
 sub lucas_sequence {
@@ -333,6 +348,11 @@ sub holf_factor {
   }
   return Math::Prime::Util::PP::holf_factor($n);
 }
+sub lehman_factor {
+  my($n, $dotrial) = @_;
+  _validate_positive_integer($n);
+  return Math::Prime::Util::PP::lehman_factor($n, $dotrial);
+}
 sub squfof_factor {
   my($n, $rounds) = @_;
   _validate_positive_integer($n);
@@ -381,6 +401,12 @@ sub divisor_sum {
   _validate_positive_integer($k) if defined $k && ref($k) ne 'CODE';
   return Math::Prime::Util::PP::divisor_sum($n, $k);
 }
+sub divisor_summatory {
+  my($n, $k) = @_;
+  _validate_positive_integer($n);
+  _validate_positive_integer($k) if defined $k;
+  return Math::Prime::Util::PP::divisor_summatory($n, $k);
+}
 
 sub gcd {
   my(@v) = @_;
@@ -553,6 +579,22 @@ sub fordivisors (&$) {    ## no critic qw(ProhibitSubroutinePrototypes)
   }
 }
 
+sub forfactored (&$;$) {    ## no critic qw(ProhibitSubroutinePrototypes)
+  Math::Prime::Util::_generic_forfactored(@_);
+}
+
+sub fortotients (&$;$) {    ## no critic qw(ProhibitSubroutinePrototypes)
+  Math::Prime::Util::_generic_fortotients(@_);
+}
+
+sub formoebius (&$;$) {    ## no critic qw(ProhibitSubroutinePrototypes)
+  Math::Prime::Util::_generic_formoebius(@_);
+}
+
+sub forsigma (&$$;$) {    ## no critic qw(ProhibitSubroutinePrototypes)
+  Math::Prime::Util::_generic_forsigma(@_);
+}
+
 sub forpart (&$;$) {    ## no critic qw(ProhibitSubroutinePrototypes)
   Math::Prime::Util::PP::forpart(@_);
 }
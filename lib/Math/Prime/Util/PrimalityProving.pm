@@ -767,6 +767,12 @@ sub verify_cert {
   $cert = convert_array_cert_to_string($cert) if ref($cert) eq 'ARRAY';
   return 0 if $cert eq '';
 
+  # If every number is below 2^128 the C code can do all of it.
+  if (prime_get_config->{'xs'}) {
+    my $res = Math::Prime::Util::_verify_cert($cert);
+    return $res if defined $res;
+  }
+
   my %parts;  # Map of "N is prime if Q is prime"
   my %proof_funcs = (
     ECPP        =>  \&_prove_ecpp,    # Standard ECPP proof
@@ -39,11 +39,14 @@ See L<Math::Prime::Util> for complete documentation.
 
   is_prob_prime(n)                    primality test (BPSW)
   is_prime(n)                         primality test (BPSW + extra)
+  is_prime_batch(\@n)                 is_prime for each element of array
+  is_prime_range(lo,hi[,step])        bit vector of is_prime for lo+k*step
   is_provable_prime(n)                primality test with proof
   is_provable_prime_with_cert(n)      primality test: (isprime,cert)
   prime_certificate(n)                as above with just certificate
   verify_prime(cert)                  verify a primality certificate
   is_mersenne_prime(p)                is 2^p-1 prime or composite
+  lucas_lehmer(p)                     Lucas-Lehmer test of 2^p-1
   is_aks_prime(n)                     AKS deterministic test (slow)
 
 =head2 PROBABLE PRIME TESTS
@@ -59,6 +62,8 @@ See L<Math::Prime::Util> for complete documentation.
   is_frobenius_underwood_pseudoprime(n)    combined PSP and Lucas
   is_bpsw_prime(n)                         combined SPSP-2 and ES Lucas
   miller_rabin_random(n, ntests)           perform random-base MR tests
+  spsp2_range([lo,] hi)                    array ref of base 2 strong psps
+  carmichael_count([lo,] hi)               count of Carmichael numbers
 
 =head2 PRIMES
 
@@ -87,10 +92,12 @@ See L<Math::Prime::Util> for complete documentation.
 
   factor(n)                           array of prime factors of n
   factor_exp(n)                       array of [p,k] factors p^k
+  factor_range([lo,] hi)              array ref of factor(n) array refs
   divisors(n)                         array of divisors of n
   divisor_sum(n)                      sum of divisors
   divisor_sum(n,k)                    sum of k-th power of divisors
   divisor_sum(n,sub{...})             sum of code run for each divisor
+  divisor_summatory(n[,k])            sum of divisor_sum(i,k) for 1 to n
   znlog(a, g, p)                      solve k in a = g^k mod p
 
 =head2 ITERATORS
@@ -99,6 +106,10 @@ See L<Math::Prime::Util> for complete documentation.
   forcomposites { ... } [start,] end  loop over composites in range
   foroddcomposites {...} [start,] end loop over odd composites in range
   fordivisors { ... } n               loop over the divisors of n
+  forfactored { ... } [start,] end    loop with \$_ = n and @_ = factor(n)
+  fortotients { ... } [start,] end    loop with \$_ = n and \$_[0] = phi(n)
+  formoebius { ... } [start,] end     loop with \$_ = n and \$_[0] = mu(n)
+  forsigma { ... } k, [start,] end    loop with \$_ = n and \$_[0] = sigma_k(n)
   forpart { ... } n [,{...}]          loop over integer partitions
   forcomb { ... } n, k                loop over combinations
   forperm { ... } n                   loop over permutations
@@ -144,8 +155,10 @@ See L<Math::Prime::Util> for complete documentation.
   moebius(n)                          Moebius function of n
   moebius(beg, end)                   array of Moebius in range
   mertens(n)                          sum of Moebius for 1 to n
+  squarefree_count(n)                 number of squarefree integers to n
   euler_phi(n)                        Euler totient of n
   euler_phi(beg, end)                 Euler totient for a range
+  totient_sum(n)                      sum of Euler totients for 1 to n
   jordan_totient(n,k)                 Jordan's totient
   carmichael_lambda(n)                Carmichael's Lambda function
   exp_mangoldt                        exponential of Mangoldt function
@@ -0,0 +1,289 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/*
+ * Lucas-Lehmer test for 2^p-1 with p larger than a word.
+ *
+ * This is the Crandall-Fagin irrational base discrete weighted transform:
+ * the residue is held in N floating point digits of ceil(p/N) or
+ * floor(p/N) bits, digit j standing for x_j * 2^ceil(pj/N).  Weighting
+ * digit j by 2^(ceil(pj/N) - pj/N) turns multiplication mod 2^p-1 into a
+ * plain cyclic convolution, which we do with a complex FFT of length N/2
+ * on the packed real data.  Digits are kept balanced (-B/2 <= x_j < B/2)
+ * which keeps the convolution outputs, and so the round-off, small.
+ *
+ * Each iteration rounds every output to an integer.  If any output is
+ * further than LL_MAX_ERR from its integer we can't trust the result, so
+ * we start over with a transform twice as long.
+ *
+ * Nothing here is tuned like Prime95 or Glucas.  It is a radix-2 transform
+ * without SIMD or threads, so it is good for checking exponents up to a
+ * few million in reasonable time, but not for new Mersenne primes.
+ *
+ * Copyright 2015, Dana Jacobsen.
+ */
+
+#include "ptypes.h"
+#include "mersenne.h"
+
+#define LL_MAX_ERR 0.35
+
+typedef struct {
+  UV p;
+  UV n;               /* number of digits, a power of 2 */
+  UV m;               /* complex FFT length, n/2 */
+  double* x;          /* n digits, then work space */
+  double* w;          /* n weights 2^(ceil(pj/n)-pj/n) */
+  double* winv;       /* 1/(m*w[j]) */
+  int* bits;          /* bits in digit j */
+  double* re;         /* FFT data */
+  double* im;
+  double* cosm;       /* the first m/2 m-th roots of unity */
+  double* sinm;
+  double* cosn;       /* n-th roots, for unpacking the real transform */
+  double* sinn;
+  UV* rev;            /* bit reversal of 0..m-1 */
+} llctx_t;
+
+static void ll_free(llctx_t* c)
+{
+  Safefree(c->x);    Safefree(c->w);    Safefree(c->winv);  Safefree(c->bits);
+  Safefree(c->re);   Safefree(c->im);
+  Safefree(c->cosm); Safefree(c->sinm); Safefree(c->cosn);  Safefree(c->sinn);
+  Safefree(c->rev);
+}
+
+static void ll_init(llctx_t* c, UV p, UV n)
+{
+  UV j, m = n/2, lg;
+  const double pi = 3.14159265358979323846264338327950288;
+
+  c->p = p;  c->n = n;  c->m = m;
+  New(0, c->x, n, double);
+  New(0, c->w, n, double);
+  New(0, c->winv, n, double);
+  New(0, c->bits, n, int);
+  New(0, c->re, m, double);
+  New(0, c->im, m, double);
+  New(0, c->cosm, m/2+1, double);
+  New(0, c->sinm, m/2+1, double);
+  New(0, c->cosn, m/2+1, double);
+  New(0, c->sinn, m/2+1, double);
+  New(0, c->rev, m, UV);
+
+  for (j = 0; j < n; j++) {
+    uint64_t pj = (uint64_t)p*j, c0 = (pj + n - 1) / n, c1 = (pj + p + n - 1) / n;
+    c->bits[j] = (int)(c1 - c0);
+    c->w[j] = exp2( (double)(c0*n - pj) / (double)n );
+    c->winv[j] = 1.0 / (c->w[j] * (double)m);
+  }
+  for (j = 0; j <= m/2; j++) {
+    c->cosm[j] = cos(2*pi*j/m);   c->sinm[j] = sin(2*pi*j/m);
+    c->cosn[j] = cos(2*pi*j/n);   c->sinn[j] = sin(2*pi*j/n);
+  }
+  for (lg = 0; ((UV)1 << lg) < m; lg++)
+    ;
+  for (j = 0; j < m; j++) {
+    UV r = 0, k, t = j;
+    for (k = 0; k < lg; k++, t >>= 1)
+      r = (r << 1) | (t & 1);
+    c->rev[j] = r;
+  }
+}
+
+/* Decimation in frequency, natural order in, bit reversed out */
+static void fft_dif(llctx_t* c)
+{
+  double *re = c->re, *im = c->im;
+  UV m = c->m, len, i, j, step;
+  for (len = m; len >= 2; len >>= 1) {
+    UV half = len >> 1;
+    step = m / len;
+    for (i = 0; i < m; i += len) {
+      for (j = 0; j < half; j++) {
+        UV a = i+j, b = a+half, k = j*step;
+        double wr, wi, tr, ti;
+        wr = c->cosm[k];  wi = -c->sinm[k];
+        tr = re[a] - re[b];  ti = im[a] - im[b];
+        re[a] += re[b];      im[a] += im[b];
+        re[b] = tr*wr - ti*wi;
+        im[b] = tr*wi + ti*wr;
+      }
+    }
+  }
+}
+/* Decimation in time, bit reversed in, natural order out, unscaled */
+static void fft_dit_inv(llctx_t* c)
+{
+  double *re = c->re, *im = c->im;
+  UV m = c->m, len, i, j, step;
+  for (len = 2; len <= m; len <<= 1) {
+    UV half = len >> 1;
+    step = m / len;
+    for (i = 0; i < m; i += len) {
+      for (j = 0; j < half; j++) {
+        UV a = i+j, b = a+half, k = j*step;
+        double wr, wi, tr, ti;
+        wr = c->cosm[k];  wi = c->sinm[k];
+        tr = re[b]*wr - im[b]*wi;
+        ti = re[b]*wi + im[b]*wr;
+        re[b] = re[a] - tr;  im[b] = im[a] - ti;
+        re[a] += tr;         im[a] += ti;
+      }
+    }
+  }
+}
+
+/* Square the length n real sequence held as re + i*im in the length m
+ * transform.  With Z the transform of z_k = x_2k + i x_2k+1, the real
+ * transform is X_k = E_k + e^(-2 pi i k/n) O_k where
+ *   E_k = (Z_k + conj(Z_(m-k)))/2,  O_k = (Z_k - conj(Z_(m-k)))/(2i).
+ * Square X_k and X_(m-k), then run the same relation backwards. */
+static void fft_square(llctx_t* c)
+{
+  double *re = c->re, *im = c->im;
+  const UV* rev = c->rev;
+  UV m = c->m, k;
+
+  /* k = 0 and k = m/2 pair with themselves */
+  {
+    double r0 = re[0], i0 = im[0];
+    double x0 = r0 + i0, xm = r0 - i0;     /* X_0 and X_m, both real */
+    x0 *= x0;  xm *= xm;
+    re[0] = 0.5*(x0 + xm);
+    im[0] = 0.5*(x0 - xm);
+  }
+  {                                        /* X = conj(Z), Z' = conj(X^2) */
+    UV h = rev[m/2];
+    double zr = re[h], zi = im[h];
+    re[h] = zr*zr - zi*zi;
+    im[h] = 2*zr*zi;
+  }
+  for (k = 1; k < m/2; k++) {
+    UV a = rev[k], b = rev[m-k];
+    double zr = re[a], zi = im[a], yr = re[b], yi = im[b];
+    double er = 0.5*(zr + yr), ei = 0.5*(zi - yi);     /* E_k */
+    double orr = 0.5*(zi + yi), oi = -0.5*(zr - yr);   /* O_k */
+    double wr = c->cosn[k], wi = -c->sinn[k];
+    double tr = orr*wr - oi*wi, ti = orr*wi + oi*wr;
+    double xkr = er + tr, xki = ei + ti;               /* X_k */
+    double xmr = er - tr, xmi = -(ei - ti);            /* X_(m-k) */
+    double sr, si, s2r, s2i;
+    sr  = xkr*xkr - xki*xki;  si  = 2*xkr*xki;
+    s2r = xmr*xmr - xmi*xmi;  s2i = 2*xmr*xmi;
+    /* Back:  E = (Y_k + conj(Y_(m-k)))/2, O = (Y_k - conj(Y_(m-k)))/2 * w^-1 */
+    er = 0.5*(sr + s2r);  ei = 0.5*(si - s2i);
+    tr = 0.5*(sr - s2r);  ti = 0.5*(si + s2i);
+    orr = tr*wr + ti*wi;  oi = ti*wr - tr*wi;
+    /* Z'_k = E + i O,  Z'_(m-k) = conj(E) + i conj(O) */
+    re[a] = er - oi;   im[a] = ei + orr;
+    re[b] = er + oi;   im[b] = -ei + orr;
+  }
+}
+
+/* Round, carry and subtract 2.  Returns the largest rounding error. */
+static double ll_carry(llctx_t* c)
+{
+  double *x = c->x, maxerr = 0;
+  UV j, n = c->n;
+  int64_t carry = -2;
+  for (j = 0; j < n; j++) {
+    double v = ((j & 1) ? c->im[j>>1] : c->re[j>>1]) * c->winv[j];
+    double r = floor(v + 0.5), err = fabs(v - r);
+    int64_t t, lo, B = (int64_t)1 << c->bits[j];
+    if (err > maxerr) maxerr = err;
+    t = (int64_t)r + carry;
+    lo = t & (B-1);
+    if (lo >= B/2) lo -= B;
+    carry = (t - lo) / B;
+    x[j] = (double)lo;
+  }
+  /* 2^p = 1, so the top carry goes back in at the bottom */
+  for (j = 0; carry != 0 && j < n-1; j++) {
+    int64_t t = (int64_t)x[j] + carry, lo, B = (int64_t)1 << c->bits[j];
+    lo = t & (B-1);
+    if (lo >= B/2) lo -= B;
+    carry = (t - lo) / B;
+    x[j] = (double)lo;
+  }
+  x[j] += (double)carry;
+  return maxerr;
+}
+
+/* Is the residue 0 mod 2^p-1? */
+static int ll_is_zero(llctx_t* c)
+{
+  UV j, n = c->n;
+  int64_t carry = 0, d, top;
+  int zero = 1, ones = 1;
+  /* Non-negative digits with value V, plus carry*2^p = carry */
+  for (j = 0; j < n; j++) {
+    int64_t t = (int64_t)c->x[j] + carry, B = (int64_t)1 << c->bits[j];
+    int64_t lo = t & (B-1);
+    carry = (t - lo) / B;
+    c->x[j] = (double)lo;
+  }
+  /* Want V = -carry mod 2^p-1:  V is 0 or 2^p-1 with the low digit moved */
+  for (j = 1; j < n; j++) {
+    d = (int64_t)c->x[j];
+    if (d != 0) zero = 0;
+    if (d != ((int64_t)1 << c->bits[j]) - 1) ones = 0;
+  }
+  d = (int64_t)c->x[0];
+  top = ((int64_t)1 << c->bits[0]) - 1;
+  return (zero && d == -carry) || (ones && d == top - carry);
+}
+
+static int ll_run(UV p, UV n)
+{
+  llctx_t c;
+  UV iter, j;
+  int res = -1;
+
+  ll_init(&c, p, n);
+  memset(c.x, 0, n * sizeof(double));
+  c.x[0] = 4;
+  for (iter = 2; iter < p; iter++) {
+    for (j = 0; j < c.m; j++) {
+      c.re[j] = c.x[2*j]   * c.w[2*j];
+      c.im[j] = c.x[2*j+1] * c.w[2*j+1];
+    }
+    fft_dif(&c);
+    fft_square(&c);
+    fft_dit_inv(&c);
+    if (ll_carry(&c) > LL_MAX_ERR)
+      break;
+  }
+  if (iter == p)
+    res = ll_is_zero(&c);
+  ll_free(&c);
+  return res;
+}
+
+/* Balanced digits of b bits give convolution outputs near sqrt(n)*2^(2b-2),
+ * which must stay well inside the 53 bit mantissa.  Measured errors with
+ * this are under 0.1. */
+static UV ll_fft_length(UV p)
+{
+  UV n = 4;
+  while (1) {
+    double maxb = (49.5 - 0.75*log2((double)n)) / 2.0;
+    if ((double)((p + n - 1) / n) <= maxb)
+      return n;
+    n *= 2;
+  }
+}
+
+int lucas_lehmer_fft(UV p)
+{
+  UV n;
+  for (n = ll_fft_length(p); n < p; n *= 2) {
+    int res = ll_run(p, n);
+    if (res >= 0)
+      return res;
+  }
+  croak("lucas_lehmer: round-off error for p=%"UVuf, p);
+  return 0;
+}
@@ -0,0 +1,9 @@
+#ifndef MPU_MERSENNE_H
+#define MPU_MERSENNE_H
+
+#include "ptypes.h"
+
+/* Lucas-Lehmer test of 2^p-1 for odd prime p, using FFT squaring */
+extern int lucas_lehmer_fft(UV p);
+
+#endif
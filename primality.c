@@ -5,7 +5,9 @@
 
 #include "ptypes.h"
 #include "primality.h"
+#include "mersenne.h"
 #include "mulmod.h"
+#include "montmath.h"
 #define FUNC_gcd_ui 1
 #define FUNC_is_perfect_square
 #include "util.h"
@@ -14,114 +16,9 @@
 
 static const UV mr_bases_const2[1] = {2};
 
-/******************************************************************************
-  Code inside USE_MONT_PRIMALITY is Montgomery math and efficient M-R from
-  Wojciech Izykowski.  See:  https://github.com/wizykowski/miller-rabin
-
-Copyright (c) 2013-2014, Wojciech Izykowski
-All rights reserved.
-
-Redistribution and use in source and binary forms, with or without
-modification, are permitted provided that the following conditions are met:
-    * Redistributions of source code must retain the above copyright
-      notice, this list of conditions and the following disclaimer.
-    * Redistributions in binary form must reproduce the above copyright
-      notice, this list of conditions and the following disclaimer in the
-      documentation and/or other materials provided with the distribution.
-    * The name of the author may not be used to endorse or promote products
-      derived from this software without specific prior written permission.
-
-THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
-ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
-WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
-DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
-DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
-(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
-LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
-ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
-(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
-SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
-******************************************************************************/
+/* Montgomery math is in montmath.h, from Wojciech Izykowski's M-R code */
 #if USE_MONT_PRIMALITY
 
-#if defined(__GNUC__) && (__GNUC__ >= 3)
- #define MPU_UNLIKELY(x) __builtin_expect(!!(x), 0)
-#else
- #define MPU_UNLIKELY(x) (x)
-#endif
-
-static INLINE uint64_t mont_prod64(uint64_t a, uint64_t b, uint64_t n, uint64_t npi)
-{
-  uint64_t t_hi, t_lo, m, mn_hi, mn_lo, u;
-  /* t_hi * 2^64 + t_lo = a*b */
-  asm("mulq %3" : "=a"(t_lo), "=d"(t_hi) : "a"(a), "rm"(b));
-  if (MPU_UNLIKELY(t_lo == 0)) return t_hi;
-  m = t_lo * npi;
-  /* mn_hi * 2^64 + mn_lo = m*n */
-  asm("mulq %3" : "=a"(mn_lo), "=d"(mn_hi) : "a"(m), "rm"(n));
-  u = t_hi + mn_hi + 1;
-  return (u < t_hi || u >= n)  ?  u-n  :  u;
-}
-#define mont_square64(a, n, npi)  mont_prod64(a, a, n, npi)
-static INLINE UV mont_powmod64(uint64_t a, uint64_t k, uint64_t one, uint64_t n, uint64_t npi)
-{
-  uint64_t t = one;
-  while (k) {
-    if (k & 1) t = mont_prod64(t, a, n, npi);
-    k >>= 1;
-    if (k)     a = mont_square64(a, n, npi);
-  }
-  return t;
-}
-/* Returns -a^-1 mod 2^64.  From B. Arazi "On Primality Testing Using Purely
- * Divisionless Operations", Computer Journal (1994) 37 (3): 219-222, Proc 5 */
-static INLINE uint64_t modular_inverse64(const uint64_t a)
-{
-  uint64_t S = 1, J = 0;
-  int idx;
-  /* Basic algorithm:
-   *    for (i = 0; i < 64; i++) {
-   *      if (S & 1)  {  J |= (1ULL << i);  S += a;  }
-   *      S >>= 1;
-   *    }
-   * What follows is 8 bits at a time, unrolled by hand. */
-  static const char mask[128] = {255,85,51,73,199,93,59,17,15,229,195,89,215,237,203,33,31,117,83,105,231,125,91,49,47,5,227,121,247,13,235,65,63,149,115,137,7,157,123,81,79,37,3,153,23,45,11,97,95,181,147,169,39,189,155,113,111,69,35,185,55,77,43,129,127,213,179,201,71,221,187,145,143,101,67,217,87,109,75,161,159,245,211,233,103,253,219,177,175,133,99,249,119,141,107,193,191,21,243,9,135,29,251,209,207,165,131,25,151,173,139,225,223,53,19,41,167,61,27,241,239,197,163,57,183,205,171,1};
-
-  const char amask = mask[(a >> 1) & 127];
-  uint32_t T;
-  idx = (amask*(S&255)) & 255;  J = idx;                  S = (S+a*idx) >> 8;
-  idx = (amask*(S&255)) & 255;  J |= (uint64_t)idx << 8;  S = (S+a*idx) >> 8;
-  idx = (amask*(S&255)) & 255;  J |= (uint64_t)idx <<16;  S = (S+a*idx) >> 8;
-  idx = (amask*(S&255)) & 255;  J |= (uint64_t)idx <<24;  T = (S+a*idx) >> 8;
-  idx = (amask*(T&255)) & 255;  J |= (uint64_t)idx <<32;  T = (T+a*idx) >> 8;
-  idx = (amask*(T&255)) & 255;  J |= (uint64_t)idx <<40;  T = (T+a*idx) >> 8;
-  idx = (amask*(T&255)) & 255;  J |= (uint64_t)idx <<48;  T = (T+a*idx) >> 8;
-  idx = (amask*(T&255)) & 255;  J |= (uint64_t)idx <<56;
-  return J;
-}
-static INLINE uint64_t compute_modn64(const uint64_t n)
-{
-
-  if (n <= (1ULL << 63)) {
-    uint64_t res = ((1ULL << 63) % n) << 1;
-    return res < n ? res : res-n;
-  } else
-    return -n;
-}
-#define compute_a_times_2_64_mod_n(a, n, r)   mulmod(a, r, n)
-static INLINE uint64_t compute_2_65_mod_n(const uint64_t n, const uint64_t modn)
-{
-  if (n <= (1ULL << 63)) {
-    uint64_t res = modn << 1;
-    return res < n ? res : res - n;
-  } else {
-    /* n can fit 2 or 3 times in 2^65 */
-    if (n > UVCONST(12297829382473034410))
-      return -n-n;    /* 2^65 mod n = 2^65 - 2*n */
-    else
-      return -n-n-n;  /* 2^65 mod n = 2^65 - 3*n */
-  }
-}
 /* static INLINE int efficient_mr64(const uint64_t bases[], const int cnt, const uint64_t n) */
 static int monty_mr64(const uint64_t n, const UV* bases, int cnt)
 {
@@ -190,6 +87,105 @@ static UV select_extra_strong_parameters(UV n, UV increment) {
   return P;
 }
 
+#if USE_MONT_PRIMALITY
+/* U_k, V_k and Q^k for k > 0, all in Montgomery form.  P and Q pick the
+ * shortcuts, with montP, montQ and montD their Montgomery forms. */
+static void _mont_lucas_seq(UV* Uret, UV* Vret, UV* Qkret,
+                            const mont_ctx_t* m, IV P, IV Q,
+                            uint64_t montP, uint64_t montQ, uint64_t montD,
+                            UV k)
+{
+  const uint64_t n = m->n, npi = m->npi;
+  uint64_t U = m->one, V = montP, Qk;
+  UV b;
+  { UV v = k; b = 0; while (v >>= 1) b++; }
+
+  if (Q == 1 || Q == -1) {   /* Faster code for |Q|=1, also opt for P=1 */
+    int sign = Q;
+    while (b--) {
+      U = mont_prod64(U, V, n, npi);
+      if (sign == 1) V = submod( mont_square64(V,n,npi), m->two, n);
+      else           V = addmod( mont_square64(V,n,npi), m->two, n);
+      sign = 1;
+      if ( (k >> b) & UVCONST(1) ) {
+        uint64_t t2 = mont_prod64(U, montD, n, npi);
+        if (P == 1) {
+          U = addmod(U, V, n);
+          V = addmod(V, t2, n);
+        } else {
+          U = addmod( mont_prod64(U, montP, n, npi), V, n);
+          V = addmod( mont_prod64(V, montP, n, npi), t2, n);
+        }
+        if (U & 1) { U = (n>>1) + (U>>1) + 1; } else { U >>= 1; }
+        if (V & 1) { V = (n>>1) + (V>>1) + 1; } else { V >>= 1; }
+        sign = Q;
+      }
+    }
+    Qk = (sign == 1) ? m->one : n - m->one;
+  } else {
+    Qk = montQ;
+    while (b--) {
+      U = mont_prod64(U, V, n, npi);
+      V = submod( mont_square64(V,n,npi), addmod(Qk,Qk,n), n);
+      Qk = mont_square64(Qk,n,npi);
+      if ( (k >> b) & UVCONST(1) ) {
+        uint64_t t2 = mont_prod64(U, montD, n, npi);
+        U = addmod( mont_prod64(U, montP, n, npi), V, n);
+        if (U & 1) { U = (n>>1) + (U>>1) + 1; } else { U >>= 1; }
+        V = addmod( mont_prod64(V, montP, n, npi), t2, n);
+        if (V & 1) { V = (n>>1) + (V>>1) + 1; } else { V >>= 1; }
+        Qk = mont_prod64(Qk, montQ, n, npi);
+      }
+    }
+  }
+  *Uret = U;
+  *Vret = V;
+  *Qkret = Qk;
+}
+
+/* V_k and V_{k+1} for Q = 1 and k > 0, in Montgomery form. */
+static void _mont_lucas_vw(UV* Vret, UV* Wret, const mont_ctx_t* m,
+                           uint64_t montP, UV k)
+{
+  const uint64_t n = m->n, npi = m->npi, mont2 = m->two;
+  uint64_t V = montP;
+  uint64_t W = submod( mont_square64(montP, n, npi), mont2, n);
+  int b = 63 - __builtin_clzll(k);
+  while (b-- > 0) {
+    uint64_t T = submod( mont_prod64(V, W, n, npi), montP, n);
+    if ( (k >> b) & UVCONST(1) ) {
+      V = T;
+      W = submod( mont_square64(W, n, npi), mont2, n);
+    } else {
+      W = T;
+      V = submod( mont_square64(V, n, npi), mont2, n);
+    }
+  }
+  *Vret = V;
+  *Wret = W;
+}
+
+/* The extra strong Lucas test on V alone (Q = 1), as used by BPSW. */
+static int _mont_aes_lucas(const mont_ctx_t* m, UV P)
+{
+  const uint64_t n = m->n, npi = m->npi, mont2 = m->two;
+  UV V, W, d = n+1;
+  int s = __builtin_ctzll(d);
+
+  d >>= s;
+  _mont_lucas_vw(&V, &W, m, compute_a_times_2_64_mod_n(P, n, m->one), d);
+  if (V == mont2 || V == (n-mont2))
+    return 1;
+  while (s-- > 1) {
+    if (V == 0)
+      return 1;
+    V = submod( mont_square64(V, n, npi), mont2, n);
+    if (V == mont2)
+      return 0;
+  }
+  return 0;
+}
+#endif
 
 /* Fermat pseudoprime */
 int _XS_is_pseudoprime(UV const n, UV a)
@@ -258,68 +254,197 @@ int _XS_BPSW(UV const n)
          && _XS_is_almost_extra_strong_lucas_pseudoprime(n,1);
 #else
   {
-    const uint64_t npi = modular_inverse64(n);
-    const uint64_t montr = compute_modn64(n);
-    const uint64_t mont2 = compute_2_65_mod_n(n, montr);
-    uint64_t u = n-1;
-    const uint64_t nr = n-montr;
+    mont_ctx_t m;
+    uint64_t u = n-1, nr;
     int i, t = 0;
-    UV P, V, d, s;
+    UV P;
 
+    mont_ctx_init(&m, n);
+    nr = n - m.one;
     /* M-R with base 2 */
     while (!(u&1)) {  t++;  u >>= 1;  }
     {
-      uint64_t A = mont2;
-      if (A) {
-        uint64_t d = mont_powmod64(A, u, montr, n, npi);
-        if (d != montr && d != nr) {
-          for (i=1; i<t; i++) {
-            d = mont_square64(d, n, npi);
-            if (d == montr) return 0;
-            if (d == nr) break;
-          }
-          if (i == t)
-            return 0;
+      uint64_t d = mont_pow2_64(u, m.two, n, m.npi);
+      if (d != m.one && d != nr) {
+        for (i=1; i<t; i++) {
+          d = mont_square64(d, n, m.npi);
+          if (d == m.one) return 0;
+          if (d == nr) break;
         }
+        if (i == t)
+          return 0;
       }
     }
     /* AES Lucas test */
     P = select_extra_strong_parameters(n, 1);
     if (P == 0) return 0;
+    return _mont_aes_lucas(&m, P);
+  }
+#endif
+}
 
-    d = n+1;
-    s = 0;
-    while ( (d & 1) == 0 ) {  s++;  d >>= 1; }
+/* is_prob_prime over an array, results (0 or 2) stored in res.
+ *
+ * With Montgomery math, inputs above 2^32 that pass trial division are
+ * queued and run through AES-BPSW BATCH_LANES at a time.  Each step of the
+ * base 2 M-R and of the Lucas ladder is done for all lanes together, so the
+ * CPU has several independent multiply chains to overlap.  There is no
+ * vector 64x64->128 multiply on x86 (IFMA is 52-bit), so this beats trying
+ * to put the lanes in SIMD registers. */
+#if USE_MONT_PRIMALITY
+#define BATCH_LANES 4
+
+typedef struct {
+  uint64_t n[BATCH_LANES];
+  UV       P[BATCH_LANES];
+  UV       idx[BATCH_LANES];
+  int      cnt;
+} bpsw_queue_t;
+
+/* Base 2 M-R.  Leading zero bits leave the accumulator at 1, so every lane
+ * walks the longest exponent. */
+static void _mr2_lanes(const uint64_t* n, int* res)
+{
+  uint64_t npi[BATCH_LANES], r[BATCH_LANES], k[BATCH_LANES], x[BATCH_LANES];
+  int t[BATCH_LANES], i, j, b, bits = 0;
+
+  for (j = 0; j < BATCH_LANES; j++) {
+    npi[j] = modular_inverse64(n[j]);
+    r[j] = compute_modn64(n[j]);
+    x[j] = r[j];
+    t[j] = __builtin_ctzll(n[j]-1);
+    k[j] = (n[j]-1) >> t[j];
+    b = 64 - __builtin_clzll(k[j]);
+    if (b > bits) bits = b;
+  }
+  while (bits-- > 0)
+    for (j = 0; j < BATCH_LANES; j++) {
+      x[j] = mont_square64(x[j], n[j], npi[j]);
+      x[j] = addmod(x[j], x[j] & -((k[j] >> bits) & 1), n[j]);
+    }
+  for (j = 0; j < BATCH_LANES; j++) {
+    uint64_t d = x[j], nr = n[j]-r[j];
+    res[j] = (d == r[j] || d == nr);
+    for (i = 1; i < t[j] && !res[j]; i++) {
+      d = mont_square64(d, n[j], npi[j]);
+      if (d == r[j]) break;
+      res[j] = (d == nr);
+    }
+  }
+}
 
-    {
-      const uint64_t montP = compute_a_times_2_64_mod_n(P, n, montr);
-      UV W, b;
-      W = submod(  mont_prod64( montP, montP, n, npi),  mont2, n);
-      V = montP;
-      { UV v = d; b = 1; while (v >>= 1) b++; }
-      while (b-- > 1) {
-        UV T = submod(  mont_prod64(V, W, n, npi),  montP, n);
-        if ( (d >> (b-1)) & UVCONST(1) ) {
-          V = T;
-          W = submod(  mont_prod64(W, W, n, npi),  mont2, n);
-        } else {
-          W = T;
-          V = submod(  mont_prod64(V, V, n, npi),  mont2, n);
-        }
-      }
+/* AES Lucas test with parameter P[j] for lane j.  The ladder starts from
+ * (V_0,V_1) so leading zero bits are harmless, and the step is branch free. */
+static void _aes_lucas_lanes(const uint64_t* n, const UV* P, int* res)
+{
+  uint64_t npi[BATCH_LANES], m2[BATCH_LANES], mP[BATCH_LANES];
+  uint64_t d[BATCH_LANES], V[BATCH_LANES], W[BATCH_LANES];
+  int s[BATCH_LANES], i, j, b, bits = 0;
+
+  for (j = 0; j < BATCH_LANES; j++) {
+    uint64_t r = compute_modn64(n[j]);
+    npi[j] = modular_inverse64(n[j]);
+    m2[j] = compute_2_65_mod_n(n[j], r);
+    mP[j] = compute_a_times_2_64_mod_n(P[j], n[j], r);
+    s[j] = __builtin_ctzll(n[j]+1);
+    d[j] = (n[j]+1) >> s[j];
+    V[j] = m2[j];
+    W[j] = mP[j];
+    b = 64 - __builtin_clzll(d[j]);
+    if (b > bits) bits = b;
+  }
+  while (bits-- > 0)
+    for (j = 0; j < BATCH_LANES; j++) {
+      uint64_t mask = -((d[j] >> bits) & 1);
+      uint64_t T = submod(mont_prod64(V[j], W[j], n[j], npi[j]), mP[j], n[j]);
+      uint64_t S = V[j] ^ ((V[j] ^ W[j]) & mask);
+      uint64_t Q = submod(mont_square64(S, n[j], npi[j]), m2[j], n[j]);
+      V[j] = Q ^ ((Q ^ T) & mask);
+      W[j] = T ^ ((T ^ Q) & mask);
     }
+  for (j = 0; j < BATCH_LANES; j++) {
+    uint64_t v = V[j];
+    res[j] = (v == m2[j] || v == n[j]-m2[j]);
+    for (i = 1; i < s[j] && !res[j]; i++) {
+      if (v == 0) { res[j] = 1; break; }
+      v = submod(mont_square64(v, n[j], npi[j]), m2[j], n[j]);
+      if (v == m2[j]) break;
+    }
+  }
+}
 
-    if (V == mont2 || V == (n-mont2))
-      return 1;
-    while (s-- > 1) {
-      if (V == 0)
-        return 1;
-      V = submod(  mont_prod64(V, V, n, npi),  mont2, n);
-      if (V == mont2)
-        return 0;
+static void _lucas_flush(bpsw_queue_t* lq, unsigned char* res)
+{
+  int j, pass[BATCH_LANES];
+  if (lq->cnt == 0) return;
+  for (j = lq->cnt; j < BATCH_LANES; j++) {
+    lq->n[j] = lq->n[0];
+    lq->P[j] = lq->P[0];
+  }
+  _aes_lucas_lanes(lq->n, lq->P, pass);
+  for (j = 0; j < lq->cnt; j++)
+    res[lq->idx[j]] = 2*pass[j];
+  lq->cnt = 0;
+}
+
+static void _mr_flush(bpsw_queue_t* mq, bpsw_queue_t* lq, unsigned char* res)
+{
+  int j, pass[BATCH_LANES];
+  if (mq->cnt == 0) return;
+  for (j = mq->cnt; j < BATCH_LANES; j++)
+    mq->n[j] = mq->n[0];
+  _mr2_lanes(mq->n, pass);
+  for (j = 0; j < mq->cnt; j++) {
+    UV P;
+    if (!pass[j]) continue;
+    P = select_extra_strong_parameters(mq->n[j], 1);
+    if (P == 0) continue;
+    lq->n[lq->cnt] = mq->n[j];
+    lq->P[lq->cnt] = P;
+    lq->idx[lq->cnt] = mq->idx[j];
+    if (++lq->cnt == BATCH_LANES)
+      _lucas_flush(lq, res);
+  }
+  mq->cnt = 0;
+}
+
+/* The same trial division as is_prob_prime, with two divisions for all. */
+static int _has_factor_2_53(uint64_t n)
+{
+  uint32_t a;
+  uint64_t b;
+  if (!(n & 1)) return 1;
+  a = n % UVCONST(3234846615);   /* 3*5*7*11*13*17*19*23*29 */
+  b = n % UVCONST(5037203051);   /* 31*37*41*43*47*53 */
+  return !(a%3) || !(a%5) || !(a%7) || !(a%11) || !(a%13) || !(a%17) ||
+         !(a%19) || !(a%23) || !(a%29) || !(b%31) || !(b%37) || !(b%41) ||
+         !(b%43) || !(b%47) || !(b%53);
+}
+#endif
+
+void is_prob_prime_batch(const UV* n, UV count, unsigned char* res)
+{
+  UV i;
+#if !USE_MONT_PRIMALITY
+  for (i = 0; i < count; i++)
+    res[i] = is_prob_prime(n[i]);
+#else
+  bpsw_queue_t mq, lq;
+  mq.cnt = lq.cnt = 0;
+  for (i = 0; i < count; i++) {
+    if (n[i] <= 0xFFFFFFFFU) {
+      res[i] = is_prob_prime(n[i]);
+      continue;
     }
+    res[i] = 0;
+    if (_has_factor_2_53(n[i])) continue;
+    mq.n[mq.cnt] = n[i];
+    mq.idx[mq.cnt] = i;
+    if (++mq.cnt == BATCH_LANES)
+      _mr_flush(&mq, &lq, res);
   }
-  return 0;
+  _mr_flush(&mq, &lq, res);
+  _lucas_flush(&lq, res);
 #endif
 }
 
@@ -346,6 +471,20 @@ void lucas_seq(UV* Uret, UV* Vret, UV* Qkret, UV n, IV P, IV Q, UV k)
     *Qkret = powmod(Qmod, k, n);
     return;
   }
+#if USE_MONT_PRIMALITY
+  if (n & 1) {
+    mont_ctx_t m;
+    mont_ctx_init(&m, n);
+    _mont_lucas_seq(&U, &V, &Qk, &m, P, Q,
+                    compute_a_times_2_64_mod_n(Pmod, n, m.one),
+                    compute_a_times_2_64_mod_n(Qmod, n, m.one),
+                    compute_a_times_2_64_mod_n(Dmod, n, m.one), k);
+    *Uret = mont_to_uv(&m, U);
+    *Vret = mont_to_uv(&m, V);
+    *Qkret = mont_to_uv(&m, Qk);
+    return;
+  }
+#endif
   U = 1;
   V = Pmod;
   Qk = Qmod;
@@ -533,60 +672,22 @@ int _XS_is_lucas_pseudoprime(UV n, int strength)
 
 #if USE_MONT_PRIMALITY
   {
-    const uint64_t npi = modular_inverse64(n);
-    const uint64_t mont1 = compute_modn64(n);
-    const uint64_t mont2 = compute_2_65_mod_n(n, mont1);
-    const uint64_t montP = (P == 1) ? mont1
-                         : (P >= 0) ? compute_a_times_2_64_mod_n(P, n, mont1)
-                         : n - compute_a_times_2_64_mod_n(-P, n, mont1);
-    const uint64_t montD = (D >= 0) ? compute_a_times_2_64_mod_n(D, n, mont1)
-                         : n - compute_a_times_2_64_mod_n(-D, n, mont1);
-    UV b;
-    { UV v = d; b = 0; while (v >>= 1) b++; }
-
+    mont_ctx_t m;
+    uint64_t npi, mont2;
+    mont_ctx_init(&m, n);
+    npi = m.npi;
+    mont2 = m.two;
     /* U, V, Qk, and mont* are in Montgomery space */
-    U = mont1;
-    V = montP;
-
-    if (Q == 1 || Q == -1) {   /* Faster code for |Q|=1, also opt for P=1 */
-      int sign = Q;
-      while (b--) {
-        U = mont_prod64(U, V, n, npi);
-        if (sign == 1) V = submod( mont_square64(V,n,npi), mont2, n);
-        else           V = addmod( mont_square64(V,n,npi), mont2, n);
-        sign = 1;
-        if ( (d >> b) & UVCONST(1) ) {
-          UV t2 = mont_prod64(U, montD, n, npi);
-          if (P == 1) {
-            U = addmod(U, V, n);
-            V = addmod(V, t2, n);
-          } else {
-            U = addmod( mont_prod64(U, montP, n, npi), V, n);
-            V = addmod( mont_prod64(V, montP, n, npi), t2, n);
-          }
-          if (U & 1) { U = (n>>1) + (U>>1) + 1; } else { U >>= 1; }
-          if (V & 1) { V = (n>>1) + (V>>1) + 1; } else { V >>= 1; }
-          sign = Q;
-        }
-      }
-      Qk = (sign == 1) ? mont1 : n-mont1;
+    if (strength == 2) {
+      /* Q = 1, so V_d and V_{d+1} give U_d by D*U_d = 2V_{d+1} - P*V_d.
+       * D is coprime to n, so U_d = 0 exactly when 2V_{d+1} = P*V_d. */
+      const uint64_t montP = compute_a_times_2_64_mod_n(P, n, m.one);
+      UV W;
+      _mont_lucas_vw(&V, &W, &m, montP, d);
+      U = submod( addmod(W, W, n), mont_prod64(montP, V, n, npi), n);
     } else {
-      const uint64_t montQ = (Q >= 0) ? compute_a_times_2_64_mod_n(Q, n, mont1)
-                           : n - compute_a_times_2_64_mod_n(-Q, n, mont1);
-      Qk = montQ;
-      while (b--) {
-        U = mont_prod64(U, V, n, npi);
-        V = submod( mont_square64(V,n,npi), addmod(Qk,Qk,n), n);
-        Qk = mont_square64(Qk,n,npi);
-        if ( (d >> b) & UVCONST(1) ) {
-          UV t2 = mont_prod64(U, montD, n, npi);
-          U = addmod( mont_prod64(U, montP, n, npi), V, n);
-          if (U & 1) { U = (n>>1) + (U>>1) + 1; } else { U >>= 1; }
-          V = addmod( mont_prod64(V, montP, n, npi), t2, n);
-          if (V & 1) { V = (n>>1) + (V>>1) + 1; } else { V >>= 1; }
-          Qk = mont_prod64(Qk, montQ, n, npi);
-        }
-      }
+      _mont_lucas_seq(&U, &V, &Qk, &m, P, Q, mont_from_iv(&m, P),
+                      mont_from_iv(&m, Q), mont_from_iv(&m, D), d);
     }
     if (strength == 0) {
       if (U == 0)
@@ -665,7 +766,7 @@ int _XS_is_lucas_pseudoprime(UV n, int strength)
  */
 int _XS_is_almost_extra_strong_lucas_pseudoprime(UV n, UV increment)
 {
-  UV P, V, W, d, s, b;
+  UV P;
 
   if (n < 7) return (n == 2 || n == 3 || n == 5);
   if ((n % 2) == 0 || n == UV_MAX) return 0;
@@ -675,105 +776,107 @@ int _XS_is_almost_extra_strong_lucas_pseudoprime(UV n, UV increment)
   P = select_extra_strong_parameters(n, increment);
   if (P == 0) return 0;
 
-  d = n+1;
-  s = 0;
-  while ( (d & 1) == 0 ) {  s++;  d >>= 1; }
-  { UV v = d; b = 0; while (v >>= 1) b++; }
-
 #if USE_MONT_PRIMALITY
   {
-    const uint64_t npi = modular_inverse64(n);
-    const uint64_t montr = compute_modn64(n);
-    const uint64_t mont2 = compute_2_65_mod_n(n, montr);
-    const uint64_t montP = compute_a_times_2_64_mod_n(P, n, montr);
-    W = submod(  mont_prod64( montP, montP, n, npi),  mont2, n);
-    V = montP;
+    mont_ctx_t m;
+    mont_ctx_init(&m, n);
+    return _mont_aes_lucas(&m, P);
+  }
+#else
+  {
+    UV V, W, d, s, b;
+    d = n+1;
+    s = 0;
+    while ( (d & 1) == 0 ) {  s++;  d >>= 1; }
+    { UV v = d; b = 0; while (v >>= 1) b++; }
+
+    W = mulsubmod(P, P, 2, n);
+    V = P;
     while (b--) {
-      UV T = submod(  mont_prod64(V, W, n, npi),  montP, n);
+      UV T = mulsubmod(V, W, P, n);
       if ( (d >> b) & UVCONST(1) ) {
         V = T;
-        W = submod(  mont_prod64(W, W, n, npi),  mont2, n);
+        W = mulsubmod(W, W, 2, n);
       } else {
         W = T;
-        V = submod(  mont_prod64(V, V, n, npi),  mont2, n);
+        V = mulsubmod(V, V, 2, n);
       }
     }
-
-    if (V == mont2 || V == (n-mont2))
+    if (V == 2 || V == (n-2))
       return 1;
-    s--;
-    while (s--) {
+    while (s-- > 1) {
       if (V == 0)
         return 1;
-      if (s)
-        V = submod(  mont_prod64(V, V, n, npi),  mont2, n);
-    }
-    return 0;
-  }
-#else
-  W = mulsubmod(P, P, 2, n);
-  V = P;
-  while (b--) {
-    UV T = mulsubmod(V, W, P, n);
-    if ( (d >> b) & UVCONST(1) ) {
-      V = T;
-      W = mulsubmod(W, W, 2, n);
-    } else {
-      W = T;
       V = mulsubmod(V, V, 2, n);
+      if (V == 2)
+        return 0;
     }
+    return 0;
   }
-  if (V == 2 || V == (n-2))
-    return 1;
-  while (s-- > 1) {
-    if (V == 0)
-      return 1;
-    V = mulsubmod(V, V, 2, n);
-    if (V == 2)
-      return 0;
-  }
-  return 0;
 #endif
 }
 
-static void mat_mulmod_3x3(UV* a, UV* b, UV n) {
-  int i, row, col;
-  UV i1, i2, i3, t[9];
-  for (row = 0; row < 3; row++) {
-    for (col = 0; col < 3; col++) {
-      if (n < HALF_WORD/2) {
-        i1 = a[3*row+0] * b[0+col];
-        i2 = a[3*row+1] * b[3+col];
-        i3 = a[3*row+2] * b[6+col];
-        t[3*row+col] = (i1 + i2 + i3) % n;
-      } else {
-        i1 = mulmod(a[3*row+0], b[0+col], n);
-        i2 = mulmod(a[3*row+1], b[3+col], n);
-        i3 = mulmod(a[3*row+2], b[6+col], n);
-        t[3*row+col] = addmod( addmod(i1, i2, n), i3, n );
-      }
-    }
-  }
-  for (i = 0; i < 9; i++) a[i] = t[i];
-}
-static void mat_powmod_3x3(UV* m, UV k, UV n) {
-  UV res[9] = {1,0,0, 0,1,0, 0,0,1};
-  int i;
-
-  while (k) {
-    if (k & 1)  mat_mulmod_3x3(res, m, n);
-    k >>= 1;
-    if (k)      mat_mulmod_3x3(m, m, n);
-  }
-  for (i = 0; i < 9; i++)  m[i] = res[i];
-}
+/* The Perrin number A(n) = r1^n + r2^n + r3^n for the roots of x^3-x-1.
+ * As r1*r2*r3 = 1, B(n) = A(-n) is the same sum for the roots of x^3+x^2-1,
+ * and the products of pairs of roots give (Adams and Shanks 1982):
+ *
+ *   A(2k)   = A(k)^2 - 2B(k)           B(2k)   = B(k)^2 - 2A(k)
+ *   A(2k+1) = A(k)A(k+1) + B(k-1)      B(2k+1) = B(k)B(k+1) + A(k) + A(k-1)
+ *
+ * with A(2k-1) = A(2k+2) - A(2k) and B(2k-1) = B(2k+2) + B(2k+1) from the
+ * recurrences.  So the signatures A(k-1..k+1), B(k-1..k+1) double with six
+ * products per bit, where the 3x3 matrix power took 54. */
+#define PERRIN_DOUBLE(MUL, SQR) \
+  do { \
+    UV a2 = submod(SQR(a[1]), addmod(b[1],b[1],n), n); \
+    UV a3 = addmod(MUL(a[1],a[2]), b[0], n); \
+    UV a4 = submod(SQR(a[2]), addmod(b[2],b[2],n), n); \
+    UV b2 = submod(SQR(b[1]), addmod(a[1],a[1],n), n); \
+    UV b3 = addmod(MUL(b[1],b[2]), addmod(a[1],a[0],n), n); \
+    UV b4 = submod(SQR(b[2]), addmod(a[2],a[2],n), n); \
+    if ( (n >> bit) & UVCONST(1) ) { \
+      a[0] = a2;  a[1] = a3;  a[2] = a4; \
+      b[0] = b2;  b[1] = b3;  b[2] = b4; \
+    } else { \
+      a[0] = submod(a4, a2, n);  a[1] = a2;  a[2] = a3; \
+      b[0] = addmod(b4, b3, n);  b[1] = b2;  b[2] = b3; \
+    } \
+  } while (0)
 
 int is_perrin_pseudoprime(UV n)
 {
-  UV m[9] = {0,1,0, 0,0,1, 1,1,0};
-  mat_powmod_3x3(m, n, n);
-  /* P(n) = sum of diagonal  =  3*top-left + 2*top-right */
-  return (addmod( addmod(m[0], m[4], n), m[8], n) == 0);
+  UV a[3], b[3];
+  int bit;
+
+  if (n < 3) return (n >= 1);
+  bit = BITS_PER_WORD - 1;
+  while (!((n >> bit) & UVCONST(1))) bit--;
+
+#if USE_MONT_PRIMALITY
+  if (n & 1) {
+    const uint64_t npi = modular_inverse64(n), mont1 = compute_modn64(n);
+    const uint64_t mont2 = compute_2_65_mod_n(n, mont1);
+#define MONT_MUL(x,y)  mont_prod64(x, y, n, npi)
+#define MONT_SQR(x)    mont_square64(x, n, npi)
+    /* A(0..2) = 3,0,2 and B(0..2) = 3,-1,1 */
+    a[0] = addmod(mont1, mont2, n);  a[1] = 0;          a[2] = mont2;
+    b[0] = a[0];                     b[1] = n - mont1;  b[2] = mont1;
+    while (bit-- > 0)
+      PERRIN_DOUBLE(MONT_MUL, MONT_SQR);
+#undef MONT_MUL
+#undef MONT_SQR
+    return (a[1] == 0);
+  }
+#endif
+#define PLAIN_MUL(x,y)  mulmod(x, y, n)
+#define PLAIN_SQR(x)    sqrmod(x, n)
+  a[0] = 3 % n;  a[1] = 0;      a[2] = 2 % n;
+  b[0] = a[0];   b[1] = n - 1;  b[2] = 1;
+  while (bit-- > 0)
+    PERRIN_DOUBLE(PLAIN_MUL, PLAIN_SQR);
+#undef PLAIN_MUL
+#undef PLAIN_SQR
+  return (a[1] == 0);
 }
 
 int is_frobenius_pseudoprime(UV n, IV P, IV Q)
@@ -818,7 +921,17 @@ int is_frobenius_pseudoprime(UV n, IV P, IV Q)
     Vcomp = (k == 1)  ?  2  :  Q >= 0 ? Qu : n-Qu;
   }
 
+#if USE_MONT_PRIMALITY
+  {
+    mont_ctx_t m;
+    mont_ctx_init(&m, n);
+    _mont_lucas_seq(&U, &V, &Qk, &m, P, Q, mont_from_iv(&m, P),
+                    mont_from_iv(&m, Q), mont_from_iv(&m, D), n-k);
+    Vcomp = compute_a_times_2_64_mod_n(Vcomp, n, m.one);
+  }
+#else
   lucas_seq(&U, &V, &Qk, n, P, Q, n-k);
+#endif
   /* if (_XS_get_verbose()) printf("%"UVuf" Frobenius U = %"UVuf" V = %"UVuf"\n", n, U, V); */
   if (U == 0 && V == Vcomp) return 1;
   return 0;
@@ -856,10 +969,11 @@ int _XS_is_frobenius_underwood_pseudoprime(UV n)
 
 #if USE_MONT_PRIMALITY
   {
-    const uint64_t npi = modular_inverse64(n);
-    const uint64_t mont1 = compute_modn64(n);
-    const uint64_t mont2 = compute_2_65_mod_n(n, mont1);
-    const uint64_t mont5 = compute_a_times_2_64_mod_n(5, n, mont1);
+    mont_ctx_t m;
+    uint64_t npi, mont1, mont2, mont5;
+    mont_ctx_init(&m, n);
+    npi = m.npi;  mont1 = m.one;  mont2 = m.two;
+    mont5 = compute_a_times_2_64_mod_n(5, n, mont1);
 
     x = compute_a_times_2_64_mod_n(x, n, mont1);
     a = mont1;
@@ -931,11 +1045,11 @@ int _XS_is_frobenius_underwood_pseudoprime(UV n)
 #endif
 }
 
-/* We have a native-UV Lucas-Lehmer test with simple pretest.  If 2^p-1 is
- * prime but larger than a UV, we'll have to bail, and they'll run the nice
- * GMP version.  However, they're just asking if this is a Mersenne prime, and
- * there are millions of CPU years that have gone into enumerating them, so
- * instead we'll use a table. */
+/* We have a native-UV Lucas-Lehmer test with simple pretest, and an FFT
+ * version for larger p.  However, they're just asking if this is a Mersenne
+ * prime, and there are millions of CPU years that have gone into
+ * enumerating them, so instead we'll use a table below the last exponent
+ * GIMPS has checked. */
 #define NUM_KNOWN_MERSENNE_PRIMES 48
 static const uint32_t _mersenne_primes[NUM_KNOWN_MERSENNE_PRIMES] = {2,3,5,7,13,17,19,31,61,89,107,127,521,607,1279,2203,2281,3217,4253,4423,9689,9941,11213,19937,21701,23209,44497,86243,110503,132049,216091,756839,859433,1257787,1398269,2976221,3021377,6972593,13466917,20996011,24036583,25964951,30402457,32582657,37156667,42643801,43112609,57885161};
 #define LAST_CHECKED_MERSENNE 32593019
@@ -945,7 +1059,7 @@ int is_mersenne_prime(UV p)
   for (i = 0; i < NUM_KNOWN_MERSENNE_PRIMES; i++)
     if (p == _mersenne_primes[i])
       return 1;
-  return (p < LAST_CHECKED_MERSENNE) ? 0 : -1;
+  return (p < LAST_CHECKED_MERSENNE) ? 0 : lucas_lehmer(p);
 }
 int lucas_lehmer(UV p)
 {
@@ -953,7 +1067,18 @@ int lucas_lehmer(UV p)
 
   if (p == 2) return 1;
   if (!is_prob_prime(p))  return 0;
-  if (p > BITS_PER_WORD) croak("lucas_lehmer with p > BITS_PER_WORD");
+  if (p > BITS_PER_WORD) {
+    /* Factors of 2^p-1 are 2kp+1 and 1 or 7 mod 8 */
+    UV kmax = (p > (UV_MAX >> 21)) ? 0 : 1000000;
+    if (p % 4 == 3 && p < (UV_MAX >> 1) && is_prob_prime(2*p+1))
+      return 0;
+    for (k = 1; k <= kmax; k++) {
+      UV q = 2*k*p+1;
+      if ((q & 7) != 1 && (q & 7) != 7)  continue;
+      if (powmod(2, p, q) == 1)  return 0;
+    }
+    return lucas_lehmer_fft(p);
+  }
   V = 4;
   mp = UV_MAX >> (BITS_PER_WORD - p);
   for (k = 3; k <= p; k++) {
@@ -966,14 +1091,62 @@ int lucas_lehmer(UV p)
 /******************************************************************************/
 
 
+/* M-R base 2 followed by one base chosen by a hash of n is deterministic
+ * for all n < 2^32 (Forisek and Jancina, 2015).  The bases cover the 2314
+ * base-2 strong pseudoprimes below 2^32 and were made, then checked against
+ * every one of them, by xt/make-mr32-hash.c.  Build with -DUSE_MR_HASH32=0
+ * to use the fixed base sets instead. */
+#ifndef USE_MR_HASH32
+  #define USE_MR_HASH32 1
+#endif
+#if USE_MR_HASH32
+static const uint16_t mr_bases_hash32[256] = {
+  6,5,5,5,3,3,5,3,3,7,3,3,
+  5,5,3,17,3,5,3,5,3,7,3,3,
+  3,3,3,14,3,5,3,3,5,3,3,3,
+  3,3,3,5,3,3,3,5,3,3,5,3,
+  3,5,3,3,7,3,5,3,3,3,3,3,
+  3,5,3,3,3,3,3,3,3,3,3,3,
+  3,5,3,5,3,3,3,5,3,3,3,3,
+  7,5,11,5,7,5,3,5,3,5,7,7,
+  3,5,3,3,3,3,3,3,3,5,3,5,
+  3,3,3,5,7,3,3,3,5,3,7,5,
+  3,3,3,3,3,7,3,3,5,3,3,3,
+  5,3,3,3,3,5,3,11,3,3,3,5,
+  7,3,5,3,3,3,3,15,3,7,3,5,
+  5,5,3,3,3,3,3,3,5,3,5,3,
+  3,7,7,3,5,7,5,3,3,5,5,5,
+  3,3,5,15,3,3,3,5,3,3,5,3,
+  5,5,5,3,5,3,7,3,3,3,3,5,
+  5,3,3,5,3,11,3,5,3,3,3,3,
+  3,3,3,3,5,5,3,3,3,3,3,3,
+  3,3,3,3,3,3,3,7,3,3,5,17,
+  3,3,3,5,3,3,3,3,3,5,3,7,
+  3,5,11,7};
+static int _mr_hash32(UV n) {
+  uint32_t x = n;
+  UV bases[2];
+  x = ((x >> 16) ^ x) * 0x45d9f3b;
+  x = ((x >> 16) ^ x) * 0x45d9f3b;
+  x = ((x >> 16) ^ x);
+  bases[0] = 2;
+  bases[1] = mr_bases_hash32[x & 255];
+  return _XS_miller_rabin(n, bases, 2);
+}
+#endif
+
 /* Select M-R bases from http://miller-rabin.appspot.com/, 26 July 2013 */
 #if BITS_PER_WORD == 32
 static const UV mr_bases_small_2[2] = {31, 73};
+#if !USE_MR_HASH32
 static const UV mr_bases_small_3[3] = {2, 7, 61};
+#endif
 #else
 static const UV mr_bases_large_1[1] = { UVCONST(  9345883071009581737 ) };
+#if !USE_MR_HASH32
 static const UV mr_bases_large_2[2] = { UVCONST(         336781006125 ),
                                         UVCONST(     9639812373923155 ) };
+#endif
 #if 0
 static const UV mr_bases_large_3[3] = { UVCONST(  4230279247111683200 ),
                                         UVCONST( 14694767155120705706 ),
@@ -1034,14 +1207,23 @@ int is_prob_prime(UV n)
   if (n < UVCONST(9080191))
     ret = _XS_miller_rabin(n, mr_bases_small_2, 2);
   else
+#if USE_MR_HASH32
+    ret = _mr_hash32(n);
+#else
     ret = _XS_miller_rabin(n, mr_bases_small_3, 3);
+#endif
 #else
   /* AESLSP test costs about 1.5 Selfridges, vs. ~2.2 for strong Lucas.
    * So it works out to be faster to do AES-BPSW vs. 3 M-R tests. */
   if (n < UVCONST(341531))
     ret = _XS_miller_rabin(n, mr_bases_large_1, 1);
+#if USE_MR_HASH32
+  else if (n < UVCONST(4294967296))
+    ret = _mr_hash32(n);
+#else
   else if (n < UVCONST(1050535501))
     ret = _XS_miller_rabin(n, mr_bases_large_2, 2);
+#endif
   else
     ret = _XS_BPSW(n);
   /*
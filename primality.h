@@ -24,5 +24,6 @@ extern int lucasv(IV* V, IV P, IV Q, UV k);
 
 extern int _XS_BPSW(UV const n);
 extern int is_prob_prime(UV n);
+extern void is_prob_prime_batch(const UV* n, UV count, unsigned char* res);
 
 #endif
@@ -0,0 +1,215 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Base 2 strong pseudoprimes and Carmichael numbers in a range, without
+ * testing every odd number.
+ *
+ * If p | n and n is a base 2 Fermat pseudoprime, then ord_p(2) | n-1, and
+ * as p = 1 mod ord_p(2) this is n/p = 1 mod ord_p(2).  Korselt's criterion
+ * gives the same for Carmichael numbers with p-1 in place of the order.
+ * So each odd multiple of a sieving prime p is either allowed or ruled out
+ * by p.  If p^2 | n it is ruled out as well, unless p is a Wieferich prime
+ * (Carmichael numbers are squarefree, so there it always is).  This is the
+ * first stage of Feitsma's search, with the structural conditions Pinch
+ * used for Carmichael numbers.
+ *
+ * The range is sieved in segments, walking only the allowed progression of
+ * each sieving prime and keeping the product of the allowed factors of each
+ * odd n.  Every small factor of a pseudoprime is allowed, so n/product must
+ * be 1 or a prime larger than the sieving primes, and that cofactor can be
+ * checked cheaply before a strong test (or a Fermat test and Korselt's
+ * criterion) on n.  If the sieving primes stop short of sqrt(hi), numbers
+ * with no small factor may be pseudoprimes too, so those get the test and
+ * then BPSW to set the primes aside.
+ *
+ * Copyright 2015, Dana Jacobsen.
+ */
+
+#include "ptypes.h"
+#include "pseudoprimes.h"
+#define FUNC_isqrt 1
+#define FUNC_gcd_ui 1
+#include "util.h"
+#include "sieve.h"
+#include "cache.h"
+#include "primality.h"
+#include "factor.h"
+#include "mulmod.h"
+
+/* Sieving primes stop at sqrt(hi), but orders are not worth computing for
+ * many more primes than an eighth of the range. */
+#define PSP_MAX_SIEVE_PRIME  16777216
+#define PSP_MIN_SEGMENT      65536
+
+/* ord_p(2) for an odd prime p */
+static UV _order2(UV p)
+{
+  UV fac[MPU_MAX_FACTORS+1], exp[MPU_MAX_FACTORS+1], k = p-1;
+  int i, nfactors = factor_exp(p-1, fac, exp);
+  for (i = 0; i < nfactors; i++) {
+    UV j;
+    for (j = 0; j < exp[i] && powmod(2, k/fac[i], p) == 1; j++)
+      k /= fac[i];
+  }
+  return k;
+}
+
+static int _is_korselt(UV n)
+{
+  UV fac[MPU_MAX_FACTORS+1], exp[MPU_MAX_FACTORS+1];
+  int i, nfactors = factor_exp(n, fac, exp);
+  if (nfactors < 3) return 0;
+  for (i = 0; i < nfactors; i++)
+    if (exp[i] > 1 || (n-1) % (fac[i]-1) != 0)
+      return 0;
+  return 1;
+}
+
+/* Is n in the set?  allowed is set if the sieve found an allowed factor. */
+static int _psp_test(UV n, int carmichael, int allowed)
+{
+  static const UV base2[1] = {2};
+  if (!carmichael) {
+    if (!_XS_miller_rabin(n, base2, 1))  return 0;
+    return allowed || !_XS_is_almost_extra_strong_lucas_pseudoprime(n, 1);
+  }
+  if (!_XS_is_pseudoprime(n, 2))  return 0;
+  if (!allowed && is_prob_prime(n))  return 0;
+  return _is_korselt(n);
+}
+
+/* n = m*q with q > B prime.  For a pseudoprime ord_q(2) divides n-1 and
+ * q-1, so it divides m-1 as well.  With g = gcd(m-1,q-1), 2^g = 1 mod q is
+ * a cheap necessary condition, and 2^g > q a cheaper one.  For Korselt q-1
+ * must divide m-1.  This rules out n = 3q and the like without a test on n. */
+static int _psp_cofactor(UV m, UV q, int carmichael)
+{
+  UV g;
+  if (carmichael)
+    return ((m-1) % (q-1)) == 0;
+  g = gcd_ui(m-1, q-1);
+  if (g < BITS_PER_WORD && ((UV)1 << g) <= q)  return 0;
+  return powmod(2, g, q) == 1;
+}
+
+static UV _psp_range(UV lo, UV hi, int carmichael, UV** list)
+{
+  UV B, BB, nsp, segodds, seglo, count = 0, alloc = 0;
+  uint32_t *sp, *sd;
+  unsigned char* rough = 0;
+  UV *allowed, *L = 0;
+
+  if (lo < 9) lo = 9;
+  if (!(lo & 1)) lo++;
+  if (list) *list = 0;
+  if (hi < lo) return 0;
+
+  B = isqrt(hi);
+  if (B > PSP_MAX_SIEVE_PRIME)  B = PSP_MAX_SIEVE_PRIME;
+  if (B > PSP_MIN_SEGMENT && B > (hi-lo)/8)
+    B = ((hi-lo)/8 < PSP_MIN_SEGMENT) ? PSP_MIN_SEGMENT : (hi-lo)/8;
+  BB = B*B;
+
+  /* The sieving primes with their order of 2, or p-1 for Korselt */
+  nsp = 0;
+  New(0, sp, B/2+2, uint32_t);
+  New(0, sd, B/2+2, uint32_t);
+  START_DO_FOR_EACH_PRIME(3, B) {
+    sp[nsp] = p;
+    sd[nsp] = carmichael ? p-1 : _order2(p);
+    nsp++;
+  } END_DO_FOR_EACH_PRIME
+
+  segodds = (B/2 < PSP_MIN_SEGMENT) ? PSP_MIN_SEGMENT : B/2;
+  if (segodds > (hi-lo)/2+1)  segodds = (hi-lo)/2+1;
+  New(0, allowed, segodds, UV);
+  /* Past B^2, numbers with no allowed factor need to be told apart */
+  if (hi > BB)
+    New(0, rough, segodds, unsigned char);
+
+  for (seglo = lo; 1; seglo += 2*segodds) {
+    UV i, j, seghi, nodds;
+    nodds = ((hi-seglo)/2 < segodds) ? (hi-seglo)/2+1 : segodds;
+    seghi = seglo + 2*(nodds-1);
+    for (i = 0; i < nodds; i++)
+      allowed[i] = 1;
+    if (rough && seghi > BB)
+      memset(rough, 0, nodds);
+
+    for (j = 0; j < nsp; j++) {
+      UV p = sp[j], D = sd[j], k, kmax, idx, step;
+      /* Allowed odd multiples p*k: k = 1 mod d, k >= 3 */
+      if (D & 1) D *= 2;
+      k = seglo / p + (seglo % p != 0);
+      if (k < 3) k = 3;
+      k += (D - (k-1) % D) % D;
+      kmax = seghi / p;
+      step = p * (D/2);
+      idx = (p*k - seglo) >> 1;
+      if (p == 1093 || p == 3511) {    /* Wieferich: p^2 may divide */
+        for ( ; k <= kmax; k += D, idx += step) {
+          UV t;
+          allowed[idx] *= p;
+          for (t = k; t % p == 0; t /= p)
+            allowed[idx] *= p;
+        }
+      } else {
+        for ( ; k <= kmax; k += D, idx += step)
+          allowed[idx] *= p;
+      }
+      if (rough && seghi > BB) {
+        k = seglo / p + (seglo % p != 0);
+        if (!(k & 1)) k++;
+        for (idx = (p*k - seglo) >> 1;  idx < nodds;  idx += p)
+          rough[idx] = 1;
+      }
+    }
+
+    for (i = 0; i < nodds; i++) {
+      UV n = seglo + 2*i, m = allowed[i];
+      if (m == 1) {
+        /* Prime, or only forbidden small factors */
+        if (n <= BB || rough[i])  continue;
+      } else if (m != n) {
+        UV q = n / m;
+        if (q <= B)  continue;          /* A forbidden factor or square */
+        if (q <= BB) {
+          /* q is prime: q <= 2^(m-1)-1 for pseudoprimes, q <= m for Korselt */
+          if (!carmichael && m < 48 && n >= (m << (m-1)))          continue;
+          if ( carmichael && m < UVCONST(4294967296) && m*m < n)  continue;
+          if (!_psp_cofactor(m, q, carmichael))  continue;
+        }
+      }
+      if (!_psp_test(n, carmichael, m > 1))  continue;
+      if (list) {
+        if (count >= alloc) {
+          alloc = (alloc == 0) ? 256 : 2*alloc;
+          Renew(L, alloc, UV);
+        }
+        L[count] = n;
+      }
+      count++;
+    }
+    if (seghi >= hi - 1) break;
+  }
+  if (rough) Safefree(rough);
+  Safefree(allowed);
+  Safefree(sd);
+  Safefree(sp);
+  if (list) *list = L;
+  return count;
+}
+
+UV* spsp2_range(UV lo, UV hi, UV* count)
+{
+  UV* list;
+  *count = _psp_range(lo, hi, 0, &list);
+  return list;
+}
+
+UV carmichael_count(UV lo, UV hi)
+{
+  return _psp_range(lo, hi, 1, 0);
+}
@@ -0,0 +1,13 @@
+#ifndef MPU_PSEUDOPRIMES_H
+#define MPU_PSEUDOPRIMES_H
+
+#include "ptypes.h"
+
+/* The base 2 strong pseudoprimes in [lo,hi] in increasing order, with the
+ * number of them in count.  Caller frees the list. */
+extern UV* spsp2_range(UV lo, UV hi, UV* count);
+
+/* The number of Carmichael numbers in [lo,hi]. */
+extern UV carmichael_count(UV lo, UV hi);
+
+#endif
@@ -9,6 +9,7 @@ my @functions =  qw(
       prime_get_config prime_set_config
       prime_precalc prime_memfree
       is_prime is_prob_prime is_provable_prime is_provable_prime_with_cert
+      is_prime_batch is_prime_range
       prime_certificate verify_prime
       is_pseudoprime is_strong_pseudoprime
       is_lucas_pseudoprime
@@ -17,11 +18,14 @@ my @functions =  qw(
       is_almost_extra_strong_lucas_pseudoprime
       is_frobenius_underwood_pseudoprime
       is_aks_prime is_bpsw_prime
+      lucas_lehmer
       is_power
       miller_rabin_random
+      spsp2_range carmichael_count
       lucas_sequence lucasu lucasv
       primes twin_primes
-      forprimes forcomposites foroddcomposites fordivisors
+      forprimes forcomposites foroddcomposites fordivisors forfactored
+      fortotients formoebius forsigma
       forpart forcomb forperm
       prime_iterator prime_iterator_object
       next_prime  prev_prime
@@ -35,12 +39,13 @@ my @functions =  qw(
       random_maurer_prime random_maurer_prime_with_cert
       random_shawe_taylor_prime random_shawe_taylor_prime_with_cert
       primorial pn_primorial consecutive_integer_lcm gcdext chinese
-      gcd lcm factor factor_exp divisors valuation invmod hammingweight
+      gcd lcm factor factor_exp factor_range divisors valuation invmod hammingweight
       vecsum vecmin vecmax vecprod vecreduce
       moebius mertens euler_phi jordan_totient exp_mangoldt liouville
+      totient_sum squarefree_count
       partitions bernfrac bernreal
       chebyshev_theta chebyshev_psi
-      divisor_sum carmichael_lambda kronecker
+      divisor_sum divisor_summatory carmichael_lambda kronecker
       binomial factorial stirling znorder znprimroot znlog legendre_phi
       ExponentialIntegral LogarithmicIntegral RiemannZeta RiemannR LambertW Pi
                    );
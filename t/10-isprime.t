@@ -3,7 +3,7 @@ use strict;
 use warnings;
 
 use Test::More;
-use Math::Prime::Util qw/is_prime/;
+use Math::Prime::Util qw/is_prime is_prime_batch is_prime_range/;
 
 my $use64 = Math::Prime::Util::prime_get_config->{'maxbits'} > 32;
 my $broken64 = (18446744073709550592 == ~0);
@@ -58,7 +58,7 @@ my @primes = (qw/
   5 11 29 97 127 541 907 1151 1361 9587 15727 19661 31469 156007 360749
   370373 492227 1349651 1357333 2010881 4652507 17051887 20831533 47326913
   122164969 189695893 191913031 387096383 436273291 1294268779 1453168433
-  2300942869 3842611109/);
+  2300942869 3842611109 4294967279 4294967291/);
 
 push @primes, (qw/
   4302407713 10726905041 20678048681 22367085353 25056082543 42652618807
@@ -78,6 +78,8 @@ plan tests =>   6   # range
               + 1   # small numbers
               + scalar @composites
               + scalar @primes
+              + 1   # batch
+              + 2   # range bitmap
               + 0;
 
 ok(!eval { is_prime(undef); }, "is_prime(undef)");
@@ -106,3 +108,20 @@ foreach my $n (@composites) {
 foreach my $n (@primes) {
   is( is_prime($n), 2, "$n is definitely prime" );
 }
+
+{
+  my @n = (-3, 0..3572, @composites, @primes);
+  my @exp = map { is_prime($_) } @n;
+  is_deeply( [is_prime_batch(\@n)], \@exp, "is_prime_batch matches is_prime" );
+}
+
+{
+  my @exp = map { 0+!!is_prime($_) } (0..3572);
+  my @got = map { vec(is_prime_range(0,3572),$_,1) } (0..3572);
+  is_deeply( \@got, \@exp, "is_prime_range 0..3572" );
+  my @n = map { 1000000007 + 30*$_ } (0..999);
+  @exp = map { 0+!!is_prime($_) } @n;
+  my $bits = is_prime_range($n[0], $n[-1], 30);
+  @got = map { vec($bits,$_,1) } (0..$#n);
+  is_deeply( \@got, \@exp, "is_prime_range with step 30" );
+}
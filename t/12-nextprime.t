@@ -7,7 +7,7 @@ use Math::Prime::Util qw/next_prime prev_prime/;
 
 my $use64 = Math::Prime::Util::prime_get_config->{'maxbits'} > 32;
 
-plan tests => 2 + 3*2 + 6 + 2 + 148 + 148 + 1;
+plan tests => 2 + 3*2 + 6 + 2 + 148 + 148 + 1 + 4;
 
 my @small_primes = qw/
 2 3 5 7 11 13 17 19 23 29 31 37 41 43 47 53 59 61 67 71
@@ -94,3 +94,12 @@ foreach my $n (2010734 .. 2010881) {
 }
 # Similar test case to 2010870, where m=0 and next_prime is at m=1
 is(next_prime(1234567890), 1234567891, "next_prime(1234567890) == 1234567891)");
+
+SKIP: {
+  skip "Gaps past 2^32 only on 64-bit", 4 unless $use64;
+  # These span several sieve windows
+  is(next_prime(1693182318746371), 1693182318747503, "next_prime(1693182318746371) == 1693182318747503");
+  is(prev_prime(1693182318747503), 1693182318746371, "prev_prime(1693182318747503) == 1693182318746371");
+  is(next_prime(4294967291), 4294967311, "next_prime(4294967291) == 4294967311");
+  is(prev_prime(4294967311), 4294967291, "prev_prime(4294967311) == 4294967291");
+}
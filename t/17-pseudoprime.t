@@ -13,6 +13,7 @@ use Math::Prime::Util qw/is_prime
                          is_frobenius_underwood_pseudoprime
                          is_perrin_pseudoprime
                          is_frobenius_pseudoprime
+                         spsp2_range carmichael_count
                          lucas_sequence kronecker/;
 
 my $use64 = Math::Prime::Util::prime_get_config->{'maxbits'} > 32;
@@ -122,6 +123,7 @@ plan tests => 0 + 3
                 + 1  # mr base 2    2-4k
                 + 9  # mr with large bases
                 + 3  # multi-base Fermat/strong pseudoprimes
+                + 4 + 3*$use64 + $usexs  # spsp2_range and carmichael_count
                 + scalar @small_lucas_trials
                 + scalar(keys %lucas_sequences)
                 + 1  # frob-underwood
@@ -209,6 +211,26 @@ is(is_pseudoprime(143168581, 2, 3, 5, 7, 11), 1, "143168581 is a Fermat pseudopr
 is(is_strong_pseudoprime(3215031751, 2, 3, 5, 7), 1, "3215031751 is a strong pseudoprime to bases 2,3,5,7");
 is(is_strong_pseudoprime("2152302898747", 2, 3, 5, 7, 11), 1, "2152302898747 is a strong pseudoprime to bases 2,3,5,7,11");
 
+# Base 2 strong pseudoprimes and Carmichael numbers in a range
+is_deeply( spsp2_range(100000), [grep { $_ < 100000 } @{$pseudoprimes{2}}],
+           "spsp2_range(100000)" );
+is_deeply( spsp2_range(1194000, 1195000), [1194649],
+           "spsp2_range finds 1093^2" );
+is_deeply( spsp2_range("1000002977000", "1000002978000"), ["1000002977551"],
+           "spsp2_range(1000002977000, 1000002978000)" ) if $use64;
+is( carmichael_count(100000), 16, "carmichael_count(100000) = 16" );
+is( carmichael_count(561, 561), 1, "carmichael_count(561,561) = 1" );
+is( carmichael_count(10**7), 105, "carmichael_count(10^7) = 105" ) if $usexs;
+if ($use64) {
+  # Narrow windows leave a composite cofactor past the sieving primes
+  my @carm = (qw/1824026866201 3710199376801 59428094648833
+                 8159527853569 3829076428321 16183966479409/);
+  is_deeply( [map { carmichael_count($_-2, $_+2) } @carm], [map { 1 } @carm],
+             "carmichael_count finds n = p*q*r in narrow windows" );
+  is_deeply( spsp2_range("9975282731130600", "9975282731130700"),
+             ["9975282731130641"], "spsp2_range finds 23*201961*2147483647" );
+}
+
 # Verify Lucas for some small numbers
 for my $n (@small_lucas_trials) {
   next if $n == 5459 || $n == 5777 || $n == 10877 || $n == 16109 || $n == 18971;
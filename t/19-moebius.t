@@ -8,7 +8,7 @@ use Math::Prime::Util
       chebyshev_theta chebyshev_psi carmichael_lambda znorder liouville
       znprimroot znlog kronecker legendre_phi gcd lcm is_power valuation
       invmod vecsum vecprod binomial gcdext chinese vecmin vecmax factorial
-      hammingweight vecreduce
+      hammingweight vecreduce totient_sum squarefree_count divisor_summatory
      /;
 
 my $extra = defined $ENV{EXTENDED_TESTING} && $ENV{EXTENDED_TESTING};
@@ -80,6 +80,30 @@ if ($extra && $use64) {
   );
 }
 
+my %totient_sums = (
+        0 => 0,
+        1 => 1,
+        2 => 2,
+      100 => 3044,
+     1000 => 304192,
+  1000000 => "303963552392",
+);
+my %squarefree_counts = (
+        0 => 0,
+        3 => 3,
+        4 => 3,
+      100 => 61,
+    10000 => 6083,
+  1000000 => 607926,
+);
+if ($use64) {
+  $squarefree_counts{10**12} = "607927102274";
+  if ($usexs) {
+    $totient_sums{10**10} = "30396355092886216366";   # Larger than 2^64
+    $squarefree_counts{"1000000000000000000"} = "607927101854022750";
+  }
+}
+
 my %totients = (
      123456 => 41088,
      123457 => 123456,
@@ -118,6 +142,20 @@ my %sigmak = (
   3 => [1, 9, 28, 73, 126, 252, 344, 585, 757, 1134, 1332, 2044, 2198, 3096, 3528, 4681, 4914, 6813, 6860, 9198, 9632, 11988, 12168, 16380, 15751, 19782, 20440, 25112, 24390, 31752, 29792, 37449, 37296, 44226, 43344, 55261, 50654, 61740, 61544],
 );
 
+my @divisor_summatory = (
+  [ 100, 0, 482 ],
+  [ 100, 1, 8299 ],
+  [ 100, 2, 407819 ],
+  [ 100, 3, 27643219 ],
+  [ 1000, 2, 401382971 ],
+  [ 1000000, 1, "822468118437" ],
+);
+if ($use64) {
+  push @divisor_summatory, [ "1000000000000", 0, "27785452449086" ];
+  push @divisor_summatory, [ "10000000", 2, "400685705322499946270" ];
+  push @divisor_summatory, [ "18446744073709551615", 0, "821172508510810019729" ] if $usexs;
+}
+
 my @tau4 = (1,4,4,10,4,16,4,20,10,16,4,40,4,16,16,35,4,40,4,40,16,16,4,80,10,16,20,40,4,64,4,56,16,16,16,100);
 push @tau4, (4,16,16,80,4,64,4,40,40,16,4,140,10,40,16,40,4,80,16,80,16,16,4,160,4,16,40,84,16,64,4,40,16,64,4,200,4,16,40,40,16) if $extra;
 
@@ -431,6 +469,10 @@ if ($usexs || $extra) {
 if ($usexs && $use64) {
   # Nice case for PH
   push @znlogs, [ [32712908945642193,5,71245073933756341], 5945146967010377];
+  # Subgroup of large prime order q, p = 2q+1
+  push @znlogs, [ [175627008738435,4,229454319471107], 6626506264455];
+  # Index calculus
+  push @znlogs, [ ["8045520960060980304",4,"18446744073709550147"], "1234567890123456789"];
 }
 
 my %powers = (
@@ -579,6 +621,8 @@ plan tests => 0 + 1
                 + 1 # Small Moebius
                 + 3*scalar(keys %mertens)
                 + 1*scalar(keys %big_mertens)
+                + scalar(keys %totient_sums) + 1
+                + scalar(keys %squarefree_counts)
                 + 2 # Small Phi
                 + 9 + scalar(keys %totients)
                 + 1 # Small Carmichael Lambda
@@ -588,7 +632,7 @@ plan tests => 0 + 1
                 + scalar(@gcdexts)
                 + scalar(@crts)
                 + scalar(@mult_orders)
-                + scalar(@znlogs)
+                + scalar(@znlogs) + 1
                 + scalar(@legendre_sums)
                 + scalar(@valuations)
                 + scalar(@popcounts)
@@ -606,6 +650,7 @@ plan tests => 0 + 1
                 + 2  # Calculate J5 two different ways
                 + 2 * $use64 # Jordan totient example
                 + 1 + 2*scalar(keys %sigmak) + 3
+                + scalar(@divisor_summatory) + 3
                 + scalar(keys %mangoldt)
                 + scalar(keys %chebyshev1)
                 + scalar(keys %chebyshev2)
@@ -632,6 +677,13 @@ while (my($n, $mertens) = each (%mertens)) {
 while (my($n, $mertens) = each (%big_mertens)) {
   is( mertens($n), $mertens, "mertens($n)" );
 }
+while (my($n, $sum) = each (%totient_sums)) {
+  is( "".totient_sum($n), $sum, "totient_sum($n)" );
+}
+is( totient_sum(240), vecsum(euler_phi(1,240)), "totient_sum(240) = sum of euler_phi(1,240)" );
+while (my($n, $count) = each (%squarefree_counts)) {
+  is( squarefree_count($n), $count, "squarefree_count($n)" );
+}
 
 {
   my @phi = map { euler_phi($_) } (0 .. $#A000010);
@@ -713,6 +765,15 @@ while (my($k, $sigmaref) = each (%sigmak)) {
   my @slist = map { divisor_sum($_) } 1 .. scalar @{$sigmak{1}};
   is_deeply(\@slist, $sigmak{1}, "divisor_sum(n)");
 }
+###### Sums of divisor sums
+foreach my $r (@divisor_summatory) {
+  my($n, $k, $sum) = @$r;
+  is( "".divisor_summatory($n, $k), $sum, "divisor_summatory($n, $k)" );
+}
+foreach my $k (0 .. 2) {
+  is( divisor_summatory(1234, $k), vecsum(map { divisor_sum($_,$k) } 1 .. 1234),
+      "divisor_summatory(1234, $k) = sum of divisor_sum" );
+}
 # tau two ways
 {
   my $len = scalar @{$sigmak{0}};
@@ -802,6 +863,11 @@ foreach my $arg (@znlogs) {
   my $k = znlog($a,$g,$p);
   is( $k, $exp, "znlog($a,$g,$p) = " . ((defined $exp) ? $exp : "<undef>") );
 }
+{ # Many targets with one g and p
+  my @k = map { znlog($_,5,10007) } 2..13;
+  is_deeply( \@k, [6578,6190,3150,1,2762,1301,9728,2374,6579,7142,9340,1174],
+             "znlog(a,5,10007) for a = 2..13" );
+}
 ###### liouville
 foreach my $i (@liouville_pos) {
   is( liouville($i),  1, "liouville($i) = 1" );
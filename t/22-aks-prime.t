@@ -12,6 +12,7 @@ my $ispp = !Math::Prime::Util::prime_get_config->{xs};
 plan tests =>   6   # range
               + 1   # small number
               + 2   # medium numbers
+              + 1   # large number
               + 1*$extra
               + 0;
 
@@ -50,3 +51,9 @@ if ($extra) {
   # A composite (product of two 5-digit primes)
   is( is_aks_prime(1262952907), 0, "is_aks_prime(1262952907) is false" );
 }
+
+# With Bernstein's bounds a 61-bit prime needs only ~300 witnesses.
+SKIP: {
+  skip "Skipping 61-bit AKS on 32-bit Perl or PP", 1 if !$use64 || $ispp;
+  is( is_aks_prime("1152921504606847009"), 1, "is_aks_prime(1152921504606847009) is true" );
+}
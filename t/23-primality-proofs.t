@@ -30,6 +30,10 @@ if ($extra || $use64) {
 if ($extra || prime_get_config->{'gmp'}) {
   push @plist, "980098182126316404630169387";
 }
+# Below 2^128 the XS code makes the BLS75 n-1 proofs, including chains.
+if ($use64 && prime_get_config->{'xs'}) {
+  push @plist, "56668397794435742565553", "340282366920938463463374607431768211297";
+}
 
 ## This is too slow without Math::Prime::Util::GMP.
 #push @plist, '3364125245431456304736426076174232972735419017865223025179282077503701'
@@ -53,10 +57,12 @@ plan tests => 0
             + 2                    #  Pratt and ECPP
             + 28 # borked up certificates generate warnings
             + 6  # verification failures (tiny/BPSW)
+            + 1  # BLS5 with F = 2^127
             + 8  # verification failures (Lucas/Pratt)
             + 8  # verification failures (n-1)
             + 7  # verification failures (ECPP)
             + 3  # Verious other types
+            + 3  # BLS5 chains
             + 0;
 
 is( is_provable_prime(871139809), 0, "871139809 is composite" );
@@ -282,6 +288,9 @@ is( verify_prime([14]), 0, "verify [14] is composite" );
 is( verify_prime(['28446744073709551615']), 0, "verify BPSW with n > 2^64 fails" );
 is( verify_prime([871139809]), 0, "verify BPSW with composite fails" );
 
+# 2F overflows 128 bits here
+is( verify_prime("[MPU - Primality Certificate]\nVersion 1.0\n\nProof for:\nN 1000000007\n\nType BLS5\nN 170141183460469231731687303715884105729\n----\n"), 0, "BLS5 with F = 2^127 fails without crashing" );
+
 is( verify_prime([1490266103, 'Pratt', [2,13,19,1597,1889], 5]), 1, "Lucas/Pratt proper" );
 is( verify_prime([1490266103, 'Pratt', [4,13,19,1597,1889], 5]), 0, "Pratt with non-prime factors" );
 is( verify_prime([1490266103, 'Pratt', [[4],13,19,1597,1889], 5]), 0, "Pratt with non-prime factors" );
@@ -367,4 +376,18 @@ is( verify_prime([1490266103, "ECPP",
                        "T 1";
   is( verify_prime($cert), 1, "Verify ECPP3");
   }
+  {
+  my @steps = ( ["Type BLS5", "N 56668397794435742565553", "Q[1] 3",
+                 "Q[2] 1180591620717411303449", "A[0] 5", "----"],
+                ["Type BLS5", "N 1180591620717411303449",
+                 "Q[1] 147573952589676412931", "A[0] 3", "----"],
+                ["Type BLS5", "N 147573952589676412931", "Q[1] 5", "Q[2] 13",
+                 "Q[3] 397", "Q[4] 2113", "Q[5] 312709", "Q[6] 4327489", "----"] );
+  my $cert = join "\n", $header, "N 56668397794435742565553", map { @$_ } @steps;
+  is( verify_prime($cert), 1, "Verify BLS5 chain");
+  (my $bada = $cert) =~ s/^A\[0\] 3$/A[0] 2/m;
+  is( verify_prime($bada), 0, "BLS5 chain with a bad A fails");
+  $cert = join "\n", $header, "N 56668397794435742565553", map { @$_ } @steps[0,1];
+  is( verify_prime($cert), 0, "BLS5 chain with a missing step fails");
+  }
 }
@@ -3,16 +3,31 @@ use strict;
 use warnings;
 
 use Test::More;
-use Math::Prime::Util qw/is_mersenne_prime/;
+use Math::Prime::Util qw/is_mersenne_prime lucas_lehmer primes prime_get_config/;
 my $extra = defined $ENV{EXTENDED_TESTING} && $ENV{EXTENDED_TESTING};
+my $usexs = prime_get_config->{'xs'};
 
 my @A000043 = (2, 3, 5, 7, 13, 17, 19, 31, 61, 89, 107, 127);
 push @A000043, (521, 607, 1279, 2203, 2281) if $extra;
 #push @A000043, (3217, 4253, 4423, 9689, 9941) if $extra;
 #push @A000043, (11213, 19937, 21701, 23209, 44497, 86243) if $extra;
 
-plan tests => 1;
+# The C Lucas-Lehmer test, bypassing the table of known exponents.
+my @lltest = (89, 107, 127, 521, 607);
+push @lltest, (1279, 2203, 2281, 3217, 4253, 4423) if $extra;
+
+plan tests => 1 + 1 + 1;
 
 is_deeply( [grep { is_mersenne_prime($_) } 0 .. $A000043[-1]],
            \@A000043,
            "Find Mersenne primes from 0 to $A000043[-1]" );
+
+SKIP: {
+  skip "Lucas-Lehmer FFT test needs XS", 2 unless $usexs;
+  is_deeply( [grep { lucas_lehmer($_) } @{primes(65, $lltest[-1])}],
+             \@lltest,
+             "Lucas-Lehmer with FFT squaring from 65 to $lltest[-1]" );
+  is_deeply( [map { lucas_lehmer($_) } 4253, 4259, 9689, 9697, 11213],
+             [1, 0, 1, 0, 1],
+             "lucas_lehmer on 4253, 4259, 9689, 9697, 11213" );
+}
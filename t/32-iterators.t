@@ -4,7 +4,9 @@ use warnings;
 
 use Test::More;
 use Math::Prime::Util qw/primes prev_prime next_prime
-                         forprimes forcomposites fordivisors
+                         forprimes forcomposites fordivisors forfactored
+                         fortotients formoebius forsigma divisor_sum
+                         factor divisors euler_phi moebius
                          prime_iterator prime_iterator_object/;
 use Math::BigInt try => "GMP,Pari";
 use Math::BigFloat;
@@ -15,7 +17,10 @@ my $broken64 = (18446744073709550592 == ~0);
 plan tests => 8        # forprimes errors
             + 12 + 7   # forprimes simple
             + 3        # forcomposites simple
-            + 2        # fordivisors simple
+            + 3        # fordivisors simple
+            + 5        # forfactored
+            + 4        # fortotients and formoebius
+            + 3        # forsigma
             + 3        # iterator errors
             + 7        # iterator simple
             + 1        # other forprimes
@@ -94,7 +99,65 @@ ok(!eval { forprimes { 1 } 5.6; },   "forprimes abc");
   do { fordivisors { push @a, $_ } $_ } for 1..50;
   is_deeply(\@a, \@A027750, "A027750 using fordivisors");
 }
+{
+  my $n = 963761198400;   # 6720 divisors
+  my @a;
+  fordivisors { push @a, $_ } $n;
+  is_deeply(\@a, [divisors($n)], "fordivisors $n matches divisors");
+}
 
+{
+  my @t;
+  forfactored { push @t, [$_, @_] } 12;
+  is_deeply( \@t, [[1],[2,2],[3,3],[4,2,2],[5,5],[6,2,3],[7,7],[8,2,2,2],[9,3,3],[10,2,5],[11,11],[12,2,2,3]], "forfactored 12" );
+}
+{
+  my($beg, $end) = (1000000, 1030000);
+  my($nbad, $nsemi) = (0,0);
+  forfactored { $nbad++ unless "@_" eq join(" ",factor($_)); $nsemi++ if @_ == 2; } $beg, $end;
+  is( $nbad, 0, "forfactored $beg,$end matches factor" );
+  is( $nsemi, 5945, "forfactored $beg,$end finds 5945 semiprimes" );
+}
+{
+  my $nbad = 0;
+  forfactored { $nbad++ unless "@_" eq join(" ",factor($_)); } 0, 10000;
+  is( $nbad, 0, "forfactored 0,10000 matches factor" );
+}
+{
+  my @t;
+  forfactored { push @t, "$_:@_" } 4294967290, 4294967297;
+  is_deeply( \@t, ["4294967290:2 5 19 22605091","4294967291:4294967291","4294967292:2 2 3 3 7 11 31 151 331","4294967293:9241 464773","4294967294:2 2147483647","4294967295:3 5 17 257 65537","4294967296:2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2","4294967297:641 6700417"], "forfactored across 2^32" );
+}
+{
+  my @t;
+  fortotients { push @t, "$_:@_" } 12;
+  is( "@t", "1:1 2:1 3:2 4:2 5:4 6:2 7:6 8:4 9:6 10:4 11:10 12:4", "fortotients 12" );
+  @t = ();
+  formoebius { push @t, $_[0] } 0, 12;
+  is( "@t", "0 1 -1 -1 0 -1 1 -1 0 0 1 -1 0", "formoebius 0,12" );
+}
+{
+  my($beg, $end) = $use64 ? ("1000000000000", "1000000003000") : (4294964000, 4294967295);
+  my($nbad, $M) = (0,0);
+  fortotients { $nbad++ unless $_[0] == euler_phi($_) } $beg, $end;
+  formoebius { $nbad++ unless $_[0] == moebius($_); $M += $_[0]; } $beg, $end;
+  is( $nbad, 0, "fortotients and formoebius $beg,$end match euler_phi and moebius" );
+  my $R = 0;
+  $R += $_ for moebius($beg, $end);
+  is( $M, $R, "formoebius sum matches ranged moebius" );
+}
+{
+  my @t;
+  forsigma { push @t, "$_:@_" } 1, 12;
+  is( "@t", "1:1 2:3 3:4 4:7 5:6 6:12 7:8 8:15 9:13 10:18 11:12 12:28", "forsigma 1, 12" );
+  @t = ();
+  forsigma { push @t, $_[0] } 0, 24, 30;
+  is( "@t", "8 3 4 4 6 2 8", "forsigma 0, 24, 30" );
+  my($beg, $end) = $use64 ? ("1000000000000", "1000000003000") : (4294964000, 4294967295);
+  my $nbad = 0;
+  forsigma { $nbad++ unless $_[0] == divisor_sum($_, 1) } 1, $beg, $end;
+  is( $nbad, 0, "forsigma 1, $beg, $end matches divisor_sum" );
+}
 ok(!eval { prime_iterator(-2); }, "iterator -2");
 ok(!eval { prime_iterator("abc"); }, "iterator abc");
 ok(!eval { prime_iterator(4.5); }, "iterator 4.5");
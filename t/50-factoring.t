@@ -3,7 +3,7 @@ use strict;
 use warnings;
 
 use Test::More;
-use Math::Prime::Util qw/factor factor_exp divisors divisor_sum is_prime/;
+use Math::Prime::Util qw/factor factor_exp factor_range divisors divisor_sum is_prime/;
 
 my $use64 = Math::Prime::Util::prime_get_config->{'maxbits'} > 32;
 my $extra = defined $ENV{EXTENDED_TESTING} && $ENV{EXTENDED_TESTING};
@@ -115,9 +115,10 @@ plan tests => (3 * scalar @testn)
             + 2*scalar(keys %prime_factors)
             + 4*scalar(keys %all_factors)
             + 2*scalar(keys %factor_exponents)
-            + 10*8  # 10 extra factoring tests * 8 algorithms
+            + 10*9  # 10 extra factoring tests * 9 algorithms
             + 8
-            + 1;
+            + 2
+            + 4;  # factor_range
 
 foreach my $n (@testn) {
   my @f = factor($n);
@@ -160,6 +161,7 @@ while (my($n, $factors) = each(%factor_exponents)) {
 extra_factor_test("trial_factor",  sub {Math::Prime::Util::trial_factor(shift)});
 extra_factor_test("fermat_factor", sub {Math::Prime::Util::fermat_factor(shift)});
 extra_factor_test("holf_factor",   sub {Math::Prime::Util::holf_factor(shift)});
+extra_factor_test("lehman_factor", sub {Math::Prime::Util::lehman_factor(shift)});
 extra_factor_test("squfof_factor", sub {Math::Prime::Util::squfof_factor(shift)});
 extra_factor_test("pbrent_factor", sub {Math::Prime::Util::pbrent_factor(shift)});
 extra_factor_test("prho_factor",   sub {Math::Prime::Util::prho_factor(shift)});
@@ -170,6 +172,7 @@ extra_factor_test("pplus1_factor", sub {Math::Prime::Util::pplus1_factor(shift)}
 
 # To hit some extra coverage
 is_deeply( [Math::Prime::Util::trial_factor(5514109)], [2203,2503], "trial factor 2203*2503" );
+is_deeply( [sort {$a<=>$b} Math::Prime::Util::lehman_factor(1110106531)], [10007,110933], "lehman factor 10007*110933" );
 
 sub extra_factor_test {
   my $fname = shift;
@@ -197,6 +200,17 @@ is( scalar factor(6), 2, "scalar factor(6) should be 2" );
 is( scalar factor(30107), 4, "scalar factor(30107) should be 4" );
 is( scalar factor(174636000), 15, "scalar factor(174636000) should be 15" );
 
+# Factor a range
+is_deeply( factor_range(0, 6), [[0],[],[2],[3],[2,2],[5],[2,3]], "factor_range(0,6)" );
+is_deeply( factor_range(5), [[],[2],[3],[2,2],[5]], "factor_range(5)" );
+is_deeply( factor_range(7, 6), [], "factor_range(7,6) is empty" );
+{
+  my($lo, $hi) = $use64 ? ("1000000000000", "1000000010000") : (4294957295, 4294967295);
+  my $f = factor_range($lo, $hi);
+  my $nbad = grep { "@{$f->[$_]}" ne join(" ",factor($lo+$_)) } 0 .. $hi-$lo;
+  is( $nbad, 0, "factor_range($lo,$hi) matches factor" );
+}
+
 sub linear_to_exp {
   my %exponents;
   my @factors = grep { !$exponents{$_}++ } @_;
@@ -71,7 +71,7 @@ plan tests =>  0
              + 2*(@primes + @composites + @proveprimes)
              + 1   # primes
              + 1   # twin primes
-             + 2   # next/prev prime
+             + 4   # next/prev prime
              + 1   # prime_iterator
              + 1   # primecount large base small range
              + scalar(keys %pseudoprimes)
@@ -206,6 +206,9 @@ is_deeply( twin_primes(18446744073709558000, 18446744073709559000),
 
 is( next_prime(777777777777777777777777), 777777777777777777777787, "next_prime(777777777777777777777777)");
 is( prev_prime(777777777777777777777777), 777777777777777777777767, "prev_prime(777777777777777777777777)");
+# A gap of 300, wider than one sieve window
+is( next_prime(73786976294838233117), 73786976294838233417, "next_prime(73786976294838233117)");
+is( prev_prime(73786976294838233417), 73786976294838233117, "prev_prime(73786976294838233417)");
 
 ###############################################################################
 
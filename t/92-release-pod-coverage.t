@@ -40,6 +40,7 @@ sub mpu_public_regex {
   qw/ prime_get_config prime_set_config
       prime_precalc prime_memfree
       is_prime is_prob_prime is_provable_prime is_provable_prime_with_cert
+      is_prime_batch is_prime_range
       prime_certificate verify_prime
       is_pseudoprime is_strong_pseudoprime
       is_lucas_pseudoprime
@@ -49,12 +50,14 @@ sub mpu_public_regex {
       is_frobenius_underwood_pseudoprime
       is_frobenius_pseudoprime
       is_perrin_pseudoprime
-      is_aks_prime is_bpsw_prime is_mersenne_prime
+      is_aks_prime is_bpsw_prime is_mersenne_prime lucas_lehmer
       is_power
       miller_rabin_random
+      spsp2_range carmichael_count
       lucas_sequence lucasu lucasv
       primes twin_primes
       forprimes forcomposites foroddcomposites fordivisors
+      forfactored fortotients formoebius forsigma
       forpart forcomb forperm
       prime_iterator prime_iterator_object
       next_prime  prev_prime
@@ -68,12 +71,13 @@ sub mpu_public_regex {
       random_maurer_prime random_maurer_prime_with_cert
       random_shawe_taylor_prime random_shawe_taylor_prime_with_cert
       primorial pn_primorial consecutive_integer_lcm gcdext chinese
-      gcd lcm factor factor_exp divisors valuation invmod hammingweight
+      gcd lcm factor factor_exp factor_range divisors valuation invmod hammingweight
       vecsum vecmin vecmax vecprod vecreduce
       moebius mertens euler_phi jordan_totient exp_mangoldt liouville
+      totient_sum squarefree_count
       partitions bernfrac bernreal
       chebyshev_theta chebyshev_psi
-      divisor_sum carmichael_lambda kronecker
+      divisor_sum divisor_summatory carmichael_lambda kronecker
       binomial factorial stirling znorder znprimroot znlog legendre_phi
       ExponentialIntegral LogarithmicIntegral RiemannZeta RiemannR LambertW Pi
   /;
@@ -82,7 +86,7 @@ sub mpu_public_regex {
 }
 
 sub mpu_factor_regex {
-  my @funcs = (qw/trial_factor fermat_factor holf_factor squfof_factor prho_factor pbrent_factor pminus1_factor pplus1_factor ecm_factor/);
+  my @funcs = (qw/trial_factor fermat_factor holf_factor lehman_factor squfof_factor prho_factor pbrent_factor pminus1_factor pplus1_factor ecm_factor/);
   my $pattern = '^(' . join('|', @funcs) . ')$';
   return qr/$pattern/;
 }
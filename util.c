@@ -230,6 +230,64 @@ int _XS_is_prime(UV n)
 }
 
 
+/* Past 2^32 on 64-bit, rather than walk the wheel, we sieve a window of
+ * 64 odd candidates by the primes below 250 and run BPSW on the survivors.
+ * This removes about a quarter of the candidates trial division to 53
+ * would leave, and costs less than one strong pseudoprime test.  Below
+ * 2^32 the hashed single base tests are cheaper than the sieve. */
+#if BITS_PER_WORD == 64
+#define NPW_SIZE 64
+#define NPW_MIN  UVCONST(4294967296)
+/* Bits 0, p, 2p, ... for odd p < 64, indexed by p/2 */
+static const UV npw_pat[32] = {
+  0, UVCONST(0x9249249249249249), UVCONST(0x1084210842108421),
+  UVCONST(0x8102040810204081), 0, UVCONST(0x0080100200400801),
+  UVCONST(0x0010008004002001), 0, UVCONST(0x0008000400020001),
+  UVCONST(0x0200004000080001), 0, UVCONST(0x0000400000800001), 0, 0,
+  UVCONST(0x0400000020000001), UVCONST(0x4000000080000001), 0, 0,
+  UVCONST(0x0000002000000001), 0, UVCONST(0x0000020000000001),
+  UVCONST(0x0000080000000001), 0, UVCONST(0x0000800000000001), 0, 0,
+  UVCONST(0x0020000000000001), 0, 0, UVCONST(0x0800000000000001),
+  UVCONST(0x2000000000000001), 0 };
+/* lo+2k is divisible by p when 2k = -lo mod p.  r is lo mod p*q*..., so the
+ * divisions by p are 32-bit by a constant.  No branches, as k >= 64 is
+ * common for the larger p and unpredictable. */
+#define NPW_K(p)  do { uint32_t r_ = r % p, t_ = r_ ? p - r_ : 0; \
+                       k = (t_ + (t_ & 1) * p) >> 1; } while (0)
+#define NPW_SMALL(p)  do { NPW_K(p); bits &= ~(npw_pat[p/2] << k); } while (0)
+#define NPW_BIG(p)  do { NPW_K(p); bits &= ~((UV)(k < 64) << (k & 63)); } while (0)
+/* Bit k set if lo+2k has no factor below 250 */
+static UV _npw_survivors(UV lo)
+{
+  UV bits = ~(UV)0, k;
+  uint32_t r;
+  r = lo % 3234846615U;
+  NPW_SMALL(3);  NPW_SMALL(5);  NPW_SMALL(7);  NPW_SMALL(11); NPW_SMALL(13);
+  NPW_SMALL(17); NPW_SMALL(19); NPW_SMALL(23); NPW_SMALL(29);
+  r = lo % 95041567U;
+  NPW_SMALL(31); NPW_SMALL(37); NPW_SMALL(41); NPW_SMALL(43); NPW_SMALL(47);
+  r = lo % 907383479U;
+  NPW_SMALL(53); NPW_SMALL(59); NPW_SMALL(61); NPW_BIG(67);   NPW_BIG(71);
+  r = lo % 4132280413U;
+  NPW_BIG(73);   NPW_BIG(79);   NPW_BIG(83);   NPW_BIG(89);   NPW_BIG(97);
+  r = lo % 121330189U;
+  NPW_BIG(101);  NPW_BIG(103);  NPW_BIG(107);  NPW_BIG(109);
+  r = lo % 257557397U;
+  NPW_BIG(113);  NPW_BIG(127);  NPW_BIG(131);  NPW_BIG(137);
+  r = lo % 490995677U;
+  NPW_BIG(139);  NPW_BIG(149);  NPW_BIG(151);  NPW_BIG(157);
+  r = lo % 842952707U;
+  NPW_BIG(163);  NPW_BIG(167);  NPW_BIG(173);  NPW_BIG(179);
+  r = lo % 1314423991U;
+  NPW_BIG(181);  NPW_BIG(191);  NPW_BIG(193);  NPW_BIG(197);
+  r = lo % 2125525169U;
+  NPW_BIG(199);  NPW_BIG(211);  NPW_BIG(223);  NPW_BIG(227);
+  r = lo % 3073309843U;
+  NPW_BIG(229);  NPW_BIG(233);  NPW_BIG(239);  NPW_BIG(241);
+  return bits;
+}
+#endif
+
 UV next_prime(UV n)
 {
   UV m, sieve_size, next;
@@ -247,6 +305,19 @@ UV next_prime(UV n)
   release_prime_cache(sieve);
   if (next != 0) return next;
 
+#if BITS_PER_WORD == 64
+  if (n >= NPW_MIN) {
+    for (n = (n+1) | 1;  1;  n += 2*NPW_SIZE) {
+      UV bits = _npw_survivors(n);
+      while (bits) {
+        int k = ctz(bits);
+        if (_XS_BPSW(n + 2*k))  return n + 2*k;
+        bits &= bits - 1;
+      }
+    }
+  }
+#endif
+
   m = n % 30;
   do { /* Move forward one. */
     n += wheeladvance30[m];
@@ -271,6 +342,20 @@ UV prev_prime(UV n)
   }
   release_prime_cache(sieve);
 
+#if BITS_PER_WORD == 64
+  if (n > NPW_MIN) {
+    /* Windows end at the odd number below n and walk down */
+    for (n = ((n-2) | 1) - 2*(NPW_SIZE-1);  1;  n -= 2*NPW_SIZE) {
+      UV bits = _npw_survivors(n);
+      while (bits) {
+        int k = log2floor(bits);
+        if (_XS_BPSW(n + 2*k))  return n + 2*k;
+        bits ^= (UV)1 << k;
+      }
+    }
+  }
+#endif
+
   m = n % 30;
   do { /* Move back one. */
     n -= wheelretreat[m];
@@ -778,6 +863,32 @@ UV nth_prime_lower(UV n)
   return (UV) floorl(lower);
 }
 
+/* The least integer x in [lo,hi] with f(x) >= n, for R or Li.  Both have
+ * derivative very close to 1/log(x), so Newton steps from a good estimate
+ * get within a unit in three or four evaluations, where a binary search
+ * would use 60.  Then step to the crossing.  Past 1e15 or so the rounding
+ * of log(x) alone moves f by more than 1/log(x), so stop once the steps no
+ * longer shrink, and settle for a crossing in the noise. */
+static UV _inverse_newton(long double (*f)(long double), UV n, long double x, UV lo, UV hi)
+{
+  long double fn = (long double) n, flo = (lo < 2) ? 2 : lo, fhi = hi, dx, lastdx = 0;
+  UV r;
+  int i;
+
+  for (i = 0; i < 20; i++) {
+    if (x < flo) x = flo;
+    if (x > fhi) x = fhi;
+    dx = (fn - f(x)) * logl(x);
+    x += dx;
+    if (fabsl(dx) < 1 || (i > 0 && fabsl(dx) > fabsl(lastdx)/2)) break;
+    lastdx = dx;
+  }
+  r = (x >= fhi) ? hi : (x <= lo) ? lo : (UV) x;
+  while (r < hi && f(r) < fn)      r++;
+  while (r > lo && f(r-1) >= fn)   r--;
+  return r;
+}
+
 UV nth_prime_approx(UV n)
 {
   long double fn, flogn;
@@ -786,18 +897,13 @@ UV nth_prime_approx(UV n)
   if (n < NPRIMES_SMALL)
     return primes_small[n];
 
-  /* Binary search for inverse Riemann R */
+  /* Inverse Riemann R, starting from Cipolla's estimate */
   fn    = (long double) n;
   flogn = logl(n);
   lo    = (UV) (fn * flogn);
   hi    = (UV) (fn * flogn * 2 + 2);
   if (hi <= lo) hi = UV_MAX;
-  while (lo < hi) {
-    UV mid = lo + (hi-lo)/2;
-    if (_XS_RiemannR(mid) < fn) lo = mid+1;
-    else                        hi = mid;
-  }
-  return lo;
+  return _inverse_newton(_XS_RiemannR, n, fn * (flogn + logl(flogn) - 1), lo, hi);
 }
 
 
@@ -1055,136 +1161,403 @@ UV nth_twin_prime_approx(UV n)
   return lo;
 }
 
+/* Return a bitmap of (count+7)/8 bytes with bit k set (LSB first, as with
+ * Perl's vec) if lo + k*step is prime.  lo + (count-1)*step must not
+ * overflow.  It is the callers responsibility to call Safefree on the result.
+ *
+ * Consecutive windows wide enough to pay for the sieving primes use the
+ * segment sieve, which itself switches to a partial sieve plus BPSW when the
+ * window is small compared to its sqrt.  Otherwise the progression is sieved
+ * by primes up to a bound set by count, and the survivors are tested. */
+#define SETBIT(b,k)  b[(k)>>3] |= (1U << ((k)&7))
+#define CLRBIT(b,k)  b[(k)>>3] &= ~(1U << ((k)&7))
+#define GETBIT(b,k)  (b[(k)>>3] & (1U << ((k)&7)))
+unsigned char* prime_range_bitmap(UV lo, UV step, UV count)
+{
+  unsigned char* bits;
+  UV hi, sqrthi, k;
 
-/* Return a char array with lo-hi+1 elements. mu[k-lo] = µ(k) for k = lo .. hi.
- * It is the callers responsibility to call Safefree on the result. */
-#define PGTLO(p,lo)  ((p) >= lo) ? (p) : ((p)*(lo/(p)) + ((lo%(p))?(p):0))
-#define P2GTLO(pinit, p, lo) \
-   ((pinit) >= lo) ? (pinit) : ((p)*(lo/(p)) + ((lo%(p))?(p):0))
-signed char* _moebius_range(UV lo, UV hi)
+  MPUassert(step > 0, "prime_range_bitmap step must be positive");
+  Newz(0, bits, (count+7)/8, unsigned char);
+  if (count == 0) return bits;
+  hi = lo + (count-1)*step;
+  sqrthi = isqrt(hi);
+
+  if (step == 1 && count >= sqrthi/256) {
+    unsigned char* segment;
+    UV seg_base, seg_low, seg_high;
+    if (lo <= 2 && hi >= 2) SETBIT(bits, 2-lo);
+    if (lo <= 3 && hi >= 3) SETBIT(bits, 3-lo);
+    if (lo <= 5 && hi >= 5) SETBIT(bits, 5-lo);
+    if (hi >= 7) {
+      void* ctx = start_segment_primes( (lo < 7) ? 7 : lo, hi, &segment);
+      while (next_segment_primes(ctx, &seg_base, &seg_low, &seg_high)) {
+        START_DO_FOR_EACH_SIEVE_PRIME( segment, seg_low - seg_base, seg_high - seg_base )
+          SETBIT(bits, p + seg_base - lo);
+        END_DO_FOR_EACH_SIEVE_PRIME
+      }
+      end_segment_primes(ctx);
+    }
+    return bits;
+  }
+
+  {
+    UV limit = (count < 1000) ? 1000 : (count > 10000000) ? 10000000 : count;
+    UV nbatch = 0, batchk[256], batchn[256];
+    unsigned char batchres[256];
+    if (limit > sqrthi) limit = sqrthi;
+    memset(bits, 0xFF, (count+7)/8);
+    for (k = 0; k < count && lo+k*step < 2; k++)
+      CLRBIT(bits, k);
+    /* Clear every k where p divides lo + k*step, then restore p itself. */
+    START_DO_FOR_EACH_PRIME(2, limit) {
+      UV r = lo % p, s = step % p, k0 = count;
+      if (s != 0) {          /* k0 = -lo/step mod p, then every p-th */
+        k0 = (r == 0) ? 0 : mulmod(p-r, modinverse(s, p), p);
+        s = p;
+      } else if (r == 0) {   /* p divides every term */
+        k0 = 0;
+        s = 1;
+      }
+      for (k = k0; k < count; k += s)
+        CLRBIT(bits, k);
+      if (p >= lo && (p-lo) % step == 0 && (p-lo)/step < count)
+        SETBIT(bits, (p-lo)/step);
+    } END_DO_FOR_EACH_PRIME
+    /* Survivors above limit^2 still need a test. */
+    if (limit < sqrthi) {
+      for (k = 0; k <= count; k++) {
+        if (nbatch == 256 || (k == count && nbatch > 0)) {
+          UV i;
+          is_prob_prime_batch(batchn, nbatch, batchres);
+          for (i = 0; i < nbatch; i++)
+            if (!batchres[i])
+              CLRBIT(bits, batchk[i]);
+          nbatch = 0;
+        }
+        if (k < count && GETBIT(bits, k) && lo + k*step > limit*limit) {
+          batchk[nbatch] = k;
+          batchn[nbatch++] = lo + k*step;
+        }
+      }
+    }
+  }
+  if (count & 7)  bits[count>>3] &= (1U << (count&7)) - 1;
+  return bits;
+}
+#undef SETBIT
+#undef CLRBIT
+#undef GETBIT
+
+
+/* Totients, Moebius values, or sigma_k over a range, a window at a time.
+ * Each window is sieved by the primes up to sqrt(hi), so memory is bounded
+ * by the window size and that prime list, however wide the range is. */
+#define MULT_RANGE_MIN_WINDOW 65536
+#define MULT_RANGE_MAX_WINDOW 1048576   /* 16MB of totients, 4MB of mu */
+
+#define MULT_TOTIENT 0
+#define MULT_MOEBIUS 1
+#define MULT_SIGMA   2
+
+typedef struct {
+  UV        lo;          /* next window starts here */
+  UV        hi;
+  int       done;
+  int       type;        /* MULT_TOTIENT, MULT_MOEBIUS, or MULT_SIGMA */
+  UV        k;           /* for sigma_k */
+  UV        wsize;
+  UV        nprimes;     /* Sieving primes from 2.  0 means call totient() */
+  uint32_t *primes;
+  UV       *pinv;        /* 1/p mod 2^BITS_PER_WORD for odd p */
+  UV       *tot;         /* Totients or sigma_k */
+  UV       *rem;         /* n with the sieved primes divided out */
+  signed char *mu;
+} mult_range_t;
+
+static void* _start_mult_range(UV lo, UV hi, int type, UV k)
 {
-  signed char* mu;
-  UV i;
-  UV sqrtn = isqrt(hi);
+  int ismu = (type == MULT_MOEBIUS);
+  mult_range_t* ctx;
+  UV sqrthi;
+
+  New(0, ctx, 1, mult_range_t);
+  ctx->lo = lo;
+  ctx->hi = hi;
+  ctx->done = (lo > hi);
+  ctx->type = type;
+  ctx->k = k;
+  ctx->nprimes = 0;
+  ctx->primes = 0;
+  ctx->pinv = 0;
+  ctx->tot = ctx->rem = 0;
+  ctx->mu = 0;
+  if (ctx->done) return ctx;
+
+  /* Windows about sqrt(hi) wide, so most sieving primes hit each window,
+   * but no more than the maximum. */
+  sqrthi = isqrt(hi);
+  ctx->wsize = (sqrthi < MULT_RANGE_MIN_WINDOW) ? MULT_RANGE_MIN_WINDOW : sqrthi;
+  if (ctx->wsize > MULT_RANGE_MAX_WINDOW * (ismu ? 4 : 1))
+    ctx->wsize = MULT_RANGE_MAX_WINDOW * (ismu ? 4 : 1);
+  if (hi-lo < ctx->wsize)
+    ctx->wsize = hi-lo+1;
+  if (ismu) New(0, ctx->mu, ctx->wsize, signed char);
+  else      New(0, ctx->tot, ctx->wsize, UV);
+
+  /* As with factor ranges, narrow or very high ranges use totient(),
+   * moebius(), or divisor_sum() on each value. */
+  if (hi < 1000 || hi-lo < 200 || sqrthi > 67108864 || hi-lo < sqrthi/1000)
+    return ctx;
 
-  /* Kuznetsov indicates that the Deléglise & Rivat (1996) method can be
-   * modified to work on logs, which allows us to operate with no
-   * intermediate memory at all.  Same time as the D&R method, less memory. */
-  unsigned char logp;
-  UV nextlog;
+  {
+    unsigned char* segment;
+    UV seg_base, seg_low, seg_high, maxprimes, i;
+    void* sctx;
+    maxprimes = 10 + (UV)(1.3 * (double)sqrthi / log(sqrthi));
+    New(0, ctx->primes, maxprimes, uint32_t);
+    ctx->primes[0] = 2;  ctx->primes[1] = 3;  ctx->primes[2] = 5;
+    ctx->nprimes = 3;
+    sctx = start_segment_primes(7, sqrthi, &segment);
+    while (next_segment_primes(sctx, &seg_base, &seg_low, &seg_high)) {
+      START_DO_FOR_EACH_SIEVE_PRIME( segment, seg_low - seg_base, seg_high - seg_base ) {
+        ctx->primes[ctx->nprimes++] = seg_base + p;
+      } END_DO_FOR_EACH_SIEVE_PRIME
+    }
+    end_segment_primes(sctx);
+    if (!ismu) {
+      New(0, ctx->pinv, ctx->nprimes, UV);
+      for (i = 1; i < ctx->nprimes; i++) {
+        UV p = ctx->primes[i], inv = p;     /* Newton: 3, 6, 12, 24, 48 bits */
+        int k;
+        for (k = 0; k < 5; k++)  inv *= 2 - p*inv;
+        ctx->pinv[i] = inv;
+      }
+    }
+  }
+  if (!ismu) New(0, ctx->rem, ctx->wsize, UV);
+  return ctx;
+}
+
+/* Index of the first multiple of m at or after wlo */
+#define FIRST_MULTIPLE(wlo, m)  ( ((wlo) % (m)) ? (m) - ((wlo) % (m)) : 0 )
+
+static void _totient_window(mult_range_t* ctx, UV wlo, UV w)
+{
+  UV *tot = ctx->tot, *rem = ctx->rem, whi = wlo + (w-1), i, j;
+
+  for (i = 0; i < w; i++)
+    tot[i] = rem[i] = wlo + i;
+  for (i = (wlo & 1) + ((wlo == 0) ? 2 : 0); i < w; i += 2) {
+    tot[i] >>= 1;
+    rem[i] >>= ctz(rem[i]);
+  }
+  /* p divides both n and the totient so far exactly, so the divisions are
+   * products with the inverse of p. */
+  for (j = 1; j < ctx->nprimes; j++) {
+    UV p = ctx->primes[j], pinv = ctx->pinv[j], pk;
+    if (p > whi/p) break;
+    for (i = FIRST_MULTIPLE(wlo, p); i < w; i += p) {
+      tot[i] -= tot[i] * pinv;
+      rem[i] *= pinv;
+    }
+    for (pk = p*p; ; pk *= p) {
+      for (i = FIRST_MULTIPLE(wlo, pk); i < w; i += pk)
+        rem[i] *= pinv;
+      if (pk > whi/p) break;
+    }
+  }
+  /* What is left is 1 or a prime above sqrt(n) */
+  for (i = 0; i < w; i++)
+    if (rem[i] > 1)
+      tot[i] -= tot[i] / rem[i];
+}
 
-  Newz(0, mu, hi-lo+1, signed char);
-  if (sqrtn*sqrtn != hi) sqrtn++;  /* ceil sqrtn */
+/* Kuznetsov indicates that the Deléglise & Rivat (1996) method can be
+ * modified to work on logs, which allows us to operate with no
+ * intermediate memory at all.  Same time as the D&R method, less memory. */
+static void _moebius_window(mult_range_t* ctx, UV wlo, UV w)
+{
+  signed char* mu = ctx->mu;
+  UV whi = wlo + (w-1), i, j, nextlog;
+  unsigned char logp;
 
+  memset(mu, 0, w);
   logp = 1; nextlog = 3; /* 2+1 */
-  START_DO_FOR_EACH_PRIME(2, sqrtn) {
-    UV p2 = p*p;
+  for (j = 0; j < ctx->nprimes; j++) {
+    UV p = ctx->primes[j];
+    if (p > whi/p) break;
     if (p > nextlog) {
       logp += 2;   /* logp is 1 | ceil(log(p)/log(2)) */
       nextlog = ((nextlog-1)*4)+1;
     }
-    for (i = PGTLO(p, lo); i <= hi; i += p)
-      mu[i-lo] += logp;
-    for (i = PGTLO(p2, lo); i <= hi; i += p2)
-      mu[i-lo] |= 0x80;
-  } END_DO_FOR_EACH_PRIME
+    for (i = FIRST_MULTIPLE(wlo, p); i < w; i += p)
+      mu[i] += logp;
+    if (p*p <= whi)
+      for (i = FIRST_MULTIPLE(wlo, p*p); i < w; i += p*p)
+        mu[i] |= 0x80;
+  }
 
-  logp = log2floor(lo);
+  logp = log2floor(wlo);
   nextlog = 2UL << logp;
-  for (i = lo; i <= hi; i++) {
-    unsigned char a = mu[i-lo];
-    if (i >= nextlog) {  logp++;  nextlog *= 2;  } /* logp is log(p)/log(2) */
+  for (i = 0; i < w; i++) {
+    unsigned char a = mu[i];
+    if (wlo+i >= nextlog) {  logp++;  nextlog *= 2;  } /* logp is log(p)/log(2) */
     if (a & 0x80)       { a = 0; }
     else if (a >= logp) { a =  1 - 2*(a&1); }
     else                { a = -1 + 2*(a&1); }
-    mu[i-lo] = a;
+    mu[i] = a;
+  }
+  if (wlo == 0)  mu[0] = 0;
+}
+
+/* sigma_k(n) is the product of 1 + p^k + ... + p^ek over p^e || n.  Each
+ * odd p divides n exactly, so the exponent comes from products with the
+ * inverse of p, with n*pinv <= UV_MAX/p exactly when p | n.  Whatever is
+ * left after the small primes is 1 or a prime q, which gives 1 + q^k. */
+static void _sigma_window(mult_range_t* ctx, UV wlo, UV w)
+{
+  UV *sig = ctx->tot, *rem = ctx->rem, k = ctx->k, whi = wlo + (w-1), i, j;
+
+  for (i = 0; i < w; i++) {
+    sig[i] = 1;
+    rem[i] = wlo + i;
+  }
+  for (i = (wlo & 1) + ((wlo == 0) ? 2 : 0); i < w; i += 2) {
+    UV e = ctz(rem[i]), term = 1;
+    rem[i] >>= e;
+    while (e-- > 0) {
+      term <<= k;
+      sig[i] += term;
+    }
+  }
+  for (j = 1; j < ctx->nprimes; j++) {
+    UV p = ctx->primes[j], pinv = ctx->pinv[j], qmax, pk, e;
+    if (p > whi/p) break;
+    qmax = UV_MAX / p;
+    for (pk = 1, e = 0; e < k; e++)  pk *= p;
+    for (i = (wlo == 0) ? p : FIRST_MULTIPLE(wlo, p); i < w; i += p) {
+      UV r = rem[i] * pinv, q, term = pk, t = 1 + pk;
+      while ((q = r * pinv) <= qmax) {
+        r = q;
+        term *= pk;
+        t += term;
+      }
+      rem[i] = r;
+      sig[i] *= t;
+    }
+  }
+  for (i = 0; i < w; i++) {
+    if (rem[i] > 1) {
+      UV qk = 1;
+      for (j = 0; j < k; j++)  qk *= rem[i];
+      sig[i] *= 1 + qk;
+    }
   }
-  if (lo == 0)  mu[0] = 0;
+  if (wlo == 0)  sig[0] = (k == 0) ? 2 : 1;     /* as divisor_sum(0,k) */
+}
+
+void* start_totient_range(UV lo, UV hi) { return _start_mult_range(lo, hi, MULT_TOTIENT, 0); }
+void* start_moebius_range(UV lo, UV hi) { return _start_mult_range(lo, hi, MULT_MOEBIUS, 0); }
+void* start_sigma_range(UV lo, UV hi, UV k)
+{
+  /* divisor_sum gives 0 from the n where sigma_k(n) can overflow */
+  if (k > 5 || (hi > 1 && divisor_sum(hi, k) == 0))
+    return 0;
+  return _start_mult_range(lo, hi, MULT_SIGMA, k);
+}
+
+static int _next_mult_range(mult_range_t* ctx, UV* lo, UV* hi)
+{
+  UV wlo, w, i;
+
+  if (ctx->done) return 0;
+  wlo = ctx->lo;
+  w = (ctx->hi - wlo < ctx->wsize) ? ctx->hi - wlo + 1 : ctx->wsize;
+  if (wlo + (w-1) == ctx->hi)  ctx->done = 1;
+  else                         ctx->lo = wlo + w;
+  *lo = wlo;
+  *hi = wlo + (w-1);
+
+  if (ctx->nprimes == 0) {
+    for (i = 0; i < w; i++) {
+      if      (ctx->type == MULT_MOEBIUS) ctx->mu[i]  = moebius(wlo+i);
+      else if (ctx->type == MULT_SIGMA)   ctx->tot[i] = divisor_sum(wlo+i, ctx->k);
+      else                                ctx->tot[i] = totient(wlo+i);
+    }
+  } else if (ctx->type == MULT_MOEBIUS) {
+    _moebius_window(ctx, wlo, w);
+  } else if (ctx->type == MULT_SIGMA) {
+    _sigma_window(ctx, wlo, w);
+  } else {
+    _totient_window(ctx, wlo, w);
+  }
+  return 1;
+}
+
+int next_totient_range(void* ctx, UV* lo, UV* hi, const UV** totients)
+{
+  mult_range_t* c = (mult_range_t*) ctx;
+  *totients = c->tot;
+  return _next_mult_range(c, lo, hi);
+}
+int next_moebius_range(void* ctx, UV* lo, UV* hi, const signed char** mu)
+{
+  mult_range_t* c = (mult_range_t*) ctx;
+  *mu = c->mu;
+  return _next_mult_range(c, lo, hi);
+}
+int next_sigma_range(void* ctx, UV* lo, UV* hi, const UV** sigma)
+{
+  mult_range_t* c = (mult_range_t*) ctx;
+  *sigma = c->tot;
+  return _next_mult_range(c, lo, hi);
+}
+
+static void _end_mult_range(void* vctx)
+{
+  mult_range_t* ctx = (mult_range_t*) vctx;
+  if (ctx->primes != 0) Safefree(ctx->primes);
+  if (ctx->pinv != 0)   Safefree(ctx->pinv);
+  if (ctx->tot != 0)    Safefree(ctx->tot);
+  if (ctx->rem != 0)    Safefree(ctx->rem);
+  if (ctx->mu != 0)     Safefree(ctx->mu);
+  Safefree(ctx);
+}
+void end_totient_range(void* ctx) { _end_mult_range(ctx); }
+void end_moebius_range(void* ctx) { _end_mult_range(ctx); }
+void end_sigma_range(void* ctx) { _end_mult_range(ctx); }
+
+/* Return a char array with lo-hi+1 elements. mu[k-lo] = µ(k) for k = lo .. hi.
+ * It is the callers responsibility to call Safefree on the result. */
+signed char* _moebius_range(UV lo, UV hi)
+{
+  signed char* mu;
+  const signed char* wmu;
+  UV wlo, whi;
+  void* ctx;
 
+  New(0, mu, hi-lo+1, signed char);
+  ctx = start_moebius_range(lo, hi);
+  while (next_moebius_range(ctx, &wlo, &whi, &wmu))
+    memcpy(mu + (wlo-lo), wmu, whi-wlo+1);
+  end_moebius_range(ctx);
   return mu;
 }
 
 UV* _totient_range(UV lo, UV hi) {
   UV* totients;
-  UV i, seg_base, seg_low, seg_high;
-  unsigned char* segment;
+  UV wlo, whi;
+  const UV* wtot;
   void* ctx;
 
   if (hi < lo) croak("_totient_range error hi %"UVuf" < lo %"UVuf"\n", hi, lo);
   New(0, totients, hi-lo+1, UV);
 
-  /* Do via factoring if very small or if we have a small range */
-  if (hi < 100 || (hi-lo) < 10 || hi/(hi-lo+1) > 1000) {
-    for (i = lo; i <= hi; i++)
-      totients[i-lo] = totient(i);
-    return totients;
-  }
-
-  /* If doing a full sieve, do it monolithic.  Faster. */
-  if (lo == 0) {
-    UV* prime;
-    double loghi = log(hi);
-    UV max_index = (hi < 67)     ? 18
-                 : (hi < 355991) ? 15+(hi/(loghi-1.09))
-                 : (hi/loghi) * (1.0+1.0/loghi+2.51/(loghi*loghi));
-    UV j, index, nprimes = 0;
-
-    New(0, prime, max_index, UV);  /* could use prime_count_upper(hi) */
-    memset(totients, 0, (hi-lo+1) * sizeof(UV));
-    for (i = 2; i <= hi/2; i++) {
-      index = 2*i;
-      if ( !(i&1) ) {
-        if (i == 2) { totients[2] = 1; prime[nprimes++] = 2; }
-        totients[index] = totients[i]*2;
-      } else {
-        if (totients[i] == 0) {
-          totients[i] = i-1;
-          prime[nprimes++] = i;
-        }
-        for (j=0; j < nprimes && index <= hi; index = i*prime[++j]) {
-          if (i % prime[j] == 0) {
-            totients[index] = totients[i]*prime[j];
-            break;
-          } else {
-            totients[index] = totients[i]*(prime[j]-1);
-          }
-        }
-      }
-    }
-    Safefree(prime);
-    /* All totient values have been filled in except the primes.  Mark them. */
-    for (i = ((hi/2) + 1) | 1; i <= hi; i += 2)
-      if (totients[i] == 0)
-        totients[i] = i-1;
-    totients[1] = 1;
-    totients[0] = 0;
-    return totients;
-  }
-
-  for (i = lo; i <= hi; i++) {
-    UV v = i;
-    if (i % 2 == 0)  v -= v/2;
-    if (i % 3 == 0)  v -= v/3;
-    if (i % 5 == 0)  v -= v/5;
-    totients[i-lo] = v;
-  }
-
-  ctx = start_segment_primes(7, hi/2, &segment);
-  while (next_segment_primes(ctx, &seg_base, &seg_low, &seg_high)) {
-    START_DO_FOR_EACH_SIEVE_PRIME( segment, seg_low - seg_base, seg_high - seg_base ) {
-      p += seg_base;
-      for (i = P2GTLO(2*p,p,lo); i <= hi; i += p)
-        totients[i-lo] -= totients[i-lo]/p;
-    } END_DO_FOR_EACH_SIEVE_PRIME
-  }
-  end_segment_primes(ctx);
-
-  /* Fill in all primes */
-  for (i = lo | 1; i <= hi; i += 2)
-    if (totients[i-lo] == i)
-      totients[i-lo]--;
-  if (lo <= 1) totients[1-lo] = 1;
-
+  ctx = start_totient_range(lo, hi);
+  while (next_totient_range(ctx, &wlo, &whi, &wtot))
+    memcpy(totients + (wlo-lo), wtot, (whi-wlo+1) * sizeof(UV));
+  end_totient_range(ctx);
   return totients;
 }
 
@@ -1230,6 +1603,327 @@ IV mertens(UV n) {
   return sum;
 }
 
+/* Write the 2-word value hi*2^BITS_PER_WORD + lo in decimal.  Returns the
+ * length.  str needs room for 40 characters on 64-bit. */
+int to_string_128(char* str, UV hi, UV lo)
+{
+  const int h = BITS_PER_WORD/2;
+  const UV hmask = (UVCONST(1) << h) - 1;
+  char digits[48];
+  int i, len = 0;
+  do {
+    UV w[4], r = 0;
+    w[0] = hi >> h;  w[1] = hi & hmask;  w[2] = lo >> h;  w[3] = lo & hmask;
+    for (i = 0; i < 4; i++) {
+      UV cur = (r << h) | w[i];
+      w[i] = cur / 10;
+      r = cur % 10;
+    }
+    hi = (w[0] << h) | w[1];
+    lo = (w[2] << h) | w[3];
+    digits[len++] = '0' + r;
+  } while (hi != 0 || lo != 0);
+  for (i = 0; i < len; i++)
+    str[i] = digits[len-1-i];
+  str[len] = '\0';
+  return len;
+}
+
+/* Sum of totients to n.  Summing Phi(n/k) over all k gives n(n+1)/2, so
+ *   Phi(n) = n(n+1)/2 - sum[k=2..n] Phi(n/k)
+ * and every argument on the right is some n/j.  Only the J ~ n^1/3 values
+ * n/j above L ~ n^2/3 need the recursion.  For x = n/j, the terms with
+ * k <= sqrt(x) and n/(jk) <= L, and the terms k > sqrt(x) grouped by the
+ * value q = x/k, all look up Phi(v) with v <= L.  So sieve totients to L in
+ * windows and subtract each Phi(v) from the sums that use it as the window
+ * passes, with a pointer to the next k for each j.  Then the remaining
+ * terms Phi(n/(jk)) with jk <= J come from largest j to smallest.  This is
+ * O(n^2/3) time and O(n^1/3) memory.
+ *
+ * The result needs twice the bits of n.  Without 128-bit types only sums
+ * that fit in a UV are computed, and 0 is returned for larger n. */
+#if HAVE_UINT128
+typedef uint128_t sum2_t;
+#define PHISUM_MAXN UV_MAX
+#else
+typedef UV sum2_t;
+#define PHISUM_MAXN ((BITS_PER_WORD == 64) ? UVCONST(6074000999) : 92681)
+#endif
+
+int totient_sum(UV n, UV* hi_sum, UV* lo_sum)
+{
+  UV r, J, L, j, cb, wlo, whi, *K, *V;
+  sum2_t sum, *B, *P = 0;
+  const UV* wtot;
+  void* ctx;
+
+  if (n > PHISUM_MAXN) return 0;
+  *hi_sum = 0;
+  if (n <= 2) { *lo_sum = n; return 1; }
+
+  r = isqrt(n);
+  cb = icbrt(n);
+  L = cb*cb;
+  if (L < r) L = r;
+  J = n/(L+1);                      /* n/j > L exactly when j <= J */
+  New(0, B, J+1, sum2_t);           /* B[j] = Phi(n/j) once finished */
+  New(0, K, J+1, UV);               /* K[j] = next k with n/(jk) <= L */
+  New(0, V, J+1, UV);               /* V[j] = n/(j K[j]), or 0 when done */
+  for (j = 1; j <= J; j++) {
+    UV x = n/j, kmin = (J/j < 1) ? 1 : J/j;
+    B[j] = ((sum2_t)x * ((sum2_t)x + 1)) >> 1;
+    K[j] = isqrt(x);
+    V[j] = (K[j] > kmin) ? x/K[j] : 0;
+  }
+
+  sum = 0;
+  ctx = start_totient_range(1, L);
+  while (next_totient_range(ctx, &wlo, &whi, &wtot)) {
+    UV i;
+    if (P == 0)  New(0, P, whi-wlo+1, sum2_t);    /* The widest window */
+    for (i = 0; i <= whi-wlo; i++)
+      P[i] = (sum += wtot[i]);      /* P[v-wlo] = Phi(v) */
+    /* k > sqrt(x): Phi(q) for each of the x/q - x/(q+1) values of k */
+    for (j = 1; wlo <= r && j <= J; j++) {
+      UV x = n/j, s = isqrt(x), q, qmax = x/(s+1);
+      if (qmax < wlo) break;
+      if (qmax > whi) qmax = whi;
+      for (q = wlo; q <= qmax; q++) {
+        UV klo = x/(q+1);
+        if (klo < s) klo = s;
+        B[j] -= P[q-wlo] * (x/q - klo);
+      }
+    }
+    /* k <= sqrt(x) with x/k in this window, in increasing order of x/k */
+    for (j = 1; j <= J; j++) {
+      UV x, k, kmin, v = V[j];
+      if (v == 0 || v > whi)  continue;
+      x = n/j;
+      k = K[j];
+      kmin = (J/j < 1) ? 1 : J/j;
+      do {
+        B[j] -= P[v-wlo];
+        v = (--k > kmin) ? x/k : 0;
+      } while (v != 0 && v <= whi);
+      K[j] = k;
+      V[j] = v;
+    }
+  }
+  end_totient_range(ctx);
+
+  for (j = J; j > 0; j--) {
+    UV k, kmax = J/j, s = isqrt(n/j);
+    if (kmax > s) kmax = s;
+    for (k = 2; k <= kmax; k++)
+      B[j] -= B[j*k];
+  }
+  sum = B[1];
+  Safefree(P);
+  Safefree(V);
+  Safefree(K);
+  Safefree(B);
+#if HAVE_UINT128
+  *hi_sum = (UV)(sum >> 64);
+#endif
+  *lo_sum = (UV)sum;
+  return 1;
+}
+
+/* Mertens at x > L, given M(v) for v <= L.  The same identity as above,
+ * sum[k=1..x] M(x/k) = 1, with M(x/j) for x/j > L from largest j down. */
+static IV _mertens_above(UV x, const int32_t* M, UV L)
+{
+  UV j, J = x/(L+1);
+  IV* B;
+  IV res;
+
+  if (x <= L) return M[x];
+  New(0, B, J+1, IV);
+  for (j = J; j > 0; j--) {
+    UV y = x/j, s = isqrt(y), k, q, khi, qmax = y/(s+1);
+    IV sum = 1;
+    for (k = 2; k <= s; k++) {
+      UV m = j*k;
+      sum -= (m <= J) ? B[m] : M[y/k];
+    }
+    for (q = 1, khi = y; q <= qmax; q++) {
+      UV klo = y/(q+1);
+      if (klo < s) klo = s;
+      sum -= (IV)M[q] * (IV)(khi - klo);
+      khi = klo;
+    }
+    B[j] = sum;
+  }
+  res = B[1];
+  Safefree(B);
+  return res;
+}
+
+/* Count of squarefree integers to n, Q(n) = sum[d <= sqrt(n)] mu(d) n/d^2.
+ * Pawlewicz's method:  for d <= D sum the terms directly.  For d > D the
+ * term n/d^2 counts the i with d^2 <= n/i, so those terms add up to
+ *   sum[i=1..I] M(sqrt(n/i)) - M(D),   I = n/(D+1)^2.
+ * With D ~ n^2/5 there are only n^1/5 of these, each done by the Mertens
+ * recursion above on a table of M to D, for O(n^2/5) overall.  The table
+ * holds 32-bit values, as |M(v)| stays far below that for v <= 2^26. */
+#define SQFREE_MAX_TABLE  (UVCONST(1) << 26)
+UV squarefree_count(UV n)
+{
+  UV r, D, d, i, I, wlo, whi, sum = 0;
+  const signed char* wmu;
+  int32_t* M;
+  void* ctx;
+
+  if (n < 4) return n;
+  r = isqrt(n);
+  D = (UV) pow((double)n, 0.4);
+  if (D > SQFREE_MAX_TABLE) D = SQFREE_MAX_TABLE;
+  if (D > r) D = r;
+
+  /* The sum is modulo 2^BITS_PER_WORD, which is fine as Q(n) <= n. */
+  New(0, M, D+1, int32_t);
+  M[0] = 0;
+  ctx = start_moebius_range(1, D);
+  while (next_moebius_range(ctx, &wlo, &whi, &wmu)) {
+    for (d = wlo; d <= whi; d++) {
+      int mu = wmu[d-wlo];
+      M[d] = M[d-1] + mu;
+      if      (mu > 0)  sum += n/(d*d);
+      else if (mu < 0)  sum -= n/(d*d);
+    }
+  }
+  end_moebius_range(ctx);
+
+  if (D < r) {
+    I = n/((D+1)*(D+1));
+    for (i = 1; i <= I; i++)
+      sum += (UV)(_mertens_above(isqrt(n/i), M, D) - M[D]);
+  }
+  Safefree(M);
+  return sum;
+}
+
+/* Sums of sigma_k(i) for i <= n.  Counting the pairs a*b <= n with weight
+ * a^k by the hyperbola method,
+ *   sum[a <= s] a^k (n/a)  +  sum[b <= s] F_k(n/b)  -  s F_k(s),  s = sqrt(n)
+ * where F_k(m) = 1^k + ... + m^k.  This is O(sqrt(n)).  The divisor count
+ * sum D(n) = 2 sum[a <= s] n/a - s^2 is done in O(n^1/3 log n) by walking
+ * the hyperbola with a stack of lattice directions (Sladkey 2012, in the
+ * form given by min_25), which needs 128-bit products.
+ *
+ * The largest n whose sum fits in two words (or one, without 128-bit types).
+ * Sums for larger n, or k > 2, are left to the caller. */
+#if HAVE_UINT128
+static const UV dsum_maxn[3] = {UV_MAX, UV_MAX, UVCONST(8796093022208)};
+#elif BITS_PER_WORD == 64
+static const UV dsum_maxn[3] = {UVCONST(288230376151711744), UVCONST(4294967296), 2097152};
+#else
+static const UV dsum_maxn[3] = {134217728, 65536, 1024};
+#endif
+
+/* F_k(m), halving and thirding in single words */
+static sum2_t _power_sum(UV m, UV k)
+{
+  UV a = m, b, c;
+  if (k == 0) return m;
+  if (m & 1) { b = (m >> 1) + 1; }
+  else       { a = m >> 1;  b = m + 1; }
+  if (k == 1) return (sum2_t)a * b;
+  c = 2*m + 1;
+  switch (m % 3) {
+    case 0:  a /= 3;  break;
+    case 1:  c /= 3;  break;
+    default: b /= 3;  break;
+  }
+  return (sum2_t)a * b * c;
+}
+
+#if HAVE_UINT128
+static sum2_t _divisor_count_sum(UV n)
+{
+  UV v = isqrt(n), w = icbrt(n), x, y, nst, alloc = 64;
+  UV *sdx, *sdy;                      /* stack of directions */
+  sum2_t ret = 0;
+
+  New(0, sdx, alloc, UV);
+  New(0, sdy, alloc, UV);
+  sdx[0] = 1;  sdy[0] = 0;
+  sdx[1] = 1;  sdy[1] = 1;
+  nst = 2;
+  /* (x,y) is just above the hyperbola, moving down and right */
+  x = n / v;
+  y = n / x + 1;
+  while (1) {
+    UV dx1, dy1, dx2, dy2;
+    nst--;
+    dx1 = sdx[nst];  dy1 = sdy[nst];
+    while ((sum2_t)(x+dx1) * (y-dy1) > n) {
+      ret += (sum2_t)x * dy1 + ((sum2_t)(dy1+1) * (dx1-1)) / 2;
+      x += dx1;  y -= dy1;
+    }
+    if (y <= w) break;
+    dx2 = dx1;  dy2 = dy1;
+    while (1) {
+      dx1 = sdx[nst-1];  dy1 = sdy[nst-1];
+      if ((sum2_t)(x+dx1) * (y-dy1) > n) break;
+      dx2 = dx1;  dy2 = dy1;
+      nst--;
+    }
+    while (1) {
+      UV dx = dx1 + dx2, dy = dy1 + dy2;
+      if ((sum2_t)(x+dx) * (y-dy) > n) {
+        if (nst >= alloc) {
+          alloc *= 2;
+          Renew(sdx, alloc, UV);
+          Renew(sdy, alloc, UV);
+        }
+        sdx[nst] = dx1 = dx;  sdy[nst] = dy1 = dy;  nst++;
+      } else {
+        /* Stop once the direction is steeper than the curve at x+dx */
+        if ((sum2_t)(x+dx) * (x+dx) * dy1 >= (sum2_t)n * dx1) break;
+        dx2 = dx;  dy2 = dy;
+      }
+    }
+  }
+  Safefree(sdy);
+  Safefree(sdx);
+  for (y--; y > 0; y--)
+    ret += n / y;
+  return 2*ret - (sum2_t)v * v;
+}
+#endif
+
+int divisor_summatory(UV n, UV k, UV* hi_sum, UV* lo_sum)
+{
+  sum2_t sum = 0;
+  UV s, a;
+
+  if (k > 2 || n > dsum_maxn[k]) return 0;
+  *hi_sum = 0;
+  if (n <= 1) { *lo_sum = n; return 1; }
+
+#if HAVE_UINT128
+  if (k == 0 && n >= 1000) {
+    sum = _divisor_count_sum(n);
+  } else
+#endif
+  {
+    s = isqrt(n);
+    for (a = 1; a <= s; a++) {
+      UV q = n / a;
+      if      (k == 0)  sum += 2*(sum2_t)q;
+      else if (k == 1)  sum += (sum2_t)a * q + _power_sum(q, 1);
+      else              sum += (sum2_t)a * a * q + _power_sum(q, 2);
+    }
+    sum -= (sum2_t)s * _power_sum(s, k);
+  }
+#if HAVE_UINT128
+  *hi_sum = (UV)(sum >> 64);
+#endif
+  *lo_sum = (UV)sum;
+  return 1;
+}
+
 /* There are at least 4 ways to do this, plus hybrids.
  * 1) use a table.  Great for 32-bit, too big for 64-bit.
  * 2) Use pow() to check.  Relatively slow and FP is always dangerous.
@@ -1712,44 +2406,83 @@ UV chinese(UV* a, UV* n, UV num, int* status) {
   return sum;
 }
 
-long double chebyshev_function(UV n, int which)
+/* The log of a product is one logl call instead of one per prime.  Primes
+ * (or prime powers for psi) are multiplied into a long double until the
+ * product could overflow, then its log is added with compensation.  The
+ * product rounds at each step, but that error is about the same as the
+ * error from logl on each prime. */
+#define CHEB_BLOCK_BITS  (LDBL_MAX_EXP - 2*BITS_PER_WORD)
+#define CHEB_MUL(pk) \
+  do { \
+    int b_ = log2floor(pk)+1; \
+    if (bits + b_ > CHEB_BLOCK_BITS) { \
+      KAHAN_SUM(sum, logl(prod)); \
+      prod = 1.0L;  bits = 0; \
+    } \
+    prod *= (long double)(pk);  bits += b_; \
+  } while (0)
+
+/* Sum for primes lo <= p <= hi.  Returns the sum and its compensation. */
+static void _chebyshev_range(UV lo, UV hi, UV n, UV sqrtn,
+                             long double* rsum, long double* rcomp)
 {
-  long double logp, logn = logl(n);
-  UV sqrtn = which ? isqrt(n) : 0;  /* for theta, p <= sqrtn always false */
+  long double prod = 1.0L;
+  int bits = 0;
+  UV p, pk;
   KAHAN_INIT(sum);
 
-  if (n < primes_small[NPRIMES_SMALL-1]) {
-    UV p, pi;
-    for (pi = 1;  (p = primes_small[pi]) <= n; pi++) {
-      logp = logl(p);
-      if (p <= sqrtn) logp *= floorl(logn/logp+1e-15);
-      KAHAN_SUM(sum, logp);
-    }
-  } else {
+  for (p = 2; p <= 5; p += 1+(p>2)) {
+    if (p < lo || p > hi) continue;
+    for (pk = p;  p <= sqrtn && pk <= n/p;  pk *= p)  ;
+    CHEB_MUL(pk);
+  }
+  if (hi >= 7) {
     UV seg_base, seg_low, seg_high;
     unsigned char* segment;
-    void* ctx;
-    long double logl2 = logl(2);
-    long double logl3 = logl(3);
-    long double logl5 = logl(5);
-    if (!which) {
-      KAHAN_SUM(sum,logl2); KAHAN_SUM(sum,logl3); KAHAN_SUM(sum,logl5);
-    } else {
-      KAHAN_SUM(sum, logl2 * floorl(logn/logl2 + 1e-15));
-      KAHAN_SUM(sum, logl3 * floorl(logn/logl3 + 1e-15));
-      KAHAN_SUM(sum, logl5 * floorl(logn/logl5 + 1e-15));
-    }
-    ctx = start_segment_primes(7, n, &segment);
+    void* ctx = start_segment_primes( (lo < 7) ? 7 : lo, hi, &segment);
     while (next_segment_primes(ctx, &seg_base, &seg_low, &seg_high)) {
       START_DO_FOR_EACH_SIEVE_PRIME( segment, seg_low - seg_base, seg_high - seg_base ) {
         p += seg_base;
-        logp = logl(p);
-        if (p <= sqrtn) logp *= floorl(logn/logp+1e-15);
-        KAHAN_SUM(sum, logp);
+        if (p > sqrtn) {
+          CHEB_MUL(p);
+        } else {
+          for (pk = p;  pk <= n/p;  pk *= p)  ;
+          CHEB_MUL(pk);
+        }
       } END_DO_FOR_EACH_SIEVE_PRIME
     }
     end_segment_primes(ctx);
   }
+  KAHAN_SUM(sum, logl(prod));
+  *rsum = sum;
+  *rcomp = sum_c;
+}
+#undef CHEB_MUL
+
+/* Large n are split into chunks whose sums are combined with compensation.
+ * With OpenMP the chunks are sieved in parallel. */
+#define CHEB_CHUNKS 16
+long double chebyshev_function(UV n, int which)
+{
+  long double csum[CHEB_CHUNKS], ccomp[CHEB_CHUNKS];
+  UV sqrtn = which ? isqrt(n) : 0;  /* for theta, p <= sqrtn always false */
+  int i, nchunks = (n < 100000000) ? 1 : CHEB_CHUNKS;
+  KAHAN_INIT(sum);
+
+  if (n < 2) return 0;
+  get_prime_cache(isqrt(n)+1, 0);   /* Sieving primes, before any threads */
+#ifdef _OPENMP
+  #pragma omp parallel for schedule(dynamic, 1)
+#endif
+  for (i = 0; i < nchunks; i++) {
+    UV lo = (i == 0) ? 2 : (n/nchunks)*i + 1;
+    UV hi = (i == nchunks-1) ? n : (n/nchunks)*(i+1);
+    _chebyshev_range(lo, hi, n, sqrtn, csum+i, ccomp+i);
+  }
+  for (i = 0; i < nchunks; i++) {
+    KAHAN_SUM(sum, csum[i]);
+    KAHAN_SUM(sum, -ccomp[i]);
+  }
   return sum;
 }
 
@@ -1909,12 +2642,7 @@ UV _XS_Inverse_Li(UV x) {
 
   if (x == 0)  return 0;
   if (hi <= lo) hi = UV_MAX;
-  while (lo < hi) {
-    UV mid = lo + (hi-lo)/2;
-    if (_XS_LogarithmicIntegral(mid) < x) lo = mid+1;
-    else                                  hi = mid;
-  }
-  return lo;
+  return _inverse_newton(_XS_LogarithmicIntegral, x, nlogn, lo, hi);
 }
 
 
@@ -2104,6 +2832,77 @@ long double ld_riemann_zeta(long double x) {
   }
 }
 
+/* Gram series coefficients 1/(k k! zeta(k+1)), k = 1 .. 128.  With these
+ * R(x) = 1 + sum c_k log(x)^k costs one multiply-add per term, and 128 terms
+ * is enough for x up to 1e19 where we switch to the Li sum. */
+static const long double riemann_r_coeff[] = {
+  6.079271018540266286633e-1L, 2.079768431451768671708e-1L,
+  5.132991127342167594576e-2L, 1.004570146280481728257e-2L,
+  1.638254320440967366341e-3L, 2.295647814440843311176e-4L,
+  2.822956919290008919600e-5L, 3.093984476471856885121e-6L,
+  3.058882070194710163605e-7L, 2.754370743765500101372e-8L,
+  2.276904083198472554886e-9L, 1.739516287122248172903e-10L,
+  1.235235408505763975259e-11L, 8.193139098989232909695e-13L,
+  5.098031245110583124842e-14L, 2.987150519283225889998e-15L,
+  1.653792071899792087498e-16L, 8.677320646596522360811e-18L,
+  4.326646002346258552558e-19L, 2.055157831483519539453e-20L,
+  9.320445902959398902619e-22L, 4.043995605352676637969e-23L,
+  1.681813017415686508024e-24L, 6.715573012752889232552e-26L,
+  2.578780075325956675713e-27L, 9.536908633654001866478e-29L,
+  3.401366603549345908584e-30L, 1.171389011057328693592e-31L,
+  3.899987198591185601921e-33L, 1.256662542353454082651e-34L,
+  3.922984004097955216606e-36L, 1.187622110753849748800e-37L,
+  3.489798672758063827655e-39L, 9.962228045360536826138e-41L,
+  2.765026559568875261504e-42L, 7.467278517408547233351e-44L,
+  1.963637886250443167527e-45L, 5.031482118517905483734e-47L,
+  1.257043527310021699236e-48L, 3.064043597819571257766e-50L,
+  7.291002017418841024810e-52L, 1.694620650307292894266e-53L,
+  3.849327599400235118260e-55L, 8.549642911891261078385e-57L,
+  1.857700188262818930120e-58L, 3.950685655568404813059e-60L,
+  8.226869178639532233628e-62L, 1.678224181406504782256e-63L,
+  3.355050425135872598720e-65L, 6.575898833266313213778e-67L,
+  1.264109733422974754694e-68L, 2.384230636263747028365e-70L,
+  4.413670099171052059709e-72L, 8.022102717972077011567e-74L,
+  1.432044782712370792186e-75L, 2.511558132945803383826e-77L,
+  4.328939841334718066550e-79L, 7.335005081928624560684e-81L,
+  1.222149654558633222892e-82L, 2.002967489415537782830e-84L,
+  3.229724519347816903947e-86L, 5.125213207081603308068e-88L,
+  8.006127962687311794343e-90L, 1.231411283323487898089e-91L,
+  1.865333068229662141509e-93L, 2.783440069672360863152e-95L,
+  4.092382370202179036950e-97L, 5.929706289004022393515e-99L,
+  8.469229734347269959238e-101L, 1.192605819734615565689e-102L,
+  1.656068386856240618890e-104L, 2.268149218109434489607e-106L,
+  3.064491343664463937919e-108L, 4.085242295242985161945e-110L,
+  5.374363197297438257492e-112L, 6.978484068512947875898e-114L,
+  8.945265461409749343368e-116L, 1.132125970625494246284e-117L,
+  1.414930711565270809328e-119L, 1.746555097088381155264e-121L,
+  2.129620603064631800353e-123L, 2.565426365976132894536e-125L,
+  3.053635680215457938045e-127L, 3.592003422022151486079e-129L,
+  4.176170068510183042639e-131L, 4.799546455156375860253e-133L,
+  5.453309487956775320145e-135L, 6.126522797678711942828e-137L,
+  6.806388160531835007813e-139L, 7.478624028238682909819e-141L,
+  8.127957523746908125633e-143L, 8.738706694954733452654e-145L,
+  9.295421620254774860032e-147L, 9.783546974690969465629e-149L,
+  1.019006554704654991434e-150L, 1.050408232388696008965e-152L,
+  1.071731218081781452446e-154L, 1.082444066575726789747e-156L,
+  1.082333624369158508266e-158L, 1.071510288125466923184e-160L,
+  1.050397302348266761282e-162L, 1.019705185862888724428e-164L,
+  9.803933354511702317997e-167L, 9.336216119773533087589e-169L,
+  8.806952167405418966978e-171L, 8.230063880184843285268e-173L,
+  7.619763920862899713847e-175L, 6.990009769653037288937e-177L,
+  6.354019485923138011996e-179L, 5.723868793104314407500e-181L,
+  5.110182349171938842830e-183L, 4.521924750941368076802e-185L,
+  3.966290015705483785746e-187L, 3.448682454406891872801e-189L,
+  2.972777314195732880902e-191L, 2.540646485824236632757e-193L,
+  2.152932956064076626487e-195L, 1.809057425017932815994e-197L,
+  1.507441396455872270936e-199L, 1.245732820682283335010e-201L,
+  1.021022733979058808833e-203L, 8.300440124393047290294e-206L,
+  6.693460871015610875907e-208L, 5.354420441824402560721e-210L,
+  4.249268062631845872188e-212L, 3.345669613435252796823e-214L,
+  2.613642329300278085434e-216L, 2.025955662970796611634e-218L
+};
+#define NPRECALC_RIEMANN_R (sizeof(riemann_r_coeff)/sizeof(riemann_r_coeff[0]))
+
 long double _XS_RiemannR(long double x) {
   long double part_term, term, flogx, ki;
   unsigned int k;
@@ -2132,6 +2931,16 @@ long double _XS_RiemannR(long double x) {
   flogx = logl(x);
   part_term = 1;
 
+  if (flogx >= 0) {
+    for (k = 1; k <= NPRECALC_RIEMANN_R; k++) {
+      part_term *= flogx;
+      term = part_term * riemann_r_coeff[k-1];
+      KAHAN_SUM(sum, term);
+      if (fabsl(term) < fabsl(LDBL_EPSILON*sum)) break;
+    }
+    return sum;
+  }
+
   for (k = 1; k <= 10000; k++) {
     part_term *= flogx / k;
     if (k-1 < NPRECALC_ZETA)  term = part_term / (k+k*riemann_zeta_table[k-1]);
@@ -24,6 +24,7 @@ extern UV  twin_prime_count(UV low, UV high);
 extern UV  twin_prime_count_approx(UV n);
 extern UV  nth_twin_prime(UV n);
 extern UV  nth_twin_prime_approx(UV n);
+extern unsigned char* prime_range_bitmap(UV lo, UV step, UV count);
 
 extern int powerof(UV n);
 extern int is_power(UV n, UV a);
@@ -34,7 +35,22 @@ extern UV mpu_popcount_string(const char* ptr, int len);
 
 extern signed char* _moebius_range(UV low, UV high);
 extern UV*    _totient_range(UV low, UV high);
+/* Windows of totients or Moebius values covering lo..hi.  Each call to
+ * next_* gives the next window [*lo,*hi], valid until the following call. */
+extern void* start_totient_range(UV lo, UV hi);
+extern int   next_totient_range(void* ctx, UV* lo, UV* hi, const UV** totients);
+extern void  end_totient_range(void* ctx);
+extern void* start_moebius_range(UV lo, UV hi);
+extern int   next_moebius_range(void* ctx, UV* lo, UV* hi, const signed char** mu);
+extern void  end_moebius_range(void* ctx);
+extern void* start_sigma_range(UV lo, UV hi, UV k);  /* 0 if sigma_k can overflow */
+extern int   next_sigma_range(void* ctx, UV* lo, UV* hi, const UV** sigma);
+extern void  end_sigma_range(void* ctx);
 extern IV     mertens(UV n);
+extern int    totient_sum(UV n, UV* hi_sum, UV* lo_sum);
+extern UV     squarefree_count(UV n);
+extern int    divisor_summatory(UV n, UV k, UV* hi_sum, UV* lo_sum);
+extern int    to_string_128(char* str, UV hi, UV lo);
 extern long double chebyshev_function(UV n, int which); /* 0 = theta, 1 = psi */
 
 extern long double _XS_ExponentialIntegral(long double x);
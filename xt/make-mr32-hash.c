@@ -0,0 +1,140 @@
+/*
+ * Build and verify the hashed second Miller-Rabin base for 32-bit inputs.
+ *
+ * Every odd n < 2^32 that is a strong pseudoprime to base 2 is found by
+ * exhaustive search.  Those are split into 256 buckets by mr32_hash(), and
+ * for each bucket the smallest base that no pseudoprime in the bucket passes
+ * is chosen.  M-R base 2 followed by the bucket's base is then exact for all
+ * n < 2^32.  Finally every pseudoprime is rechecked against the table, and
+ * the table is printed in the form used by primality.c.
+ *
+ * Compile with:
+ *    gcc -O3 -march=native -Wall xt/make-mr32-hash.c -o mr32hash
+ *
+ * Takes a few minutes on one core.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#define NBUCKETS 256
+#define SEGSIZE  (1U << 20)
+
+/* Must match primality.c */
+static uint32_t mr32_hash(uint32_t x) {
+  x = ((x >> 16) ^ x) * 0x45d9f3b;
+  x = ((x >> 16) ^ x) * 0x45d9f3b;
+  x = ((x >> 16) ^ x);
+  return x & (NBUCKETS-1);
+}
+
+/* Montgomery arithmetic with R = 2^32, for odd n < 2^32 */
+static uint32_t mont_inv32(uint32_t n) {
+  uint32_t x = n;
+  x *= 2 - n*x;  x *= 2 - n*x;  x *= 2 - n*x;  x *= 2 - n*x;
+  return -x;   /* -1/n mod 2^32 */
+}
+static uint32_t mont_mul32(uint32_t a, uint32_t b, uint32_t n, uint32_t npi) {
+  uint64_t t = (uint64_t)a * b;
+  uint32_t m = (uint32_t)t * npi;
+  uint64_t u = (t + (uint64_t)m * n) >> 32;
+  /* t + m*n can carry past 2^64 only when n > 2^31 */
+  if (t + (uint64_t)m * n < t) u += UINT64_C(1) << 32;
+  return (u >= n) ? (uint32_t)(u - n) : (uint32_t)u;
+}
+
+static int is_strong_pseudoprime32(uint32_t n, uint32_t a) {
+  uint32_t npi, one, mone, x, d = n-1;
+  int s = 0, r;
+  if (a >= n) a %= n;
+  if (a == 0) return 1;
+  while (!(d & 1)) { s++; d >>= 1; }
+  npi = mont_inv32(n);
+  one = (uint32_t)((UINT64_C(1) << 32) % n);
+  mone = n - one;
+  {
+    uint32_t A = (uint32_t)(((uint64_t)a << 32) % n);
+    x = one;
+    while (d) {
+      if (d & 1) x = mont_mul32(x, A, n, npi);
+      d >>= 1;
+      if (d) A = mont_mul32(A, A, n, npi);
+    }
+  }
+  if (x == one || x == mone) return 1;
+  for (r = 1; r < s; r++) {
+    x = mont_mul32(x, x, n, npi);
+    if (x == mone) return 1;
+    if (x == one) return 0;
+  }
+  return 0;
+}
+
+int main(void) {
+  uint32_t *psp = 0, npsp = 0, maxpsp = 0, i, n;
+  uint32_t bases[NBUCKETS];
+  uint32_t b;
+  int h, bad = 0;
+
+  /* 1. Every odd composite below 2^32 passing base 2.  A segmented sieve
+   *    marks the composites so only they are tested. */
+  {
+    static uint32_t sp[6542];
+    static unsigned char comp[SEGSIZE];
+    uint32_t nsp = 0, lo, p, j;
+    for (p = 3; p < 65536; p += 2) {
+      for (j = 0; j < nsp && sp[j]*sp[j] <= p; j++)
+        if (p % sp[j] == 0) break;
+      if (j == nsp || sp[j]*sp[j] > p) sp[nsp++] = p;
+    }
+    for (lo = 0; ; lo += SEGSIZE) {
+      uint64_t hi = (uint64_t)lo + SEGSIZE;   /* exclusive */
+      for (j = 0; j < SEGSIZE; j++) comp[j] = 0;
+      for (j = 0; j < nsp; j++) {
+        uint64_t m;
+        p = sp[j];
+        m = ((uint64_t)lo + p - 1) / p * p;
+        if (m < (uint64_t)p*p) m = (uint64_t)p*p;
+        for (; m < hi; m += p)  comp[m - lo] = 1;
+      }
+      for (j = 1; j < SEGSIZE; j += 2) {
+        n = lo + j;
+        if (!comp[j] || !is_strong_pseudoprime32(n, 2)) continue;
+        if (npsp >= maxpsp) {
+          maxpsp = 2*maxpsp + 1024;
+          psp = realloc(psp, maxpsp * sizeof(uint32_t));
+          if (psp == 0) { fprintf(stderr, "out of memory\n"); return 1; }
+        }
+        psp[npsp++] = n;
+      }
+      if (hi >= (UINT64_C(1) << 32)) break;
+    }
+  }
+  fprintf(stderr, "%u base-2 strong pseudoprimes below 2^32\n", npsp);
+
+  /* 2. Smallest working base for each bucket */
+  for (h = 0; h < NBUCKETS; h++) {
+    for (b = 3; ; b++) {
+      for (i = 0; i < npsp; i++)
+        if ((int)mr32_hash(psp[i]) == h && is_strong_pseudoprime32(psp[i], b))
+          break;
+      if (i == npsp) break;
+    }
+    bases[h] = b;
+  }
+
+  /* 3. Verify: base 2 then the hashed base rejects every pseudoprime */
+  for (i = 0; i < npsp; i++)
+    if (is_strong_pseudoprime32(psp[i], bases[mr32_hash(psp[i])])) {
+      fprintf(stderr, "FAIL: %u passes\n", psp[i]);
+      bad++;
+    }
+  fprintf(stderr, "verification %s\n", bad ? "FAILED" : "passed");
+
+  printf("static const uint16_t mr_bases_hash32[%d] = {\n", NBUCKETS);
+  for (h = 0; h < NBUCKETS; h++)
+    printf("%s%u%s", (h % 12) == 0 ? "  " : "", bases[h],
+           (h == NBUCKETS-1) ? "};\n" : (h % 12) == 11 ? ",\n" : ",");
+  free(psp);
+  return bad != 0;
+}